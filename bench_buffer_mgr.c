@@ -0,0 +1,327 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "dberror.h"
+#include "storage_mgr.h"
+#include "buffer_mgr.h"
+
+// benchmark parameters
+#define BENCH_FILE "bench_buffer.bin"
+#define BENCH_MAX_FRAMES 100000
+#define BENCH_PINS 1000000
+#define BENCH_SCAN_WORK 200000000LL // frames compared by the linear scan reference
+#define TRACE_PAGES 20000
+#define TRACE_FRAMES 1000
+#define TRACE_HOT_PAGES 800
+#define TRACE_PHASE_PINS 200000
+#define THREAD_FRAMES 8192
+#define THREAD_PINS 1000000 // per thread
+#define THREAD_SHARDS 16
+#define THREAD_MAX 8
+#define SLAB_FRAMES 32768
+
+// benchmark methods
+static double benchPin (BM_BufferPool *bm, int *order, int n);
+static double benchLinearScan (BM_BufferPool *bm, int *order, int n);
+static void benchHitRatio (BM_BufferPool *bm);
+static void benchThreads (BM_BufferPool *bm);
+static void benchHugePages (BM_BufferPool *bm, int *order);
+static void *pinWorker (void *arg);
+
+// helper methods
+static double now (void);
+static void makeDayTrace (int *trace, int n);
+static void makeNightTrace (int *trace, int n);
+
+// main method
+int
+main (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  int sizes[] = { 10, 100, 1000, 10000, 100000 };
+  int *order;
+  int numScans;
+  int i, k;
+  double pin, scan;
+
+  order = (int *) malloc(BENCH_PINS * sizeof(int));
+
+  // the file stays sparse, the pages are only read
+  setPreallocationLimit(0);
+  CHECK(createPageFile(BENCH_FILE));
+
+  printf("pin/unpin of cached pages, %i pins per pool size\n", BENCH_PINS);
+  for (k = 0; k < (int) (sizeof(sizes) / sizeof(sizes[0])); k++)
+    {
+      CHECK(initBufferPool(bm, BENCH_FILE, sizes[k], RS_LRU, NULL));
+      // fill every frame
+      for (i = 0; i < sizes[k]; i++)
+	{
+	  CHECK(pinPage(bm, h, i));
+	  CHECK(unpinPage(bm, h));
+	}
+
+      srand(42);
+      for (i = 0; i < BENCH_PINS; i++)
+	order[i] = rand() % sizes[k];
+
+      pin = benchPin(bm, order, BENCH_PINS);
+      numScans = (int) (BENCH_SCAN_WORK / sizes[k]);
+      if (numScans > BENCH_PINS)
+	numScans = BENCH_PINS;
+      scan = benchLinearScan(bm, order, numScans);
+      printf("%7i frames   page table: %8.1f ns/pin   linear scan lookup: %10.1f ns\n",
+	     sizes[k], pin / BENCH_PINS * 1e9, scan / numScans * 1e9);
+
+      CHECK(shutdownBufferPool(bm));
+    }
+
+  benchHugePages(bm, order);
+  benchHitRatio(bm);
+  benchThreads(bm);
+
+  CHECK(destroyPageFile(BENCH_FILE));
+  setPreallocationLimit(SM_DEFAULT_PREALLOC_PAGES);
+  free(order);
+  free(h);
+  free(bm);
+  return 0;
+}
+
+// ************************************************************
+// pinPage and unpinPage of pages that are all in the pool
+static double
+benchPin (BM_BufferPool *bm, int *order, int n)
+{
+  BM_PageHandle h;
+  double start = now();
+  int i;
+
+  for (i = 0; i < n; i++)
+    {
+      CHECK(pinPage(bm, &h, order[i]));
+      CHECK(unpinPage(bm, &h));
+    }
+
+  return now() - start;
+}
+
+// ************************************************************
+// the frame search pinPage did before the page table, for reference
+static double
+benchLinearScan (BM_BufferPool *bm, int *order, int n)
+{
+  PageNumber *frames = getFrameContents(bm);
+  volatile int found = 0;
+  double start = now();
+  int i, j;
+
+  for (i = 0; i < n; i++)
+    for (j = 0; j < bm->numPages; j++)
+      if (frames[j] == order[i])
+	{
+	  found += j;
+	  break;
+	}
+
+  start = now() - start;
+  free(frames);
+  return start;
+}
+
+// ************************************************************
+// random pins that read their page, with the frame slab on ordinary and on
+// huge pages
+static void
+benchHugePages (BM_BufferPool *bm, int *order)
+{
+  BM_HugePages modes[] = { BM_HUGE_PAGES_OFF, BM_HUGE_PAGES_ADVISE, BM_HUGE_PAGES_ON };
+  char *names[] = { "off", "madvise", "hugetlb" };
+  BM_PageHandle h;
+  volatile char sum = 0;
+  double start;
+  int i, m;
+
+  printf("\nrandom pins reading their page, %i frames, %i pins\n", SLAB_FRAMES, BENCH_PINS);
+  srand(42);
+  for (i = 0; i < BENCH_PINS; i++)
+    order[i] = rand() % SLAB_FRAMES;
+
+  for (m = 0; m < (int) (sizeof(modes) / sizeof(modes[0])); m++)
+    {
+      setBufferPoolHugePages(modes[m]);
+      CHECK(initBufferPool(bm, BENCH_FILE, SLAB_FRAMES, RS_CLOCK, NULL));
+      for (i = 0; i < SLAB_FRAMES; i++)
+	{
+	  CHECK(pinPage(bm, &h, i));
+	  CHECK(unpinPage(bm, &h));
+	}
+
+      start = now();
+      for (i = 0; i < BENCH_PINS; i++)
+	{
+	  CHECK(pinPage(bm, &h, order[i]));
+	  sum += h.data[(order[i] * 64) % PAGE_SIZE];
+	  CHECK(unpinPage(bm, &h));
+	}
+      start = now() - start;
+      printf("huge pages %-8s %8.1f ns/pin\n", names[m], start / BENCH_PINS * 1e9);
+      CHECK(shutdownBufferPool(bm));
+    }
+  setBufferPoolHugePages(BM_HUGE_PAGES_ADVISE);
+}
+
+// ************************************************************
+// hit ratio of every strategy on a day of point lookups, a night of scans
+// and the next day. Each phase replays the same trace for all strategies.
+static void
+benchHitRatio (BM_BufferPool *bm)
+{
+  ReplacementStrategy strategies[] = { RS_FIFO, RS_LRU, RS_CLOCK, RS_LFU, RS_LRU_K, RS_ARC };
+  char *names[] = { "FIFO", "LRU", "CLOCK", "LFU", "LRU-K", "ARC" };
+  BM_PageHandle h;
+  int *phases[3];
+  int agingInterval = TRACE_FRAMES * 10;
+  int reads;
+  int i, k, p;
+
+  for (p = 0; p < 3; p++)
+    phases[p] = (int *) malloc(TRACE_PHASE_PINS * sizeof(int));
+  srand(42);
+  makeDayTrace(phases[0], TRACE_PHASE_PINS);
+  makeNightTrace(phases[1], TRACE_PHASE_PINS);
+  makeDayTrace(phases[2], TRACE_PHASE_PINS);
+
+  printf("\nhit ratio, %i frames over %i pages, %i pins per phase\n", TRACE_FRAMES, TRACE_PAGES, TRACE_PHASE_PINS);
+  printf("%-8s %10s %10s %10s\n", "strategy", "day", "night", "next day");
+  for (k = 0; k < (int) (sizeof(strategies) / sizeof(strategies[0])); k++)
+    {
+      CHECK(initBufferPool(bm, BENCH_FILE, TRACE_FRAMES, strategies[k],
+			   strategies[k] == RS_LFU ? &agingInterval : NULL));
+      printf("%-8s", names[k]);
+      for (p = 0; p < 3; p++)
+	{
+	  reads = getNumReadIO(bm);
+	  for (i = 0; i < TRACE_PHASE_PINS; i++)
+	    {
+	      CHECK(pinPage(bm, &h, phases[p][i]));
+	      CHECK(unpinPage(bm, &h));
+	    }
+	  printf(" %9.1f%%", 100.0 * (TRACE_PHASE_PINS - (getNumReadIO(bm) - reads)) / TRACE_PHASE_PINS);
+	}
+      printf("\n");
+      CHECK(shutdownBufferPool(bm));
+    }
+
+  for (p = 0; p < 3; p++)
+    free(phases[p]);
+}
+
+// ************************************************************
+// pin/unpin throughput of threads pinning random cached pages, with one
+// latch for the whole pool and with a partitioned pool
+typedef struct PinWorkerArgs {
+  BM_BufferPool *bm;
+  unsigned int seed;
+} PinWorkerArgs;
+
+static void
+benchThreads (BM_BufferPool *bm)
+{
+  BM_PageHandle h;
+  pthread_t threads[THREAD_MAX];
+  PinWorkerArgs args[THREAD_MAX];
+  int shards[] = { 1, THREAD_SHARDS };
+  double start, elapsed, single = 0;
+  int numThreads, i, k;
+
+  printf("\nthreads pinning cached pages, %i frames, %i pins per thread, %li cores online\n",
+	 THREAD_FRAMES, THREAD_PINS, sysconf(_SC_NPROCESSORS_ONLN));
+  for (k = 0; k < (int) (sizeof(shards) / sizeof(shards[0])); k++)
+    {
+      CHECK(initBufferPoolPartitioned(bm, BENCH_FILE, THREAD_FRAMES, RS_LRU, NULL, shards[k]));
+      // fill every frame
+      for (i = 0; i < THREAD_FRAMES; i++)
+	{
+	  CHECK(pinPage(bm, &h, i));
+	  CHECK(unpinPage(bm, &h));
+	}
+
+      for (numThreads = 1; numThreads <= THREAD_MAX; numThreads *= 2)
+	{
+	  start = now();
+	  for (i = 0; i < numThreads; i++)
+	    {
+	      args[i].bm = bm;
+	      args[i].seed = 42 + i;
+	      pthread_create(threads + i, NULL, pinWorker, args + i);
+	    }
+	  for (i = 0; i < numThreads; i++)
+	    pthread_join(threads[i], NULL);
+	  elapsed = now() - start;
+	  if (numThreads == 1)
+	    single = elapsed;
+	  printf("%2i shards %2i threads: %8.2f M pins/sec   scaling: %5.2fx\n", shards[k], numThreads,
+		 (double) numThreads * THREAD_PINS / elapsed / 1e6, numThreads * single / elapsed);
+	}
+      CHECK(shutdownBufferPool(bm));
+    }
+}
+
+static void *
+pinWorker (void *arg)
+{
+  PinWorkerArgs *args = (PinWorkerArgs *) arg;
+  BM_PageHandle h;
+  int i;
+
+  for (i = 0; i < THREAD_PINS; i++)
+    {
+      CHECK(pinPage(args->bm, &h, rand_r(&args->seed) % THREAD_FRAMES));
+      CHECK(unpinPage(args->bm, &h));
+    }
+  return NULL;
+}
+
+// ************************************************************
+// point lookups: nine of ten go to the hot pages
+static void
+makeDayTrace (int *trace, int n)
+{
+  int i;
+
+  for (i = 0; i < n; i++)
+    trace[i] = rand() % 10 ? rand() % TRACE_HOT_PAGES : rand() % TRACE_PAGES;
+}
+
+// sequential scans over the whole file, every fourth pin is a point lookup
+static void
+makeNightTrace (int *trace, int n)
+{
+  int i, next = 0;
+
+  for (i = 0; i < n; i++)
+    {
+      if (i % 4 == 3)
+	trace[i] = rand() % TRACE_HOT_PAGES;
+      else
+	{
+	  trace[i] = next;
+	  next = (next + 1) % TRACE_PAGES;
+	}
+    }
+}
+
+// ************************************************************
+static double
+now (void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
@@ -0,0 +1,228 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "dberror.h"
+#include "storage_mgr.h"
+#include "storage_mgr_aio.h"
+
+// benchmark parameters
+#define BENCH_FILE "bench_storage.bin"
+#define BENCH_PAGES 1024
+#define BENCH_ROUNDS 8
+#define BENCH_QUEUE_DEPTH 32
+
+// benchmark methods
+static double benchStdioRead (int *order, int n);
+static double benchStdioWrite (int *order, int n, char *page);
+static double benchHandleRead (SM_FileHandle *fh, int *order, int n);
+static double benchHandleWrite (SM_FileHandle *fh, int *order, int n, char *page);
+static double benchAsyncRead (SM_FileHandle *fh, int *order, int n, int depth);
+
+// helper methods
+static double now (void);
+static void shuffle (int *order, int n);
+static void report (char *name, double before, double after, int n);
+
+// main method
+int
+main (void)
+{
+  SM_FileHandle fh;
+  char *page;
+  int *order;
+  int n = BENCH_PAGES * BENCH_ROUNDS;
+  int i;
+  double before, after;
+
+  page = (char *) calloc(PAGE_SIZE, sizeof(char));
+  order = (int *) malloc(n * sizeof(int));
+  for (i = 0; i < n; i++)
+    order[i] = i % BENCH_PAGES;
+
+  CHECK(createPageFile(BENCH_FILE));
+  CHECK(openPageFile(BENCH_FILE, &fh));
+  CHECK(ensureCapacity(BENCH_PAGES, &fh));
+
+  printf("page file: %i pages of %i bytes, %i page accesses per run\n", BENCH_PAGES, PAGE_SIZE, n);
+
+  // sequential access
+  before = benchStdioWrite(order, n, page);
+  after = benchHandleWrite(&fh, order, n, page);
+  report("sequential write", before, after, n);
+
+  before = benchStdioRead(order, n);
+  after = benchHandleRead(&fh, order, n);
+  report("sequential read", before, after, n);
+
+  // random access
+  shuffle(order, n);
+  before = benchStdioWrite(order, n, page);
+  after = benchHandleWrite(&fh, order, n, page);
+  report("random write", before, after, n);
+
+  before = benchStdioRead(order, n);
+  after = benchHandleRead(&fh, order, n);
+  report("random read", before, after, n);
+
+  // random reads with several requests in flight
+  before = benchHandleRead(&fh, order, n);
+  after = benchAsyncRead(&fh, order, n, BENCH_QUEUE_DEPTH);
+  printf("%-18s sync:  %10.0f pages/sec   async: %10.0f pages/sec   speedup: %5.2fx  (queue depth %i)\n",
+	 "random read", n / before, n / after, before / after, BENCH_QUEUE_DEPTH);
+
+  CHECK(closePageFile(&fh));
+  CHECK(destroyPageFile(BENCH_FILE));
+  free(order);
+  free(page);
+  return 0;
+}
+
+// ************************************************************
+// the per-page fopen/fseek/fclose access path the storage manager used before.
+// Page i is at (i + 1) * PAGE_SIZE, behind the page file header.
+static double
+benchStdioRead (int *order, int n)
+{
+  char *page = (char *) malloc(PAGE_SIZE);
+  double start = now();
+  int i;
+
+  for (i = 0; i < n; i++)
+    {
+      FILE *fp = fopen(BENCH_FILE, "r");
+      fseek(fp, (long) (order[i] + 1) * PAGE_SIZE, SEEK_SET);
+      fread(page, sizeof(char), PAGE_SIZE, fp);
+      fclose(fp);
+    }
+
+  free(page);
+  return now() - start;
+}
+
+static double
+benchStdioWrite (int *order, int n, char *page)
+{
+  double start = now();
+  int i;
+
+  for (i = 0; i < n; i++)
+    {
+      FILE *fp = fopen(BENCH_FILE, "rb+");
+      fseek(fp, (long) (order[i] + 1) * PAGE_SIZE, SEEK_SET);
+      fwrite(page, PAGE_SIZE, 1, fp);
+      fclose(fp);
+    }
+
+  return now() - start;
+}
+
+// ************************************************************
+// the open handle with positional reads and writes
+static double
+benchHandleRead (SM_FileHandle *fh, int *order, int n)
+{
+  char *page = (char *) malloc(PAGE_SIZE);
+  double start = now();
+  int i;
+
+  for (i = 0; i < n; i++)
+    CHECK(readBlock(order[i], fh, page));
+
+  free(page);
+  return now() - start;
+}
+
+static double
+benchHandleWrite (SM_FileHandle *fh, int *order, int n, char *page)
+{
+  double start = now();
+  int i;
+
+  for (i = 0; i < n; i++)
+    CHECK(writeBlock(order[i], fh, page));
+
+  return now() - start;
+}
+
+// ************************************************************
+// the asynchronous engine, keeping depth reads in flight
+static double
+benchAsyncRead (SM_FileHandle *fh, int *order, int n, int depth)
+{
+  SM_AsyncIO *aio;
+  SM_AsyncRequest *reqs = (SM_AsyncRequest *) calloc(depth, sizeof(SM_AsyncRequest));
+  SM_AsyncRequest **done = (SM_AsyncRequest **) malloc(depth * sizeof(SM_AsyncRequest *));
+  double start;
+  int submitted = 0, reaped = 0;
+  int i, k;
+
+  CHECK(initAsyncIO(&aio, depth));
+  for (i = 0; i < depth; i++)
+    {
+      reqs[i].op = SM_AIO_READ;
+      reqs[i].fHandle = fh;
+      reqs[i].memPage = allocPageBuffer();
+    }
+
+  start = now();
+  for (i = 0; i < depth && submitted < n; i++, submitted++)
+    {
+      reqs[i].pageNum = order[submitted];
+      CHECK(submitAsyncIO(aio, reqs + i));
+    }
+  while (reaped < n)
+    {
+      k = reapAsyncIO(aio, done, depth, 1);
+      reaped += k;
+      for (i = 0; i < k; i++)
+	CHECK(done[i]->rc);
+      // reuse every completed request for the next page
+      for (i = 0; i < k && submitted < n; i++, submitted++)
+	{
+	  done[i]->pageNum = order[submitted];
+	  CHECK(submitAsyncIO(aio, done[i]));
+	}
+    }
+  start = now() - start;
+  printf("async engine: %s\n", asyncIOUsesUring(aio) ? "io_uring" : "worker threads");
+
+  CHECK(shutdownAsyncIO(aio));
+  for (i = 0; i < depth; i++)
+    freePageBuffer(reqs[i].memPage);
+  free(done);
+  free(reqs);
+  return start;
+}
+
+// ************************************************************
+static double
+now (void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void
+shuffle (int *order, int n)
+{
+  int i, j, tmp;
+
+  srand(42);
+  for (i = n - 1; i > 0; i--)
+    {
+      j = rand() % (i + 1);
+      tmp = order[i];
+      order[i] = order[j];
+      order[j] = tmp;
+    }
+}
+
+static void
+report (char *name, double before, double after, int n)
+{
+  printf("%-18s stdio: %10.0f pages/sec   handle: %10.0f pages/sec   speedup: %5.2fx\n",
+	 name, n / before, n / after, before / after);
+}
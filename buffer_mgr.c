@@ -1,8 +1,260 @@
+#define _GNU_SOURCE
 #include "buffer_mgr.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #include "dberror.h"
 #include "storage_mgr.h"
+#include "storage_mgr_aio.h"
+
+// requests the pool keeps in flight at most
+#define BM_AIO_QUEUE_DEPTH 32
+
+// size of the huge pages MAP_HUGETLB maps
+#define BM_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#define BM_TRACE_BUFFER 4096 // pin trace records written at once
+
+// private pool state
+typedef struct BM_PoolMgmt {
+    // frames as a struct of arrays: frame i holds page framePage[i] of file
+    // frameFile[i] in the pageSize bytes at frameData + i * pageSize. The
+    // pool allocates one slab for all frames and the arrays once; a shard's
+    // arrays are slices of the pool's.
+    char *slab; // set in the pool
+    size_t slabSize;
+    char *frameData;
+    int pageSize;
+    PageNumber *framePage;
+    int *frameFile; // index into files; a page is identified by file and page number
+    SM_FileHandle **files; // BM_MAX_FILES page files by file id, the pool's; slots change under fileLatch
+    BM_BufferPool **views; // handles of the files by file id, the pool at 0; resizeBufferPool updates their numPages
+    int *fixCounts; // grow under latch, unpinPage drops them atomically
+    bool *dirty; // changed through setFrameDirty
+    SM_AsyncIO *aio;
+    SM_AsyncRequest writeback; // write of the last dirty victim
+    SM_PageHandle writebackData; // copy of the victim, the frame is reused at once
+    bool writebackBusy; // set and cleared under aioLatch, read with atomic loads
+    bool writebackStaged; // writeback set up under the shard latch, not submitted yet; under aioLatch
+    RC writebackRC; // error of a finished writeback, reported by waitWriteback
+    BM_BufferPool *bm;
+    int readsInFlight; // prefetch reads not completed yet, counted in the pool under aioLatch
+    // prefetch reads outlive the call that started them: whoever needs the
+    // page or the frame publishes them with publishPrefetches. Set in the
+    // pool, guarded by aioLatch.
+    SM_AsyncRequest *prefetchReqs; // BM_AIO_QUEUE_DEPTH requests
+    int *prefetchFile; // file id of the page each request reads
+    int *freePrefetchReqs; // stack of unused requests
+    int numFreePrefetchReqs;
+    SM_AsyncRequest *prefetchesDone; // completed reads not published yet, linked through next
+    RC prefetchRC; // first prefetch read that failed since finishPrefetches
+    int numPrefetching; // frames of the shard claimed by prefetch reads, under latch
+    int numFlushRuns; // writeBlocks calls made by forceFlushPool
+    int numFlushPages; // pages written by forceFlushPool
+    int numDirty; // dirty frames, changed through setFrameDirty
+    int numDirtyEvictions; // dirty victims the pins had to write back themselves
+    int numWriterPages; // pages written by the background writer
+    int numWriterRuns;
+    BM_PoolStats *fileStats; // counters by file id, BM_MAX_FILES of them, under latch
+    int *pageTable; // open addressing with linear probing: (file, PageNumber) -> frame index, -1 for an empty slot
+    uint32_t pageTableMask; // slots - 1, the table has a power of two slots, at least twice numPages
+    int *freeFrames; // stack of frames that hold no page
+    int numFreeFrames;
+    long long *stamps; // strategyAttribute of every frame, time of the last load or pin, a slice like framePage
+    int stampsCapacity; // frames stamps has room for; pinned handles point into it, so it only moves while no page is pinned
+    long long *accessCounts; // pins of each frame's page since it was loaded, a slice like framePage
+    int *listPrev; // replacement list: loaded frames, oldest stamp first
+    int *listNext; // LIST_UNLINKED for frames not on the list, -1 at the ends
+    int listHead;
+    int listTail;
+    char *refBits; // RS_CLOCK: set when the frame's page is loaded or pinned
+    int clockHand; // RS_CLOCK: next frame the hand looks at
+    // RS_LFU: frames with the same reference count form a bucket, linked
+    // oldest first through listPrev/listNext; buckets are linked in
+    // ascending count order. At most numPages + 1 buckets exist at once.
+    int *bucketOf; // bucket of each frame, -1 when the frame is not counted
+    int *bucketCount; // reference count shared by the frames of a bucket
+    int *bucketFirst;
+    int *bucketLast;
+    int *bucketPrev;
+    int *bucketNext;
+    int bucketHead; // bucket with the lowest count
+    int *freeBuckets; // stack of unused buckets
+    int numFreeBuckets;
+    int agingInterval; // halve all counts every agingInterval references, 0: never
+    int refsSinceAging;
+    // RS_LRU_K: frames with fewer than k references are on the replacement
+    // list in LRU order and are evicted first; the others are in a min-heap
+    // keyed by their k-th most recent reference.
+    int k;
+    long long *refTimes; // k reference times per frame, newest first
+    int *numRefs; // references recorded per frame, at most k
+    int *heap; // frames by k-th most recent reference
+    int *heapPos; // position of each frame in heap, -1 when not in it
+    int heapSize;
+    int *heapSpill; // pinned frames popped while looking for a victim
+    int historySize; // direct mapped history of evicted pages, 0: none
+    PageNumber *historyPage;
+    int *historyFile;
+    long long *historyTimes;
+    int *historyRefs;
+    // RS_ARC: T1 holds pages referenced once recently and is the replacement
+    // list, T2 pages referenced at least twice. The ghost lists B1 and B2 keep
+    // the page numbers last evicted from T1 and T2 as entries numPages ..
+    // 2 * numPages - 1 of listPrev/listNext. A ghost hit moves the target
+    // size of T1 towards the list that would have kept the page.
+    char *arcList; // ARC_T1, ARC_T2, ARC_B1, ARC_B2 or 0 for every frame and ghost entry
+    int t2Head;
+    int t2Tail;
+    int b1Head;
+    int b1Tail;
+    int b2Head;
+    int b2Tail;
+    int t1Size;
+    int t2Size;
+    int b1Size;
+    int b2Size;
+    int arcTarget; // target size of T1, 0 .. numPages
+    PageNumber *ghostPage; // page of each ghost entry
+    int *ghostFile; // and its file
+    int *ghostTable; // open addressing like pageTable: (file, PageNumber) -> ghost entry
+    int *freeGhosts; // stack of unused ghost entries
+    int numFreeGhosts;
+    BM_BufferRing **ringOf; // ring that owns each frame, NULL for the frames of the replacement strategy
+    // threads: a pool is split into shards, every shard is a BM_BufferPool
+    // with its own frames and everything above. latch guards the shard; the
+    // asynchronous engine and the page file handle are shared by the shards
+    // and guarded by aioLatch and fileLatch. Latches are taken in the order
+    // latch, aioLatch, fileLatch, and nobody waits for I/O holding latch.
+    // Fix counts only grow under latch but unpinPage drops them atomically.
+    pthread_mutex_t latch;
+    pthread_cond_t loaded; // broadcast when a read into a frame finished
+    char *loading; // frames whose page is being read, LOADING_READ or LOADING_PREFETCH; the reader holds the pin
+    pthread_mutex_t *aioLatch;
+    pthread_mutex_t *fileLatch;
+    int shardIndex;
+    BM_BufferPool *pool; // the pool the shard belongs to, the pool itself in the pool
+    // set in the pool itself
+    pthread_mutex_t aioLock; // aioLatch of every shard
+    pthread_mutex_t fileLock; // fileLatch of every shard
+    int numShards; // 1 when the pool is its own only shard
+    // pin trace: pins add a record to traceBuffer under traceLock, which is
+    // written out whenever it is full
+    FILE *traceFile; // NULL while no trace runs, changed under traceLock, read with atomic loads
+    BM_TraceRecord *traceBuffer; // BM_TRACE_BUFFER records
+    int traceUsed;
+    long long traceStart;
+    RC traceRC; // first write of the trace that failed
+    pthread_mutex_t traceLock;
+    BM_BufferPool *shards; // numShards shards, NULL when numShards is 1
+    // background writer: wakes every intervalMs, or when kicked by a pin that
+    // wrote a dirty victim or by a shard short of clean frames, and writes
+    // the dirty unpinned frames next in line for eviction
+    pthread_t writer;
+    bool writerRunning;
+    bool writerStop;
+    bool writerKick;
+    pthread_mutex_t writerLock; // guards writerStop and writerKick, taken after latch
+    pthread_cond_t writerWake;
+    BM_WriterParams writerParams;
+    int numWriterRounds;
+} BM_PoolMgmt;
+
+#define LIST_UNLINKED -2
+#define LOADING_READ 1 // a pin reads the page and broadcasts loaded
+#define LOADING_PREFETCH 2 // an asynchronous prefetch read, see publishPrefetches
+// private RC: the shard's writeback slot is taken, finish it without the latch and retry
+#define RC_WRITEBACK_BUSY -1
+#define FIX_COUNT(poolMgmt, i) __atomic_load_n(&(poolMgmt)->fixCounts[i], __ATOMIC_ACQUIRE)
+#define FRAME_DATA(poolMgmt, i) ((poolMgmt)->frameData + (size_t)(i) * (poolMgmt)->pageSize)
+// first frame of shard i when numPages frames are split into numShards shards
+#define SHARD_FIRST(numPages, numShards, i) ((int)((long long)(i) * (numPages) / (numShards)))
+#define ARC_T1 1
+#define ARC_T2 2
+#define ARC_B1 3
+#define ARC_B2 4
+
+// a frame and its page, sorted by file and page number to find runs of adjacent pages
+typedef struct BM_FrameRef {
+    int fileId;
+    PageNumber pageNum;
+    int frameIndex;
+} BM_FrameRef;
+
+static BM_HugePages hugePages = BM_HUGE_PAGES_ADVISE;
+
+// local functions
+static int findFrame (BM_BufferPool *const bm, int fileId, const PageNumber pageNum);
+static RC getFreeFrame (BM_BufferPool *const bm, int *frameIndex);
+static RC evictFrame (BM_BufferPool *const bm, int *frameIndex);
+static RC startWriteback (BM_BufferPool *const bm, int frameIndex);
+static void submitWriteback (BM_BufferPool *const bm);
+static void issueWriteback (BM_BufferPool *const bm);
+static RC waitWriteback (BM_BufferPool *const bm);
+static void writebackDone (SM_AsyncRequest *req);
+static void prefetchDone (SM_AsyncRequest *req);
+static int publishPrefetches (BM_BufferPool *const bm, int minDone);
+static void waitLoaded (BM_PoolMgmt *poolMgmt);
+static int comparePageNums (const void *a, const void *b);
+static uint32_t pageSlot (BM_PoolMgmt *poolMgmt, int fileId, const PageNumber pageNum);
+static void pageTableInsert (BM_BufferPool *const bm, int frameIndex);
+static void pageTableRemove (BM_BufferPool *const bm, int frameIndex);
+static void releaseFrame (BM_BufferPool *const bm, int frameIndex);
+static void listAppend (BM_PoolMgmt *poolMgmt, int *head, int *tail, int frameIndex);
+static void listRemove (BM_PoolMgmt *poolMgmt, int *head, int *tail, int frameIndex);
+static void lfuCount (BM_BufferPool *const bm, int frameIndex);
+static void lfuRemove (BM_PoolMgmt *poolMgmt, int frameIndex);
+static int lfuNewBucket (BM_PoolMgmt *poolMgmt, int count, int prev);
+static void lfuFreeBucket (BM_PoolMgmt *poolMgmt, int bucket);
+static void lfuAge (BM_PoolMgmt *poolMgmt);
+static void lrukReference (BM_BufferPool *const bm, int frameIndex);
+static void lrukForget (BM_BufferPool *const bm, int frameIndex);
+static long long lrukKey (BM_PoolMgmt *poolMgmt, int frameIndex);
+static int historySlot (BM_PoolMgmt *poolMgmt, int fileId, const PageNumber pageNum);
+static void heapInsert (BM_PoolMgmt *poolMgmt, int frameIndex);
+static void heapRemove (BM_PoolMgmt *poolMgmt, int frameIndex);
+static void heapSiftUp (BM_PoolMgmt *poolMgmt, int pos);
+static void heapSiftDown (BM_PoolMgmt *poolMgmt, int pos);
+static void arcReference (BM_BufferPool *const bm, int frameIndex);
+static void arcForget (BM_BufferPool *const bm, int frameIndex, bool keepGhost);
+static void arcDropGhost (BM_BufferPool *const bm, int entry);
+static int arcFindGhost (BM_BufferPool *const bm, int fileId, const PageNumber pageNum);
+static RC getRingFrame (BM_BufferPool *const bm, BM_BufferRing *const ring, int *frameIndex);
+static RC initPool (BM_BufferPool *const bm, SM_FileHandle *fh, int pageSize, const int numPages,
+                    ReplacementStrategy strategy, void *stratData, int numShards);
+static void initShard (BM_BufferPool *const shard, BM_BufferPool *const pool, int firstFrame,
+                       int numFrames, void *stratData, int shardIndex);
+static void initShardFrames (BM_BufferPool *const shard, BM_BufferPool *const pool, int firstFrame,
+                             int numFrames);
+static void freeShard (BM_BufferPool *const shard);
+static void freeShardFrames (BM_PoolMgmt *poolMgmt);
+static RC checkResize (BM_BufferPool *const pool, int numPages, bool *pinned);
+static RC growFrameSlab (BM_BufferPool *const pool, int numPages, bool pinned);
+static RC evictFrames (BM_BufferPool *const shard, int numFrames);
+static void relayoutPool (BM_BufferPool *const pool, int numPages);
+static void adoptFrames (BM_BufferPool *const shard, BM_PoolMgmt *old, int oldFrames, const int *newIndex);
+static BM_BufferPool *shardOf (BM_BufferPool *const bm, int fileId, const PageNumber pageNum);
+static BM_BufferPool *getShard (BM_BufferPool *const bm, int i);
+static RC finishWriteback (BM_BufferPool *const shard);
+static RC flushShard (BM_BufferPool *const shard, int fileId);
+static void latchShards (BM_BufferPool *const bm, bool lock);
+static RC writeFrames (BM_BufferPool *const shard, int *dirty, int numDirty,
+                       int *numPages, int *numRuns, bool forced);
+static void setFrameDirty (BM_BufferPool *const shard, int frameIndex, bool dirty);
+static void kickWriter (BM_BufferPool *const shard);
+static void *backgroundWriter (void *arg);
+static void cleanShard (BM_BufferPool *const shard, int *budget);
+static int nextVictims (BM_BufferPool *const bm, int *frames, int max);
+static void touchFrame (BM_BufferPool *const bm, int frameIndex);
+static char *allocFrameSlab (size_t *size);
+static long long clockNs (void);
+static void tracePin (BM_BufferPool *const bm, const PageNumber pageNum, bool hit);
+static void writeTrace (BM_PoolMgmt *poolMgmt);
 
 /*
  // Replacement Strategies
@@ -45,7 +297,7 @@ typedef struct BM_PageHandle {
 /***************************************************************
  * Function Name: initBufferPool
  *
- * Description: initBufferPool creates a new buffer pool with numPages page frames using the page replacement strategy strategy. The pool is used to cache pages from the page file with name pageFileName. Initially, all page frames should be empty. The page file should already exist, i.e., this method should not generate a new page file. stratData can be used to pass parameters for the page replacement strategy. For example, for LRU-k this could be the parameter k.
+ * Description: initBufferPool creates a new buffer pool with numPages page frames using the page replacement strategy strategy. The pool is used to cache pages from the page file with name pageFileName. Initially, all page frames should be empty. The page file should already exist, i.e., this method should not generate a new page file. stratData can be used to pass parameters for the page replacement strategy. For example, for LRU-k this could be the parameter k. For RS_LFU it may point to an int: every that many references all reference counts are halved. For RS_LRU_K it may point to a BM_LRUKParams with k and the number of evicted pages whose history is kept; NULL gives k = 2 and a history of numPages pages.
  *
  * Parameters: BM_BufferPool *const bm, const char *const pageFileName, const int numPages, ReplacementStrategy strategy, void *stratData.
  *
@@ -57,38 +309,339 @@ typedef struct BM_PageHandle {
  *      Date            Name                        Content
  *      16/02/24        Xiaoliang Wu                Not init pageHandle.
  *  02/27/16        Zhipeng Liu         add some init
+ *      26/10/16        agent                       Build a pool of one shard with initBufferPoolPartitioned.
 ***************************************************************/
 
 RC initBufferPool(BM_BufferPool *const bm, const char *const pageFileName,
                   const int numPages, ReplacementStrategy strategy,
                   void *stratData) {
-    FILE *file;
-    int i;
+    return initBufferPoolPartitioned(bm, pageFileName, numPages, strategy, stratData, 1);
+}
 
-    file = fopen(pageFileName, "r");
-    if (file == NULL) {
-        return RC_FILE_NOT_FOUND;
-    } else {
-        fclose(file);
+/***************************************************************
+ * Function Name: initBufferPoolPartitioned
+ *
+ * Description: create a buffer pool like initBufferPool whose frames are split into numShards shards. Runs of BM_SHARD_PAGES pages are spread over the shards by a hash, and every shard has its own page table, replacement state and latch, so threads that pin different pages rarely wait for each other. Every shard runs strategy on its own frames; the LRU-K history is split between the shards. numShards is at most numPages.
+ *
+ * Parameters: BM_BufferPool *const bm, const char *const pageFileName, const int numPages, ReplacementStrategy strategy, void *stratData, int numShards
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+
+RC initBufferPoolPartitioned(BM_BufferPool *const bm, const char *const pageFileName,
+                             const int numPages, ReplacementStrategy strategy,
+                             void *stratData, int numShards) {
+    SM_FileHandle *fh;
+    RC RC_flag;
+
+    fh = (SM_FileHandle *)calloc(1, sizeof(SM_FileHandle));
+    RC_flag = openPageFile((char *)pageFileName, fh);
+    if (RC_flag != RC_OK) {
+        free(fh);
+        return RC_flag;
+    }
+    RC_flag = initPool(bm, fh, fh->pageSize, numPages, strategy, stratData, numShards);
+    if (RC_flag != RC_OK) {
+        closePageFile(fh);
+        free(fh);
+        return RC_flag;
     }
     bm->pageFile = (char *)pageFileName;
+    return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: initSharedBufferPool
+ *
+ * Description: create a buffer pool like initBufferPoolPartitioned that has no page file of its own. Page files are attached to it with attachPageFile and share its numPages frames of pageSize bytes; pages of every file with pages of at most pageSize bytes can be cached. Pages are pinned through the handles attachPageFile fills, not through bm.
+ *
+ * Parameters: BM_BufferPool *const bm, const int numPages, const int pageSize, ReplacementStrategy strategy, void *stratData, int numShards
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+
+RC initSharedBufferPool(BM_BufferPool *const bm, const int numPages, const int pageSize,
+                        ReplacementStrategy strategy, void *stratData, int numShards) {
+    if (pageSize < SM_MIN_PAGE_SIZE || pageSize > SM_MAX_PAGE_SIZE || (pageSize & (pageSize - 1)) != 0)
+        return RC_PAGE_SIZE_MISMATCH;
+    return initPool(bm, NULL, pageSize, numPages, strategy, stratData, numShards);
+}
+
+/***************************************************************
+ * Function Name: initPool
+ *
+ * Description: set up bm as a pool of numPages frames of pageSize bytes in numShards shards, see initBufferPoolPartitioned. fh is the pool's own page file, file id 0, or NULL for a shared pool. On failure nothing is left allocated and fh stays open.
+ *
+ * Parameters: BM_BufferPool *const bm, SM_FileHandle *fh, int pageSize, const int numPages, ReplacementStrategy strategy, void *stratData, int numShards
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+
+static RC initPool(BM_BufferPool *const bm, SM_FileHandle *fh, int pageSize, const int numPages,
+                   ReplacementStrategy strategy, void *stratData, int numShards) {
+    BM_PoolMgmt *poolMgmt;
+    BM_BufferPool *shard;
+    RC RC_flag;
+    int first, i;
+
+    if (strategy == RS_LRU_K && stratData != NULL
+        && (((BM_LRUKParams *)stratData)->k < 1 || ((BM_LRUKParams *)stratData)->historySize < 0))
+        return RC_STRATEGY_NOT_FOUND;
+    if (numShards > numPages)
+        numShards = numPages;
+    if (numShards < 1)
+        numShards = 1;
+
+    poolMgmt = (BM_PoolMgmt *)calloc(1, sizeof(BM_PoolMgmt));
+    RC_flag = initAsyncIO(&poolMgmt->aio, BM_AIO_QUEUE_DEPTH);
+    if (RC_flag != RC_OK) {
+        free(poolMgmt);
+        return RC_flag;
+    }
+    poolMgmt->slabSize = (size_t)numPages * pageSize;
+    poolMgmt->slab = allocFrameSlab(&poolMgmt->slabSize);
+    if (poolMgmt->slab == NULL) {
+        shutdownAsyncIO(poolMgmt->aio);
+        free(poolMgmt);
+        return RC_NO_FREE_FRAME;
+    }
+    pthread_mutex_init(&poolMgmt->aioLock, NULL);
+    pthread_mutex_init(&poolMgmt->fileLock, NULL);
+    pthread_mutex_init(&poolMgmt->traceLock, NULL);
+    pthread_mutex_init(&poolMgmt->writerLock, NULL);
+    pthread_cond_init(&poolMgmt->writerWake, NULL);
+    poolMgmt->prefetchReqs = (SM_AsyncRequest *)calloc(BM_AIO_QUEUE_DEPTH, sizeof(SM_AsyncRequest));
+    poolMgmt->prefetchFile = (int *)calloc(BM_AIO_QUEUE_DEPTH, sizeof(int));
+    poolMgmt->freePrefetchReqs = (int *)malloc(BM_AIO_QUEUE_DEPTH * sizeof(int));
+    for (i = 0; i < BM_AIO_QUEUE_DEPTH; i++)
+        poolMgmt->freePrefetchReqs[i] = i;
+    poolMgmt->numFreePrefetchReqs = BM_AIO_QUEUE_DEPTH;
+    poolMgmt->prefetchRC = RC_OK;
+    poolMgmt->numShards = numShards;
+    poolMgmt->files = (SM_FileHandle **)calloc(BM_MAX_FILES, sizeof(SM_FileHandle *));
+    poolMgmt->files[0] = fh;
+    poolMgmt->views = (BM_BufferPool **)calloc(BM_MAX_FILES, sizeof(BM_BufferPool *));
+    poolMgmt->views[0] = bm;
+    poolMgmt->pool = bm;
+    bm->pageFile = NULL;
+    bm->fh = fh;
+    bm->fileId = 0;
+    bm->poolMgmt = poolMgmt;
     bm->numPages = numPages;
     bm->strategy = strategy;
-    BM_PageHandle* buff = (BM_PageHandle *)calloc(numPages, sizeof(BM_PageHandle));
-    bm->mgmtData = buff;
+    bm->mgmtData = NULL;
+    poolMgmt->frameData = poolMgmt->slab;
+    poolMgmt->pageSize = pageSize;
+    poolMgmt->framePage = (PageNumber *)malloc(numPages * sizeof(PageNumber));
     for (i = 0; i < numPages; i++)
-    {
-        (bm->mgmtData + i)->dirty = 0;
-        (bm->mgmtData + i)->fixCounts = 0;
-        (bm->mgmtData + i)->data = NULL;
-        (bm->mgmtData + i)->pageNum = -1;
-    }
+        poolMgmt->framePage[i] = NO_PAGE;
+    poolMgmt->frameFile = (int *)calloc(numPages, sizeof(int));
+    poolMgmt->fixCounts = (int *)calloc(numPages, sizeof(int));
+    poolMgmt->dirty = (bool *)calloc(numPages, sizeof(bool));
+    // room to grow with pages pinned
+    poolMgmt->stampsCapacity = 2 * numPages;
+    poolMgmt->stamps = (long long *)calloc(poolMgmt->stampsCapacity, sizeof(long long));
+    poolMgmt->accessCounts = (long long *)calloc(numPages, sizeof(long long));
     bm->numReadIO = 0;
     bm->numWriteIO = 0;
     bm->timer = 0;
+
+    if (numShards == 1) {
+        initShard(bm, bm, 0, numPages, stratData, 0);
+        return RC_OK;
+    }
+    poolMgmt->shards = (BM_BufferPool *)calloc(numShards, sizeof(BM_BufferPool));
+    for (i = 0; i < numShards; i++) {
+        shard = poolMgmt->shards + i;
+        first = SHARD_FIRST(numPages, numShards, i);
+        shard->fh = fh;
+        shard->strategy = strategy;
+        shard->poolMgmt = (BM_PoolMgmt *)calloc(1, sizeof(BM_PoolMgmt));
+        initShard(shard, bm, first, SHARD_FIRST(numPages, numShards, i + 1) - first, stratData, i);
+    }
     return RC_OK;
 }
 
+/***************************************************************
+ * Function Name: initShard
+ *
+ * Description: set up shard to manage the numFrames frames of pool starting at firstFrame: page table, free frame stack, replacement state and latch. shard->poolMgmt, fh and strategy must be set; shard may be pool itself. The shard shares the asynchronous engine and the page file of pool.
+ *
+ * Parameters: BM_BufferPool *const shard, BM_BufferPool *const pool, int firstFrame, int numFrames, void *stratData, int shardIndex
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+
+static void initShard(BM_BufferPool *const shard, BM_BufferPool *const pool, int firstFrame,
+                      int numFrames, void *stratData, int shardIndex) {
+    BM_PoolMgmt *poolMgmt = shard->poolMgmt;
+    ReplacementStrategy strategy = shard->strategy;
+
+    poolMgmt->aio = pool->poolMgmt->aio;
+    poolMgmt->aioLatch = &pool->poolMgmt->aioLock;
+    poolMgmt->fileLatch = &pool->poolMgmt->fileLock;
+    poolMgmt->shardIndex = shardIndex;
+    poolMgmt->pool = pool;
+    pthread_mutex_init(&poolMgmt->latch, NULL);
+    pthread_cond_init(&poolMgmt->loaded, NULL);
+    poolMgmt->writebackData = allocPageBufferSize(pool->poolMgmt->pageSize);
+    poolMgmt->writeback.callback = writebackDone;
+    poolMgmt->writeback.userData = poolMgmt;
+    poolMgmt->writebackRC = RC_OK;
+    poolMgmt->bm = shard;
+    poolMgmt->fileStats = (BM_PoolStats *)calloc(BM_MAX_FILES, sizeof(BM_PoolStats));
+    if (strategy == RS_LFU)
+        poolMgmt->agingInterval = stratData != NULL ? *(int *)stratData : 0;
+    if (strategy == RS_LRU_K) {
+        poolMgmt->k = BM_LRU_K_DEFAULT_K;
+        poolMgmt->historySize = numFrames;
+        if (stratData != NULL) {
+            poolMgmt->k = ((BM_LRUKParams *)stratData)->k;
+            poolMgmt->historySize = (int)((long long)((BM_LRUKParams *)stratData)->historySize
+                                          * numFrames / pool->numPages);
+        }
+    }
+    initShardFrames(shard, pool, firstFrame, numFrames);
+    shard->mgmtData = NULL;
+    shard->numReadIO = 0;
+    shard->numWriteIO = 0;
+    shard->timer = 0;
+}
+
+/***************************************************************
+ * Function Name: initShardFrames
+ *
+ * Description: set up everything of shard that is sized by its numFrames frames, starting at frame firstFrame of pool: the page table, free frame stack and replacement state, all frames empty. Settings of the strategy (agingInterval, k, historySize) must be set in shard->poolMgmt. Used by initShard and, for the new size, by resizeBufferPool.
+ *
+ * Parameters: BM_BufferPool *const shard, BM_BufferPool *const pool, int firstFrame, int numFrames
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+
+static void initShardFrames(BM_BufferPool *const shard, BM_BufferPool *const pool, int firstFrame,
+                            int numFrames) {
+    BM_PoolMgmt *poolMgmt = shard->poolMgmt;
+    ReplacementStrategy strategy = shard->strategy;
+    const int numPages = numFrames;
+    uint32_t slots;
+    int listSize;
+    int i;
+
+    poolMgmt->loading = (char *)calloc(numPages, sizeof(char));
+    for (slots = 2; slots < 2 * (uint32_t)numPages; slots <<= 1)
+        ;
+    poolMgmt->pageTable = (int *)malloc(slots * sizeof(int));
+    memset(poolMgmt->pageTable, -1, slots * sizeof(int));
+    poolMgmt->pageTableMask = slots - 1;
+    // frames are handed out from frame 0 upwards
+    poolMgmt->freeFrames = (int *)malloc(numPages * sizeof(int));
+    for (i = 0; i < numPages; i++)
+        poolMgmt->freeFrames[i] = numPages - 1 - i;
+    poolMgmt->numFreeFrames = numPages;
+    // RS_ARC links its ghost entries behind the frames
+    listSize = strategy == RS_ARC ? 2 * numPages : numPages;
+    poolMgmt->listPrev = (int *)malloc(listSize * sizeof(int));
+    poolMgmt->listNext = (int *)malloc(listSize * sizeof(int));
+    for (i = 0; i < listSize; i++)
+        poolMgmt->listPrev[i] = poolMgmt->listNext[i] = LIST_UNLINKED;
+    poolMgmt->listHead = poolMgmt->listTail = -1;
+    poolMgmt->refBits = (char *)calloc(numPages, sizeof(char));
+    poolMgmt->clockHand = 0;
+    poolMgmt->ringOf = (BM_BufferRing **)calloc(numPages, sizeof(BM_BufferRing *));
+    if (strategy == RS_LFU) {
+        poolMgmt->bucketOf = (int *)malloc(numPages * sizeof(int));
+        memset(poolMgmt->bucketOf, -1, numPages * sizeof(int));
+        poolMgmt->bucketCount = (int *)malloc((numPages + 1) * sizeof(int));
+        poolMgmt->bucketFirst = (int *)malloc((numPages + 1) * sizeof(int));
+        poolMgmt->bucketLast = (int *)malloc((numPages + 1) * sizeof(int));
+        poolMgmt->bucketPrev = (int *)malloc((numPages + 1) * sizeof(int));
+        poolMgmt->bucketNext = (int *)malloc((numPages + 1) * sizeof(int));
+        poolMgmt->freeBuckets = (int *)malloc((numPages + 1) * sizeof(int));
+        for (i = 0; i <= numPages; i++)
+            poolMgmt->freeBuckets[i] = i;
+        poolMgmt->numFreeBuckets = numPages + 1;
+        poolMgmt->bucketHead = -1;
+    }
+    if (strategy == RS_LRU_K) {
+        poolMgmt->refTimes = (long long *)calloc((size_t)numPages * poolMgmt->k, sizeof(long long));
+        poolMgmt->numRefs = (int *)calloc(numPages, sizeof(int));
+        poolMgmt->heap = (int *)malloc(numPages * sizeof(int));
+        poolMgmt->heapPos = (int *)malloc(numPages * sizeof(int));
+        memset(poolMgmt->heapPos, -1, numPages * sizeof(int));
+        poolMgmt->heapSize = 0;
+        poolMgmt->heapSpill = (int *)malloc(numPages * sizeof(int));
+        poolMgmt->historyPage = (PageNumber *)malloc(poolMgmt->historySize * sizeof(PageNumber));
+        for (i = 0; i < poolMgmt->historySize; i++)
+            poolMgmt->historyPage[i] = NO_PAGE;
+        poolMgmt->historyFile = (int *)calloc(poolMgmt->historySize, sizeof(int));
+        poolMgmt->historyTimes = (long long *)calloc((size_t)poolMgmt->historySize * poolMgmt->k, sizeof(long long));
+        poolMgmt->historyRefs = (int *)calloc(poolMgmt->historySize, sizeof(int));
+    }
+    if (strategy == RS_ARC) {
+        poolMgmt->arcList = (char *)calloc(2 * numPages, sizeof(char));
+        poolMgmt->t2Head = poolMgmt->t2Tail = -1;
+        poolMgmt->b1Head = poolMgmt->b1Tail = -1;
+        poolMgmt->b2Head = poolMgmt->b2Tail = -1;
+        poolMgmt->t1Size = poolMgmt->t2Size = poolMgmt->b1Size = poolMgmt->b2Size = 0;
+        poolMgmt->arcTarget = 0;
+        poolMgmt->ghostPage = (PageNumber *)malloc(numPages * sizeof(PageNumber));
+        poolMgmt->ghostFile = (int *)malloc(numPages * sizeof(int));
+        poolMgmt->ghostTable = (int *)malloc(slots * sizeof(int));
+        memset(poolMgmt->ghostTable, -1, slots * sizeof(int));
+        poolMgmt->freeGhosts = (int *)malloc(numPages * sizeof(int));
+        for (i = 0; i < numPages; i++)
+            poolMgmt->freeGhosts[i] = numPages + i;
+        poolMgmt->numFreeGhosts = numPages;
+    }
+    if (shard != pool) {
+        poolMgmt->frameData = pool->poolMgmt->frameData + (size_t)firstFrame * pool->poolMgmt->pageSize;
+        poolMgmt->pageSize = pool->poolMgmt->pageSize;
+        poolMgmt->framePage = pool->poolMgmt->framePage + firstFrame;
+        poolMgmt->frameFile = pool->poolMgmt->frameFile + firstFrame;
+        poolMgmt->files = pool->poolMgmt->files;
+        poolMgmt->fixCounts = pool->poolMgmt->fixCounts + firstFrame;
+        poolMgmt->dirty = pool->poolMgmt->dirty + firstFrame;
+        poolMgmt->stamps = pool->poolMgmt->stamps + firstFrame;
+        poolMgmt->accessCounts = pool->poolMgmt->accessCounts + firstFrame;
+    }
+    shard->numPages = numPages;
+}
+
 /***************************************************************
  * Function Name: shutdownBufferPool
  *
@@ -105,15 +658,21 @@ RC initBufferPool(BM_BufferPool *const bm, const char *const pageFileName,
  *      16/02/24        Xiaoliang Wu                Complete.
  *      16/02/26        Xiaoliang Wu                Free buffer in pages.
  *      16/02/27        Xincheng Yang               Free fixCounts.
+ *      26/10/17        agent                       Stop the writer and the trace, wait for the prefetch reads, free the shards and close the attached files.
  *
 ***************************************************************/
 
 
 RC shutdownBufferPool(BM_BufferPool *const bm) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
     int *fixCounts;
     int i;
-    RC RC_flag;
+    RC RC_flag, result = RC_OK;
 
+    // prefetch reads hold their frames until they are published
+    finishPrefetches(bm);
+    // the writer pins the frames it writes during a round
+    stopBackgroundWriter(bm);
     fixCounts = getFixCounts(bm);
     for (i = 0; i < bm->numPages; ++i) {
         if (*(fixCounts + i)) {
@@ -127,529 +686,4126 @@ RC shutdownBufferPool(BM_BufferPool *const bm) {
         free(fixCounts);
         return RC_flag;
     }
+    result = stopPoolTrace(bm);
 
     freePagesBuffer(bm);
     free(fixCounts);
-    free(bm->mgmtData);
-    return RC_OK;
+    shutdownAsyncIO(poolMgmt->aio);
+    for (i = 0; i < poolMgmt->numShards; i++)
+        freeShard(getShard(bm, i));
+    if (poolMgmt->shards != NULL) {
+        for (i = 0; i < poolMgmt->numShards; i++)
+            free(poolMgmt->shards[i].poolMgmt);
+        free(poolMgmt->shards);
+    }
+    // the handles of files never detached are invalid from now on
+    for (i = 0; i < BM_MAX_FILES; i++) {
+        if (poolMgmt->files[i] == NULL)
+            continue;
+        RC_flag = closePageFile(poolMgmt->files[i]);
+        if (result == RC_OK)
+            result = RC_flag;
+        free(poolMgmt->files[i]);
+    }
+    free(poolMgmt->files);
+    free(poolMgmt->views);
+    free(poolMgmt->framePage);
+    free(poolMgmt->frameFile);
+    free(poolMgmt->fixCounts);
+    free(poolMgmt->dirty);
+    free(poolMgmt->stamps);
+    free(poolMgmt->accessCounts);
+    free(poolMgmt->prefetchReqs);
+    free(poolMgmt->prefetchFile);
+    free(poolMgmt->freePrefetchReqs);
+    pthread_mutex_destroy(&poolMgmt->aioLock);
+    pthread_mutex_destroy(&poolMgmt->fileLock);
+    pthread_mutex_destroy(&poolMgmt->traceLock);
+    pthread_mutex_destroy(&poolMgmt->writerLock);
+    pthread_cond_destroy(&poolMgmt->writerWake);
+    free(poolMgmt);
+    bm->poolMgmt = NULL;
+    bm->fh = NULL;
+    return result;
 }
 
 /***************************************************************
- * Function Name: forceFlushPool
+ * Function Name: attachPageFile
  *
- * Description: forceFlushPool causes all dirty pages (with fix count 0) from the buffer pool to be written to disk.
+ * Description: open the page file pageFileName and make bm its handle in pool: the file's pages are cached in the frames of pool, next to the pages of the pool's other files, and keyed by a file id and their page number. bm is used like a pool of its own with pinPage, markDirty, unpinPage, forcePage, the prefetches and scan rings; the statistics, forceFlushPool and the background writer of bm cover the whole pool, except getPoolStats, which counts the pins of the file. The file's pages must fit into the frames of pool, and at most BM_MAX_FILES files are open in a pool at once.
  *
- * Parameters: BM_BufferPool *const bm
+ * Parameters: BM_BufferPool *const pool, BM_BufferPool *const bm, const char *const pageFileName
  *
  * Return: RC
  *
- * Author: Xiaoliang Wu
+ * Author: agent
  *
  * History:
  *      Date            Name                        Content
- *      16/02/25        Xiaoliang Wu                Complete, forcepage need set dirty to 0.
- *      16/02/27        Xincheng Yang               free fixCounts and dirtyFlags.
+ *      26/10/17        agent                       Complete.
  *
 ***************************************************************/
 
-RC forceFlushPool(BM_BufferPool *const bm) {
-    bool *dirtyFlags;
-    int *fixCounts;
-    int i;
-    BM_PageHandle* page;
+RC attachPageFile(BM_BufferPool *const pool, BM_BufferPool *const bm,
+                  const char *const pageFileName) {
+    BM_PoolMgmt *poolMgmt = pool->poolMgmt;
+    BM_BufferPool *shard;
+    SM_FileHandle *fh;
+    int fileId, i;
     RC RC_flag;
 
-    dirtyFlags = getDirtyFlags(bm);
-    fixCounts = getFixCounts(bm);
+    fh = (SM_FileHandle *)calloc(1, sizeof(SM_FileHandle));
+    RC_flag = openPageFile((char *)pageFileName, fh);
+    if (RC_flag != RC_OK) {
+        free(fh);
+        return RC_flag;
+    }
+    if (fh->pageSize > poolMgmt->pageSize) {
+        closePageFile(fh);
+        free(fh);
+        return RC_PAGE_SIZE_MISMATCH;
+    }
 
-    for (i = 0; i < bm->numPages; ++i) {
-        if (*(dirtyFlags + i)) {
-//printf("%s\n",*(dirtyFlags)?"true":"false");
-            if (*(fixCounts + i)) {
-                continue;
-            } else {
-                page = ((bm->mgmtData) + i);
-                RC_flag = forcePage(bm, page);
-                if (RC_flag != RC_OK) {
-                    free(dirtyFlags);
-                    free(fixCounts);
-                    return RC_flag;
-                }
-            }
-        }
+    // file id 0 is the pool's own file
+    pthread_mutex_lock(&poolMgmt->fileLock);
+    for (fileId = 1; fileId < BM_MAX_FILES && poolMgmt->files[fileId] != NULL; fileId++)
+        ;
+    if (fileId < BM_MAX_FILES) {
+        poolMgmt->files[fileId] = fh;
+        poolMgmt->views[fileId] = bm;
     }
-    for (i = 0; i < bm->numPages; ++i)
-    {
-        if (*(dirtyFlags + i))
-            ((bm->mgmtData) + i)->dirty = 0;
+    pthread_mutex_unlock(&poolMgmt->fileLock);
+    if (fileId == BM_MAX_FILES) {
+        closePageFile(fh);
+        free(fh);
+        return RC_TOO_MANY_FILES;
+    }
+    // the id may have belonged to a detached file
+    for (i = 0; i < poolMgmt->numShards; i++) {
+        shard = getShard(pool, i);
+        pthread_mutex_lock(&shard->poolMgmt->latch);
+        memset(shard->poolMgmt->fileStats + fileId, 0, sizeof(BM_PoolStats));
+        pthread_mutex_unlock(&shard->poolMgmt->latch);
     }
 
-    free(dirtyFlags);
-    free(fixCounts);
+    bm->pageFile = (char *)pageFileName;
+    bm->fh = fh;
+    bm->fileId = fileId;
+    bm->poolMgmt = poolMgmt;
+    bm->numPages = pool->numPages;
+    bm->strategy = pool->strategy;
+    bm->mgmtData = NULL;
+    bm->numReadIO = 0;
+    bm->numWriteIO = 0;
+    bm->timer = 0;
     return RC_OK;
 }
 
-// Buffer Manager Interface Access Pages
-
 /***************************************************************
- * Function Name: markDirty
+ * Function Name: detachPageFile
  *
- * Description:mark a page as dirty
+ * Description: close a page file attached with attachPageFile. Its dirty pages are written back and all its pages leave the pool, whose frames stay for the other files. It is an error to detach a file that has pinned pages.
  *
- * Parameters: BM_BufferPool *const bm, BM_PageHandle *const page
+ * Parameters: BM_BufferPool *const bm
  *
- * Return:RC
+ * Return: RC
  *
- * Author:Zhipeng Liu
+ * Author: agent
  *
  * History:
  *      Date            Name                        Content
- *      02/25/16        Zhipeng Liu                 complete
+ *      26/10/17        agent                       Complete.
+ *
 ***************************************************************/
 
-RC markDirty (BM_BufferPool *const bm, BM_PageHandle *const page)
-{
-    int i;
-    for (i = 0; i < (bm->numPages); i++)
-    {
-        if ((bm->mgmtData + i)->pageNum == page->pageNum)
-        {
-            page->dirty = 1;
-            (bm->mgmtData + i)->dirty = 1;
-            break;
+RC detachPageFile(BM_BufferPool *const bm) {
+    BM_PoolMgmt *pool = bm->poolMgmt;
+    BM_BufferPool *shard;
+    BM_PoolMgmt *poolMgmt;
+    bool pinned = FALSE;
+    int i, s;
+    RC RC_flag;
+
+    if (bm->fileId == 0)
+        return RC_FILE_HANDLE_NOT_INIT;
+    // prefetch reads hold their frames until they are published
+    finishPrefetches(bm);
+    latchShards(bm, TRUE);
+    for (i = 0; i < bm->numPages && !pinned; i++)
+        pinned = pool->frameFile[i] == bm->fileId && pool->framePage[i] != NO_PAGE && FIX_COUNT(pool, i) > 0;
+    latchShards(bm, FALSE);
+    if (pinned)
+        return RC_SHUTDOWN_POOL_FAILED;
+
+    for (s = 0; s < pool->numShards; s++) {
+        shard = getShard(bm, s);
+        poolMgmt = shard->poolMgmt;
+        RC_flag = flushShard(shard, bm->fileId);
+        if (RC_flag != RC_OK)
+            return RC_flag;
+        // the file id is given to the next file attached
+        pthread_mutex_lock(&poolMgmt->latch);
+        for (i = 0; i < shard->numPages; i++) {
+            if (poolMgmt->frameFile[i] == bm->fileId && poolMgmt->framePage[i] != NO_PAGE)
+                releaseFrame(shard, i);
         }
+        pthread_mutex_unlock(&poolMgmt->latch);
     }
-    return RC_OK;
+
+    pthread_mutex_lock(&pool->fileLock);
+    pool->files[bm->fileId] = NULL;
+    pool->views[bm->fileId] = NULL;
+    pthread_mutex_unlock(&pool->fileLock);
+    RC_flag = closePageFile(bm->fh);
+    free(bm->fh);
+    bm->fh = NULL;
+    bm->fileId = 0;
+    bm->poolMgmt = NULL;
+    return RC_flag;
 }
 
 /***************************************************************
- * Function Name: unpinPage
+ * Function Name: resizeBufferPool
  *
- * Description:unpin a page indicate by "page"
+ * Description: change the number of frames of the pool bm belongs to, bm or the pool a file attached as bm shares, to numPages without dropping the cache. Growing adds empty frames at once. Shrinking first evicts the pages the replacement strategy would give up next, writing dirty ones back, until every shard has frames for the pages it keeps. The cached pages keep their place in the page table and the replacement order, and the LRU-K and ARC histories are kept as far as they fit. A pinned page stays in its frame, since its handle points into it and into the frame's stamp; unpinned pages whose frame goes away are copied into a free frame of their shard. Fails with RC_RESIZE_POOL_FAILED, changing nothing, if a pinned frame would leave its shard, if pages are pinned and numPages is more than the stamps have room for, if a scan ring owns frames or if numPages is smaller than the number of shards. No other call on the pool may run at the same time; a running background writer is restarted.
  *
- * Parameters:BM_BufferPool *const bm, BM_PageHandle *const page
+ * Parameters: BM_BufferPool *const bm, const int numPages
  *
- * Return:RC
+ * Return: RC
  *
- * Author:Zhipeng Liu
+ * Author: agent
  *
  * History:
  *      Date            Name                        Content
- *      02/25/16        Zhipeng Liu                 complete
+ *      26/10/17        agent                       Complete.
+ *
 ***************************************************************/
 
-RC unpinPage (BM_BufferPool *const bm, BM_PageHandle *const page)
-{
+RC resizeBufferPool(BM_BufferPool *const bm, const int numPages) {
+    BM_BufferPool *pool = bm->poolMgmt->pool;
+    BM_PoolMgmt *poolMgmt = pool->poolMgmt;
+    int numShards = poolMgmt->numShards;
+    BM_WriterParams writerParams;
+    bool writerRunning, pinned;
     int i;
-    for (i = 0; i < bm->numPages; i++)
-    {
-        if ((bm->mgmtData + i)->pageNum == page->pageNum)
-        {
-            (bm->mgmtData + i)->fixCounts--;
-//          page->fixCounts--;
-            break;
-        }
+    RC RC_flag, result;
+
+    if (numPages < numShards)
+        return RC_RESIZE_POOL_FAILED;
+    if (numPages == pool->numPages)
+        return RC_OK;
+    // prefetch reads hold their frames until they are published
+    finishPrefetches(pool);
+    RC_flag = checkResize(pool, numPages, &pinned);
+    if (RC_flag != RC_OK)
+        return RC_flag;
+    // the stamps would move, and with them the strategyAttribute of the pinned handles
+    if (pinned && numPages > poolMgmt->stampsCapacity)
+        return RC_RESIZE_POOL_FAILED;
+
+    writerRunning = __atomic_load_n(&poolMgmt->writerRunning, __ATOMIC_ACQUIRE);
+    writerParams = poolMgmt->writerParams;
+    stopBackgroundWriter(pool);
+    RC_flag = growFrameSlab(pool, numPages, pinned);
+    for (i = 0; i < numShards && RC_flag == RC_OK; i++)
+        RC_flag = evictFrames(getShard(pool, i),
+                              SHARD_FIRST(numPages, numShards, i + 1) - SHARD_FIRST(numPages, numShards, i));
+    // report the writes of the evicted pages
+    for (i = 0; i < numShards; i++) {
+        result = finishWriteback(getShard(pool, i));
+        if (RC_flag == RC_OK)
+            RC_flag = result;
     }
-    return RC_OK;
+    if (RC_flag == RC_OK)
+        relayoutPool(pool, numPages);
+    if (writerRunning)
+        startBackgroundWriter(pool, &writerParams);
+    return RC_flag;
 }
 
 /***************************************************************
- * Function Name: forcePage
+ * Function Name: checkResize
  *
- * Description:write the current content of the page back to the page file on disk
+ * Description: check under the shard latches that pool can be resized to numPages frames: no scan ring owns a frame and every pinned frame belongs to the same shard afterwards, so its page can stay where it is. *pinned tells whether any page is pinned.
  *
- * Parameters:BM_BufferPool *const bm, BM_PageHandle *const page
+ * Parameters: BM_BufferPool *const pool, int numPages, bool *pinned
  *
- * Return:RC
+ * Return: RC
  *
- * Author:Zhipeng Liu
+ * Author: agent
  *
  * History:
  *      Date            Name                        Content
- *  02/16/2016  Zhipeng Liu        finish the function
+ *      26/10/17        agent                       Complete.
+ *
 ***************************************************************/
 
-RC forcePage (BM_BufferPool *const bm, BM_PageHandle *const page)
-{
-    FILE *fp;
-    int i;
-
+static RC checkResize(BM_BufferPool *const pool, int numPages, bool *pinned) {
+    int numShards = pool->poolMgmt->numShards;
+    BM_BufferPool *shard;
+    BM_PoolMgmt *poolMgmt;
+    int s, i, frame, newFirst, newEnd;
+    RC RC_flag = RC_OK;
 
-
-    fp = fopen(bm->pageFile, "rb+");
-    fseek(fp, (page->pageNum)*PAGE_SIZE, SEEK_SET);
-    fwrite(page->data, PAGE_SIZE, 1, fp);
-    (bm->numWriteIO)++;
-    fclose(fp);
-//      free(page->data);
-    for (i = 0; i < bm->numPages; i++)
-    {
-        if ((bm->mgmtData + i)->pageNum == page->pageNum)
-        {
-            (bm->mgmtData + i)->dirty = 0;
-//          (bm->mgmtData+i)->pageNum=-1;
-            break;
+    *pinned = FALSE;
+    latchShards(pool, TRUE);
+    for (s = 0; s < numShards && RC_flag == RC_OK; s++) {
+        shard = getShard(pool, s);
+        poolMgmt = shard->poolMgmt;
+        newFirst = SHARD_FIRST(numPages, numShards, s);
+        newEnd = SHARD_FIRST(numPages, numShards, s + 1);
+        for (i = 0; i < shard->numPages; i++) {
+            if (poolMgmt->ringOf[i] != NULL) {
+                RC_flag = RC_RESIZE_POOL_FAILED;
+                break;
+            }
+            if (poolMgmt->framePage[i] == NO_PAGE || FIX_COUNT(poolMgmt, i) == 0)
+                continue;
+            *pinned = TRUE;
+            frame = SHARD_FIRST(pool->numPages, numShards, s) + i;
+            if (frame < newFirst || frame >= newEnd) {
+                RC_flag = RC_RESIZE_POOL_FAILED;
+                break;
+            }
         }
     }
-    page->dirty = 0;
-//page->pageNum=-1;
-    return RC_OK;
+    latchShards(pool, FALSE);
+    return RC_flag;
 }
 
 /***************************************************************
- * Function Name: pinPage
+ * Function Name: growFrameSlab
  *
- * Description:pin a page, if the page does not exist in memory, read it from file
+ * Description: make the slab of pool large enough for numPages frames. The mapping is extended in place if the address space behind it is free; otherwise it moves, unless pinned pages must stay where their handles point. The frames of the shards follow a moved slab.
  *
- * Parameters:BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum
+ * Parameters: BM_BufferPool *const pool, int numPages, bool pinned
  *
- * Return:RC
+ * Return: RC
  *
- * Author:Zhipeng Liu
+ * Author: agent
  *
  * History:
  *      Date            Name                        Content
- *02/25/16       Zhipng Liu             imcomplete, need to implement the replace page part
+ *      26/10/17        agent                       Complete.
+ *
 ***************************************************************/
 
-RC pinPage (BM_BufferPool *const bm, BM_PageHandle *const page,
-            const PageNumber pageNum)
-{
-    int pnum;
-    int flag = 0;
+static RC growFrameSlab(BM_BufferPool *const pool, int numPages, bool pinned) {
+    BM_PoolMgmt *poolMgmt = pool->poolMgmt;
+    size_t size = (size_t)numPages * poolMgmt->pageSize;
+    char *slab;
     int i;
 
-    for (i = 0; i < bm->numPages; i++)
-    {
-        if ((bm->mgmtData + i)->pageNum == -1)
-        {
-            (bm->mgmtData + i)->data = (char*)calloc(PAGE_SIZE, sizeof(char));
-            pnum = i;
-            flag = 1;
-            break;
-        }
-        if ((bm->mgmtData + i)->pageNum == pageNum)
-        {
-            pnum = i;
-            flag = 2;
-            if (bm->strategy == RS_LRU)
-                updataAttribute(bm, bm->mgmtData + pnum);
-            break;
-        }
-        if (i == bm->numPages - 1)
-        {
+    if (size <= poolMgmt->slabSize)
+        return RC_OK;
+    // a slab of reserved huge pages grows by whole huge pages
+    if (poolMgmt->slabSize % BM_HUGE_PAGE_SIZE == 0)
+        size = (size + BM_HUGE_PAGE_SIZE - 1) / BM_HUGE_PAGE_SIZE * BM_HUGE_PAGE_SIZE;
+    slab = mremap(poolMgmt->slab, poolMgmt->slabSize, size, 0);
+    if (slab == MAP_FAILED && !pinned)
+        slab = mremap(poolMgmt->slab, poolMgmt->slabSize, size, MREMAP_MAYMOVE);
+    if (slab == MAP_FAILED)
+        return pinned ? RC_RESIZE_POOL_FAILED : RC_NO_FREE_FRAME;
+#ifdef MADV_HUGEPAGE
+    if (hugePages != BM_HUGE_PAGES_OFF && size >= BM_HUGE_PAGE_SIZE)
+        madvise(slab, size, MADV_HUGEPAGE);
+#endif
 
-            flag = 1;;
-            if (bm->strategy == RS_FIFO)
-            {
-                pnum = strategyFIFOandLRU(bm);
-                if ((bm->mgmtData + pnum)->dirty)
-                    forcePage (bm, bm->mgmtData + pnum);
-            }
-            if (bm->strategy == RS_LRU)
-            {
-                pnum = strategyFIFOandLRU(bm);
-                if ((bm->mgmtData + pnum)->dirty)
-                    forcePage (bm, bm->mgmtData + pnum);
-            }
-        }
-    }
-    if (flag == 1)
-    {
-        FILE* fp;
-        fp = fopen(bm->pageFile, "r");
-        fseek(fp, pageNum * PAGE_SIZE, SEEK_SET);
-        fread((bm->mgmtData + pnum)->data, sizeof(char), PAGE_SIZE, fp);
-        page->data = (bm->mgmtData + pnum)->data;
-        bm->numReadIO++;
-        ((bm->mgmtData + pnum)->fixCounts)++;
-        (bm->mgmtData + pnum)->pageNum = pageNum;
-        page->fixCounts = (bm->mgmtData + pnum)->fixCounts;
-        page->pageNum = pageNum;
-        page->dirty = (bm->mgmtData + pnum)->dirty;
-        page->strategyAttribute = (bm->mgmtData + pnum)->strategyAttribute;
-        updataAttribute(bm, bm->mgmtData + pnum);
-        fclose(fp);
-    }
-    if (flag == 2)
-    {
-        page->data = (bm->mgmtData + pnum)->data;
-        ((bm->mgmtData + pnum)->fixCounts)++;
-        page->fixCounts = (bm->mgmtData + pnum)->fixCounts;
-        page->pageNum = pageNum;
-        page->dirty = (bm->mgmtData + pnum)->dirty;
-        page->strategyAttribute = (bm->mgmtData + pnum)->strategyAttribute;
-        //if(bm->strategy==RS_LRU)
-        //  updataAttribute(bm, bm->mgmtData+pnum);
-    }
+    poolMgmt->slab = poolMgmt->frameData = slab;
+    poolMgmt->slabSize = size;
+    for (i = 0; poolMgmt->shards != NULL && i < poolMgmt->numShards; i++)
+        poolMgmt->shards[i].poolMgmt->frameData =
+            slab + (size_t)SHARD_FIRST(pool->numPages, poolMgmt->numShards, i) * poolMgmt->pageSize;
     return RC_OK;
 }
 
-// Statistics Interface
-
 /***************************************************************
- * Function Name: getFrameContents
+ * Function Name: evictFrames
  *
- * Description: Returns an array of PageNumbers where the ith element is the number of the page stored in the ith page frame
+ * Description: evict pages of shard with evictFrame until at most numFrames frames hold a page. Dirty victims are written back through the shard's writeback slot.
  *
- * Parameters: BM_BufferPool *const bm
+ * Parameters: BM_BufferPool *const shard, int numFrames
  *
- * Return: PageNumber *
+ * Return: RC
  *
- * Author: Xincheng Yang
+ * Author: agent
  *
  * History:
  *      Date            Name                        Content
- *   2016/2/27      Xincheng Yang             first time to implement the function
+ *      26/10/17        agent                       Complete.
  *
 ***************************************************************/
-PageNumber *getFrameContents (BM_BufferPool *const bm) {
-    PageNumber *arr = (PageNumber*)malloc(bm->numPages * sizeof(PageNumber));
-    BM_PageHandle *handle = bm->mgmtData;
 
-    int i;
-    for (i = 0; i < bm->numPages; i++) {
-        if ((handle + i)->data == NULL) {
-            arr[i] = NO_PAGE;
-        } else {
-            arr[i] = (handle + i)->pageNum;
+static RC evictFrames(BM_BufferPool *const shard, int numFrames) {
+    BM_PoolMgmt *poolMgmt = shard->poolMgmt;
+    int pnum;
+    RC RC_flag = RC_OK;
+
+    pthread_mutex_lock(&poolMgmt->latch);
+    while (shard->numPages - poolMgmt->numFreeFrames > numFrames) {
+        RC_flag = evictFrame(shard, &pnum);
+        if (RC_flag == RC_WRITEBACK_BUSY) {
+            pthread_mutex_unlock(&poolMgmt->latch);
+            RC_flag = finishWriteback(shard);
+            pthread_mutex_lock(&poolMgmt->latch);
+            if (RC_flag != RC_OK)
+                break;
+            continue;
         }
+        if (RC_flag != RC_OK)
+            break;
+        poolMgmt->freeFrames[poolMgmt->numFreeFrames++] = pnum;
     }
-    return arr;
+    pthread_mutex_unlock(&poolMgmt->latch);
+    submitWriteback(shard);
+    return RC_flag;
 }
 
 /***************************************************************
- * Function Name: getDirtyFlags
+ * Function Name: relayoutPool
  *
- * Description: Returns an array of bools where the ith element is TRUE if the page stored in the ith page frame is dirty
+ * Description: split numPages frames between the shards of pool once every shard holds no more pages than it gets frames. A page keeps its frame if the frame still belongs to its shard, otherwise it is copied into a free frame of the shard; then the frame arrays and the state of every shard are rebuilt for the new size with adoptFrames. Memory of the frames given up goes back to the system.
  *
- * Parameters: BM_BufferPool *const bm
+ * Parameters: BM_BufferPool *const pool, int numPages
  *
- * Return: bool *
+ * Return: void
  *
- * Author: Xincheng Yang
+ * Author: agent
  *
  * History:
  *      Date            Name                        Content
- *   2016/2/27      Xincheng Yang             first time to implement the function
+ *      26/10/17        agent                       Complete.
  *
 ***************************************************************/
-bool *getDirtyFlags (BM_BufferPool *const bm) {
-    bool *arr = (bool*)malloc(bm->numPages * sizeof(bool));
-    BM_PageHandle *handle = bm->mgmtData;
 
-    int i;
+static void relayoutPool(BM_BufferPool *const pool, int numPages) {
+    BM_PoolMgmt *poolMgmt = pool->poolMgmt;
+    int numShards = poolMgmt->numShards;
+    int oldPages = pool->numPages;
+    PageNumber *framePage = poolMgmt->framePage;
+    int *frameFile = poolMgmt->frameFile;
+    int *fixCounts = poolMgmt->fixCounts;
+    bool *dirty = poolMgmt->dirty;
+    long long *stamps;
+    long long *accessCounts = poolMgmt->accessCounts;
+    BM_PoolMgmt *old;
+    BM_BufferPool *shard;
+    int *newIndex, *oldFrames;
+    char *taken, *moved;
+    size_t unit, keep;
+    int s, i, k, frame, first, newFirst, newFrames, numMoved;
 
-    for (i = 0; i < bm->numPages; i++) {
-        arr[i] = (handle + i)->dirty;
+    latchShards(pool, TRUE);
+    // new frame of every page: its own while it stays in the shard, else a free one
+    newIndex = (int *)malloc(oldPages * sizeof(int));
+    oldFrames = (int *)malloc(numShards * sizeof(int));
+    numMoved = 0;
+    for (s = 0; s < numShards; s++) {
+        first = SHARD_FIRST(oldPages, numShards, s);
+        newFirst = SHARD_FIRST(numPages, numShards, s);
+        newFrames = SHARD_FIRST(numPages, numShards, s + 1) - newFirst;
+        oldFrames[s] = getShard(pool, s)->numPages;
+        taken = (char *)calloc(newFrames, sizeof(char));
+        for (i = first; i < first + oldFrames[s]; i++) {
+            newIndex[i] = -1;
+            if (framePage[i] != NO_PAGE && i >= newFirst && i < newFirst + newFrames) {
+                newIndex[i] = i;
+                taken[i - newFirst] = 1;
+            }
+        }
+        k = 0;
+        for (i = first; i < first + oldFrames[s]; i++) {
+            if (framePage[i] == NO_PAGE || newIndex[i] != -1)
+                continue;
+            while (taken[k])
+                k++;
+            taken[k] = 1;
+            newIndex[i] = newFirst + k;
+            numMoved++;
+        }
+        free(taken);
     }
-    return arr;
+
+    // the frames moved to may hold pages still to be moved, so copy through a buffer
+    moved = (char *)malloc(((size_t)numMoved + 1) * poolMgmt->pageSize);
+    for (i = 0, k = 0; i < oldPages; i++) {
+        if (newIndex[i] != -1 && newIndex[i] != i)
+            memcpy(moved + (size_t)(k++) * poolMgmt->pageSize, FRAME_DATA(poolMgmt, i), poolMgmt->pageSize);
+    }
+    for (i = 0, k = 0; i < oldPages; i++) {
+        if (newIndex[i] != -1 && newIndex[i] != i)
+            memcpy(FRAME_DATA(poolMgmt, newIndex[i]), moved + (size_t)(k++) * poolMgmt->pageSize, poolMgmt->pageSize);
+    }
+    free(moved);
+    if (numPages < oldPages) {
+        unit = poolMgmt->slabSize >= BM_HUGE_PAGE_SIZE ? BM_HUGE_PAGE_SIZE : (size_t)sysconf(_SC_PAGESIZE);
+        keep = ((size_t)numPages * poolMgmt->pageSize + unit - 1) / unit * unit;
+        if (keep < poolMgmt->slabSize)
+            madvise(poolMgmt->slab + keep, poolMgmt->slabSize - keep, MADV_DONTNEED);
+    }
+
+    // rebuild every shard for its new frames from a copy of its old state;
+    // the stamps are rebuilt in place, pinned handles point into them
+    stamps = (long long *)malloc(oldPages * sizeof(long long));
+    memcpy(stamps, poolMgmt->stamps, oldPages * sizeof(long long));
+    old = (BM_PoolMgmt *)malloc(numShards * sizeof(BM_PoolMgmt));
+    for (s = 0; s < numShards; s++) {
+        old[s] = *getShard(pool, s)->poolMgmt;
+        old[s].stamps = stamps + SHARD_FIRST(oldPages, numShards, s);
+    }
+    poolMgmt->framePage = (PageNumber *)malloc(numPages * sizeof(PageNumber));
+    for (i = 0; i < numPages; i++)
+        poolMgmt->framePage[i] = NO_PAGE;
+    poolMgmt->frameFile = (int *)calloc(numPages, sizeof(int));
+    poolMgmt->fixCounts = (int *)calloc(numPages, sizeof(int));
+    poolMgmt->dirty = (bool *)calloc(numPages, sizeof(bool));
+    if (numPages > poolMgmt->stampsCapacity) {
+        // no page is pinned, resizeBufferPool checked
+        free(poolMgmt->stamps);
+        poolMgmt->stampsCapacity = 2 * numPages;
+        poolMgmt->stamps = (long long *)malloc(poolMgmt->stampsCapacity * sizeof(long long));
+    }
+    memset(poolMgmt->stamps, 0, numPages * sizeof(long long));
+    poolMgmt->accessCounts = (long long *)calloc(numPages, sizeof(long long));
+    for (s = 0; s < numShards; s++) {
+        shard = getShard(pool, s);
+        first = SHARD_FIRST(oldPages, numShards, s);
+        newFirst = SHARD_FIRST(numPages, numShards, s);
+        newFrames = SHARD_FIRST(numPages, numShards, s + 1) - newFirst;
+        for (i = first; i < first + oldFrames[s]; i++) {
+            if (newIndex[i] != -1)
+                newIndex[i] -= newFirst;
+        }
+        if (shard->strategy == RS_LRU_K)
+            shard->poolMgmt->historySize = (int)((long long)old[s].historySize * newFrames / oldFrames[s]);
+        initShardFrames(shard, pool, newFirst, newFrames);
+        adoptFrames(shard, old + s, oldFrames[s], newIndex + first);
+        freeShardFrames(old + s);
+    }
+    for (frame = 0; frame < BM_MAX_FILES; frame++) {
+        if (poolMgmt->views[frame] != NULL)
+            poolMgmt->views[frame]->numPages = numPages;
+    }
+    latchShards(pool, FALSE);
+
+    free(framePage);
+    free(frameFile);
+    free(fixCounts);
+    free(dirty);
+    free(stamps);
+    free(accessCounts);
+    free(old);
+    free(oldFrames);
+    free(newIndex);
 }
 
 /***************************************************************
- * Function Name: getFixCounts
+ * Function Name: adoptFrames
  *
- * Description: Returns an array of ints where the ith element is the fix count of the page stored in the ith page frame
+ * Description: fill shard, just set up by initShardFrames for its new frames, with the pages of its old state old, which had oldFrames frames: old frame i moves to frame newIndex[i], -1 for an empty one. Frames go back on the replacement lists in their old order, LFU counts, LRU-K references and history and the ARC lists come along; of the ARC ghosts the most recent that still fit are kept. The caller holds the shard latch.
  *
- * Parameters: BM_BufferPool *const bm
+ * Parameters: BM_BufferPool *const shard, BM_PoolMgmt *old, int oldFrames, const int *newIndex
  *
- * Return: int *
+ * Return: void
  *
- * Author: Xincheng Yang
+ * Author: agent
  *
  * History:
  *      Date            Name                        Content
- *   2016/2/27      Xincheng Yang             first time to implement the function
+ *      26/10/17        agent                       Complete.
  *
 ***************************************************************/
-int *getFixCounts (BM_BufferPool *const bm) {
-    int *arr = (int*)malloc(bm->numPages * sizeof(int));
-    BM_PageHandle *handle = bm->mgmtData;
 
-    int i;
-    for (i = 0; i < bm->numPages; i++) {
-        arr[i] = (handle + i)->fixCounts;
+static void adoptFrames(BM_BufferPool *const shard, BM_PoolMgmt *old, int oldFrames, const int *newIndex) {
+    BM_PoolMgmt *poolMgmt = shard->poolMgmt;
+    ReplacementStrategy strategy = shard->strategy;
+    int c = shard->numPages;
+    int k = poolMgmt->k;
+    int i, n, bucket, prev, skip, keepB1, keepB2;
+    char list;
+    uint32_t slot;
+
+    poolMgmt->numDirty = 0;
+    for (i = 0; i < oldFrames; i++) {
+        if ((n = newIndex[i]) == -1)
+            continue;
+        poolMgmt->framePage[n] = old->framePage[i];
+        poolMgmt->frameFile[n] = old->frameFile[i];
+        poolMgmt->fixCounts[n] = old->fixCounts[i];
+        poolMgmt->dirty[n] = old->dirty[i];
+        poolMgmt->stamps[n] = old->stamps[i];
+        poolMgmt->accessCounts[n] = old->accessCounts[i];
+        poolMgmt->refBits[n] = old->refBits[i];
+        if (old->dirty[i])
+            poolMgmt->numDirty++;
+        pageTableInsert(shard, n);
+        if (strategy == RS_LRU_K) {
+            memcpy(poolMgmt->refTimes + (size_t)n * k, old->refTimes + (size_t)i * k, k * sizeof(long long));
+            poolMgmt->numRefs[n] = old->numRefs[i];
+        }
+    }
+    // frames are handed out from frame 0 upwards
+    poolMgmt->numFreeFrames = 0;
+    for (n = c - 1; n >= 0; n--) {
+        if (poolMgmt->framePage[n] == NO_PAGE)
+            poolMgmt->freeFrames[poolMgmt->numFreeFrames++] = n;
+    }
+    if (old->clockHand < oldFrames && newIndex[old->clockHand] != -1)
+        poolMgmt->clockHand = newIndex[old->clockHand];
+
+    if (strategy == RS_FIFO || strategy == RS_LRU || strategy == RS_LRU_K) {
+        for (i = old->listHead; i != -1; i = old->listNext[i])
+            listAppend(poolMgmt, &poolMgmt->listHead, &poolMgmt->listTail, newIndex[i]);
+    }
+    if (strategy == RS_LFU) {
+        prev = -1;
+        for (bucket = old->bucketHead; bucket != -1; bucket = old->bucketNext[bucket]) {
+            prev = lfuNewBucket(poolMgmt, old->bucketCount[bucket], prev);
+            for (i = old->bucketFirst[bucket]; i != -1; i = old->listNext[i]) {
+                listAppend(poolMgmt, &poolMgmt->bucketFirst[prev], &poolMgmt->bucketLast[prev], newIndex[i]);
+                poolMgmt->bucketOf[newIndex[i]] = prev;
+            }
+        }
+    }
+    if (strategy == RS_LRU_K) {
+        for (i = 0; i < old->heapSize; i++)
+            heapInsert(poolMgmt, newIndex[old->heap[i]]);
+        for (i = 0; i < old->historySize && poolMgmt->historySize > 0; i++) {
+            if (old->historyPage[i] == NO_PAGE)
+                continue;
+            n = historySlot(poolMgmt, old->historyFile[i], old->historyPage[i]);
+            poolMgmt->historyPage[n] = old->historyPage[i];
+            poolMgmt->historyFile[n] = old->historyFile[i];
+            poolMgmt->historyRefs[n] = old->historyRefs[i];
+            memcpy(poolMgmt->historyTimes + (size_t)n * k, old->historyTimes + (size_t)i * k, k * sizeof(long long));
+        }
+    }
+    if (strategy == RS_ARC) {
+        for (i = old->listHead; i != -1; i = old->listNext[i]) {
+            listAppend(poolMgmt, &poolMgmt->listHead, &poolMgmt->listTail, newIndex[i]);
+            poolMgmt->arcList[newIndex[i]] = ARC_T1;
+            poolMgmt->t1Size++;
+        }
+        for (i = old->t2Head; i != -1; i = old->listNext[i]) {
+            listAppend(poolMgmt, &poolMgmt->t2Head, &poolMgmt->t2Tail, newIndex[i]);
+            poolMgmt->arcList[newIndex[i]] = ARC_T2;
+            poolMgmt->t2Size++;
+        }
+        poolMgmt->arcTarget = (int)((long long)old->arcTarget * c / oldFrames);
+        // |T1| + |B1| <= c, all four lists <= 2 * c and at most c ghosts
+        keepB1 = c - poolMgmt->t1Size < old->b1Size ? c - poolMgmt->t1Size : old->b1Size;
+        keepB2 = 2 * c - poolMgmt->t1Size - poolMgmt->t2Size - keepB1;
+        if (keepB2 > c - keepB1)
+            keepB2 = c - keepB1;
+        if (keepB2 > old->b2Size)
+            keepB2 = old->b2Size;
+        for (list = ARC_B1; list <= ARC_B2; list++) {
+            skip = list == ARC_B1 ? old->b1Size - keepB1 : old->b2Size - keepB2;
+            for (i = list == ARC_B1 ? old->b1Head : old->b2Head; i != -1; i = old->listNext[i]) {
+                if (skip-- > 0)
+                    continue;
+                n = poolMgmt->freeGhosts[--poolMgmt->numFreeGhosts];
+                poolMgmt->ghostPage[n - c] = old->ghostPage[i - oldFrames];
+                poolMgmt->ghostFile[n - c] = old->ghostFile[i - oldFrames];
+                slot = pageSlot(poolMgmt, poolMgmt->ghostFile[n - c], poolMgmt->ghostPage[n - c]);
+                while (poolMgmt->ghostTable[slot] != -1)
+                    slot = (slot + 1) & poolMgmt->pageTableMask;
+                poolMgmt->ghostTable[slot] = n;
+                poolMgmt->arcList[n] = list;
+                if (list == ARC_B1) {
+                    listAppend(poolMgmt, &poolMgmt->b1Head, &poolMgmt->b1Tail, n);
+                    poolMgmt->b1Size++;
+                } else {
+                    listAppend(poolMgmt, &poolMgmt->b2Head, &poolMgmt->b2Tail, n);
+                    poolMgmt->b2Size++;
+                }
+            }
+        }
     }
-    return arr;
 }
 
 /***************************************************************
- * Function Name: getNumReadIO
+ * Function Name: freeShard
  *
- * Description: Returns an array of ints where the ith element is the fix count of the page stored in the ith page frame
+ * Description: free what initShard allocated for shard, but not shard->poolMgmt itself.
  *
- * Parameters: BM_BufferPool *const bm
+ * Parameters: BM_BufferPool *const shard
  *
- * Return: int
+ * Return: void
  *
- * Author: Xincheng Yang
+ * Author: agent
  *
  * History:
  *      Date            Name                        Content
- *   2016/2/27      Xincheng Yang             first time to implement the function
+ *      26/10/17        agent                       Complete.
  *
 ***************************************************************/
-int getNumReadIO (BM_BufferPool *const bm) {
-    return bm->numReadIO;
+
+static void freeShard(BM_BufferPool *const shard) {
+    BM_PoolMgmt *poolMgmt = shard->poolMgmt;
+
+    freePageBuffer(poolMgmt->writebackData);
+    free(poolMgmt->fileStats);
+    freeShardFrames(poolMgmt);
+    pthread_mutex_destroy(&poolMgmt->latch);
+    pthread_cond_destroy(&poolMgmt->loaded);
 }
 
 /***************************************************************
- * Function Name: getNumWriteIO
+ * Function Name: freeShardFrames
  *
- * Description: Returns an array of ints where the ith element is the fix count of the page stored in the ith page frame
+ * Description: free what initShardFrames allocated in poolMgmt.
  *
- * Parameters: BM_BufferPool *const bm
+ * Parameters: BM_PoolMgmt *poolMgmt
  *
- * Return: int
+ * Return: void
  *
- * Author: Xincheng Yang
+ * Author: agent
  *
  * History:
  *      Date            Name                        Content
- *   2016/2/27      Xincheng Yang             first time to implement the function
+ *      26/10/17        agent                       Complete.
  *
 ***************************************************************/
-int getNumWriteIO (BM_BufferPool *const bm) {
-    return bm->numWriteIO;
+
+static void freeShardFrames(BM_PoolMgmt *poolMgmt) {
+    free(poolMgmt->loading);
+    free(poolMgmt->pageTable);
+    free(poolMgmt->freeFrames);
+    free(poolMgmt->listPrev);
+    free(poolMgmt->listNext);
+    free(poolMgmt->refBits);
+    free(poolMgmt->bucketOf);
+    free(poolMgmt->bucketCount);
+    free(poolMgmt->bucketFirst);
+    free(poolMgmt->bucketLast);
+    free(poolMgmt->bucketPrev);
+    free(poolMgmt->bucketNext);
+    free(poolMgmt->freeBuckets);
+    free(poolMgmt->refTimes);
+    free(poolMgmt->numRefs);
+    free(poolMgmt->heap);
+    free(poolMgmt->heapPos);
+    free(poolMgmt->heapSpill);
+    free(poolMgmt->historyPage);
+    free(poolMgmt->historyFile);
+    free(poolMgmt->historyTimes);
+    free(poolMgmt->historyRefs);
+    free(poolMgmt->arcList);
+    free(poolMgmt->ghostPage);
+    free(poolMgmt->ghostFile);
+    free(poolMgmt->ghostTable);
+    free(poolMgmt->freeGhosts);
+    free(poolMgmt->ringOf);
 }
 
 /***************************************************************
- * Function Name: strategyFIFOandLRU
+ * Function Name: forceFlushPool
  *
- * Description: decide use which frame to save data using FIFO.
+ * Description: forceFlushPool causes all dirty pages (with fix count 0) from the buffer pool to be written to disk. The dirty frames are sorted by page number and each run of consecutive pages is written with one vectored writeBlocks call.
  *
- * Parameters: BM_BufferPool *bm
+ * Parameters: BM_BufferPool *const bm
  *
- * Return: int
+ * Return: RC
  *
  * Author: Xiaoliang Wu
  *
  * History:
  *      Date            Name                        Content
- *      16/02/27        Xiaoliang Wu                Complete
+ *      16/02/25        Xiaoliang Wu                Complete, forcepage need set dirty to 0.
+ *      16/02/27        Xincheng Yang               free fixCounts and dirtyFlags.
+ *      26/10/16        agent                       Finish the pending writeback, flush every shard with flushShard.
  *
 ***************************************************************/
 
-int strategyFIFOandLRU(BM_BufferPool *bm) {
-    int * attributes;
-    int * fixCounts;
+RC forceFlushPool(BM_BufferPool *const bm) {
+    RC RC_flag, result = RC_OK;
     int i;
-    int min, abortPage;
 
-    attributes = (int *)getAttributionArray(bm);
-    fixCounts = getFixCounts(bm);
+    for (i = 0; i < bm->poolMgmt->numShards; i++) {
+        RC_flag = flushShard(getShard(bm, i), -1);
+        if (result == RC_OK)
+            result = RC_flag;
+    }
+    return result;
+}
+
+/***************************************************************
+ * Function Name: flushShard
+ *
+ * Description: write the dirty unpinned pages of one shard like forceFlushPool, only those of file fileId unless it is -1. The frames are pinned and marked clean under the shard latch, written without it, and unpinned again; a page dirtied during the write stays dirty.
+ *
+ * Parameters: BM_BufferPool *const shard, int fileId
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
 
-    min = bm->timer;
-    abortPage = -1;
+static RC flushShard(BM_BufferPool *const shard, int fileId) {
+    BM_PoolMgmt *poolMgmt = shard->poolMgmt;
+    int *dirty;
+    int i, numDirty;
+    RC RC_flag;
 
-    for (i = 0; i < bm->numPages; ++i) {
-        if (*(fixCounts + i) != 0) continue;
+    RC_flag = finishWriteback(shard);
+    if (RC_flag != RC_OK)
+        return RC_flag;
 
-        if (min >= (*(attributes + i))) {
-            abortPage = i;
-            min = (*(attributes + i));
+    dirty = (int *)malloc(shard->numPages * sizeof(int));
+    numDirty = 0;
+    pthread_mutex_lock(&poolMgmt->latch);
+    for (i = 0; i < shard->numPages; ++i) {
+        if (poolMgmt->dirty[i] && FIX_COUNT(poolMgmt, i) == 0 && poolMgmt->framePage[i] != NO_PAGE
+            && (fileId == -1 || poolMgmt->frameFile[i] == fileId)) {
+            poolMgmt->fixCounts[i] = 1;
+            setFrameDirty(shard, i, FALSE);
+            dirty[numDirty++] = i;
         }
     }
+    pthread_mutex_unlock(&poolMgmt->latch);
 
-    if ((bm->timer) > 32000) {
-        (bm->timer) -= min;
-        for (i = 0; i < bm->numPages; ++i) {
-            *(bm->mgmtData->strategyAttribute) -= min;
-        }
-    }
-    return abortPage;
+    RC_flag = writeFrames(shard, dirty, numDirty, &poolMgmt->numFlushPages, &poolMgmt->numFlushRuns, TRUE);
+    free(dirty);
+    return RC_flag;
 }
 
 /***************************************************************
- * Function Name: getAttributionArray
+ * Function Name: writeFrames
  *
- * Description: return an array that includes all pages strategyAttribute.
+ * Description: write numDirty frames of shard that the caller pinned and marked clean under the shard latch. The frames are sorted by file and page number and each run of consecutive pages of a file is written with one writeBlocks call, without the shard latch. Afterwards the frames are unpinned, frames that were not written are dirty again, and the pages and runs written are added to *numPages and *numRuns. Pages written for forced flushes count for their file.
  *
- * Parameters: BM_BufferPool *bm
+ * Parameters: BM_BufferPool *const shard, int *dirty, int numDirty, int *numPages, int *numRuns, bool forced
  *
- * Return: int*
+ * Return: RC
  *
- * Author: Xiaoliang Wu
+ * Author: agent
  *
  * History:
  *      Date            Name                        Content
- *      16/02/27        Xiaoliang Wu                Complete.
+ *      26/10/17        agent                       Complete.
  *
 ***************************************************************/
 
-int *getAttributionArray(BM_BufferPool *bm) {
-    int *attributes;
-    int *flag;
-    int i;
+static RC writeFrames(BM_BufferPool *const shard, int *dirty, int numDirty,
+                      int *numPages, int *numRuns, bool forced) {
+    BM_PoolMgmt *poolMgmt = shard->poolMgmt;
+    SM_PageHandle *run;
+    BM_FrameRef *frames;
+    int i, numWritten, runsWritten, start, runLength;
+    RC RC_flag = RC_OK;
 
-    attributes = (int *)calloc(bm->numPages, sizeof((bm->mgmtData)->strategyAttribute));
-    for (i = 0; i < bm->numPages; ++i) {
-        flag = attributes + i;
-        *flag = *((bm->mgmtData + i)->strategyAttribute);
+    run = (SM_PageHandle *)malloc((numDirty > 0 ? numDirty : 1) * sizeof(SM_PageHandle));
+    frames = (BM_FrameRef *)malloc((numDirty > 0 ? numDirty : 1) * sizeof(BM_FrameRef));
+    // the frames are pinned, their pages stay put without the latch
+    for (i = 0; i < numDirty; i++) {
+        frames[i].fileId = poolMgmt->frameFile[dirty[i]];
+        frames[i].pageNum = poolMgmt->framePage[dirty[i]];
+        frames[i].frameIndex = dirty[i];
     }
-    return attributes;
+    qsort(frames, numDirty, sizeof(BM_FrameRef), comparePageNums);
+
+    // every run of consecutive page numbers of a file is written with one writeBlocks call
+    numWritten = runsWritten = 0;
+    for (start = 0; start < numDirty; start += runLength) {
+        runLength = 0;
+        do {
+            run[runLength] = FRAME_DATA(poolMgmt, frames[start + runLength].frameIndex);
+            runLength++;
+        } while (start + runLength < numDirty
+                 && frames[start + runLength].fileId == frames[start].fileId
+                 && frames[start + runLength].pageNum == frames[start].pageNum + runLength);
+
+        pthread_mutex_lock(poolMgmt->fileLatch);
+        RC_flag = writeBlocks(frames[start].pageNum, runLength, poolMgmt->files[frames[start].fileId], run);
+        pthread_mutex_unlock(poolMgmt->fileLatch);
+        if (RC_flag != RC_OK)
+            break;
+        numWritten += runLength;
+        runsWritten++;
+    }
+
+    pthread_mutex_lock(&poolMgmt->latch);
+    for (i = 0; i < numDirty; i++) {
+        __atomic_sub_fetch(&poolMgmt->fixCounts[frames[i].frameIndex], 1, __ATOMIC_RELEASE);
+        if (i >= numWritten)
+            setFrameDirty(shard, frames[i].frameIndex, TRUE);
+        else if (forced)
+            poolMgmt->fileStats[frames[i].fileId].numForcedFlushes++;
+    }
+    shard->numWriteIO += numWritten;
+    *numRuns += runsWritten;
+    *numPages += numWritten;
+    pthread_mutex_unlock(&poolMgmt->latch);
+
+    free(frames);
+    free(run);
+    return RC_flag;
 }
 
 /***************************************************************
- * Function Name: freePagesBuffer
+ * Function Name: startBackgroundWriter
  *
- * Description: free all pages in pool.
+ * Description: start a thread that keeps the frames next in line for eviction clean, so that pins rarely have to write a dirty victim themselves. Every params->intervalMs, or as soon as a pin writes a dirty victim or a shard has fewer than lowWatermark percent clean frames, it writes the dirty unpinned frames among the cleanAhead percent of each shard the strategy would evict next, at most maxPagesPerRound pages per round. params may be NULL for the defaults. A running writer is restarted with the new settings.
  *
- * Parameters: BM_BufferPool *bm
+ * Parameters: BM_BufferPool *const bm, BM_WriterParams *params
  *
  * Return: RC
  *
- * Author: Xiaoliang Wu
+ * Author: agent
  *
  * History:
  *      Date            Name                        Content
- *      16/02/26        Xiaoliang Wu                Complete.
+ *      26/10/16        agent                       Complete.
  *
 ***************************************************************/
 
-void freePagesBuffer(BM_BufferPool *bm) {
-    int i;
-    for (i = 0; i < bm->numPages; ++i) {
-        free((bm->mgmtData + i)->data);
-        free((bm->mgmtData + i)->strategyAttribute);
-    }
+RC startBackgroundWriter(BM_BufferPool *const bm, BM_WriterParams *params) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    BM_WriterParams *settings = &poolMgmt->writerParams;
+
+    stopBackgroundWriter(bm);
+    if (params != NULL)
+        *settings = *params;
+    else
+        memset(settings, 0, sizeof(BM_WriterParams));
+    if (settings->intervalMs <= 0)
+        settings->intervalMs = BM_WRITER_INTERVAL_MS;
+    if (settings->lowWatermark <= 0)
+        settings->lowWatermark = BM_WRITER_LOW_WATERMARK;
+    if (settings->cleanAhead <= 0)
+        settings->cleanAhead = BM_WRITER_CLEAN_AHEAD;
+    if (settings->maxPagesPerRound <= 0)
+        settings->maxPagesPerRound = BM_WRITER_MAX_PAGES;
+
+    poolMgmt->writerStop = FALSE;
+    poolMgmt->writerKick = FALSE;
+    if (pthread_create(&poolMgmt->writer, NULL, backgroundWriter, bm) != 0)
+        return RC_WRITE_FAILED;
+    __atomic_store_n(&poolMgmt->writerRunning, TRUE, __ATOMIC_RELEASE);
+    return RC_OK;
 }
 
 /***************************************************************
- * Function Name: updataAttribute
+ * Function Name: stopBackgroundWriter
  *
- * Description: modify the attribute about strategy. FIFO only use this function when page initial. LRU use this function when pinPage occurs.
+ * Description: stop the background writer of bm and wait for its current round. Nothing happens if none runs.
  *
- * Parameters: BM_BufferPool *bm, BM_PageHandle *pageHandle
+ * Parameters: BM_BufferPool *const bm
  *
  * Return: RC
  *
- * Author: Xiaoliang Wu
+ * Author: agent
  *
  * History:
  *      Date            Name                        Content
- *      16/02/26        Xiaoliang Wu                FIFO, LRU complete.
+ *      26/10/16        agent                       Complete.
  *
 ***************************************************************/
 
-RC updataAttribute(BM_BufferPool *bm, BM_PageHandle *pageHandle) {
-    // initial page strategy attribute assign buffer
-    if (pageHandle->strategyAttribute == NULL) {
+RC stopBackgroundWriter(BM_BufferPool *const bm) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+
+    if (!__atomic_load_n(&poolMgmt->writerRunning, __ATOMIC_ACQUIRE))
+        return RC_OK;
+    pthread_mutex_lock(&poolMgmt->writerLock);
+    poolMgmt->writerStop = TRUE;
+    pthread_cond_signal(&poolMgmt->writerWake);
+    pthread_mutex_unlock(&poolMgmt->writerLock);
+    pthread_join(poolMgmt->writer, NULL);
+    __atomic_store_n(&poolMgmt->writerRunning, FALSE, __ATOMIC_RELEASE);
+    return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: setBufferPoolHugePages
+ *
+ * Description: choose how the frame slab of pools created from now on is backed. BM_HUGE_PAGES_ADVISE (the default) aligns slabs of at least one huge page to a huge page boundary and asks for transparent huge pages with madvise; BM_HUGE_PAGES_ON maps reserved huge pages with MAP_HUGETLB and falls back to BM_HUGE_PAGES_ADVISE when none are left; BM_HUGE_PAGES_OFF uses ordinary pages. Huge pages save TLB misses when a large pool is accessed at random.
+ *
+ * Parameters: BM_HugePages mode
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+void setBufferPoolHugePages(BM_HugePages mode) {
+    hugePages = mode;
+}
+
+/***************************************************************
+ * Function Name: allocFrameSlab
+ *
+ * Description: map the zero-filled slab that holds all frames of a pool, *size bytes, backed as setBufferPoolHugePages chose. The slab is aligned to the system page size at least, so every frame of pageSize bytes is aligned for SM_MODE_DIRECT. Memory is only committed when a frame is first used. *size is set to the length mapped, which munmap needs. Returns NULL if nothing could be mapped.
+ *
+ * Parameters: size_t *size
+ *
+ * Return: char *
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static char *allocFrameSlab(size_t *size) {
+    char *raw, *slab;
+    size_t head;
+
+#ifdef MAP_HUGETLB
+    if (hugePages == BM_HUGE_PAGES_ON) {
+        head = (*size + BM_HUGE_PAGE_SIZE - 1) / BM_HUGE_PAGE_SIZE * BM_HUGE_PAGE_SIZE;
+        slab = mmap(NULL, head, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (slab != MAP_FAILED) {
+            *size = head;
+            return slab;
+        }
+    }
+#endif
+    if (hugePages == BM_HUGE_PAGES_OFF || *size < BM_HUGE_PAGE_SIZE) {
+        slab = mmap(NULL, *size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return slab != MAP_FAILED ? slab : NULL;
+    }
+
+    // map one huge page more and trim both ends, so the slab starts on a
+    // huge page boundary and the kernel can back it with huge pages
+    raw = mmap(NULL, *size + BM_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+        return NULL;
+    slab = (char *)(((uintptr_t)raw + BM_HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(BM_HUGE_PAGE_SIZE - 1));
+    head = slab - raw;
+    if (head > 0)
+        munmap(raw, head);
+    if (head < BM_HUGE_PAGE_SIZE)
+        munmap(slab + *size, BM_HUGE_PAGE_SIZE - head);
+#ifdef MADV_HUGEPAGE
+    madvise(slab, *size, MADV_HUGEPAGE);
+#endif
+    return slab;
+}
+
+// Buffer Manager Interface Access Pages
+
+/***************************************************************
+ * Function Name: markDirty
+ *
+ * Description:mark a page as dirty
+ *
+ * Parameters: BM_BufferPool *const bm, BM_PageHandle *const page
+ *
+ * Return:RC
+ *
+ * Author:Zhipeng Liu
+ *
+ * History:
+ *      Date            Name                        Content
+ *      02/25/16        Zhipeng Liu                 complete
+ *      10/17/26        agent                       look the page up in its shard under the shard latch, count dirty frames for the background writer
+***************************************************************/
+
+RC markDirty (BM_BufferPool *const bm, BM_PageHandle *const page)
+{
+    BM_BufferPool *shard = shardOf(bm, bm->fileId, page->pageNum);
+    int i;
+
+    pthread_mutex_lock(&shard->poolMgmt->latch);
+    i = findFrame(shard, bm->fileId, page->pageNum);
+    if (i != -1)
+    {
+        page->dirty = 1;
+        setFrameDirty(shard, i, TRUE);
+    }
+    pthread_mutex_unlock(&shard->poolMgmt->latch);
+    return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: unpinPage
+ *
+ * Description:unpin a page indicate by "page"
+ *
+ * Parameters:BM_BufferPool *const bm, BM_PageHandle *const page
+ *
+ * Return:RC
+ *
+ * Author:Zhipeng Liu
+ *
+ * History:
+ *      Date            Name                        Content
+ *      02/25/16        Zhipeng Liu                 complete
+ *      10/17/26        agent                       look the page up in the page table, drop the fix count atomically
+***************************************************************/
+
+RC unpinPage (BM_BufferPool *const bm, BM_PageHandle *const page)
+{
+    BM_BufferPool *shard = shardOf(bm, bm->fileId, page->pageNum);
+    BM_PoolMgmt *poolMgmt = shard->poolMgmt;
+    int i, fixCounts;
 
-        if (bm->strategy == RS_FIFO || bm->strategy == RS_LRU) {
-            pageHandle->strategyAttribute = calloc(1, sizeof(int));
+    // the handle remembers its frame: while it is pinned the frame keeps the
+    // page, so the fix count can be dropped without the latch
+    if (page->strategyAttribute >= poolMgmt->stamps
+        && page->strategyAttribute < poolMgmt->stamps + shard->numPages)
+    {
+        i = (int)(page->strategyAttribute - poolMgmt->stamps);
+        fixCounts = FIX_COUNT(poolMgmt, i);
+        while (fixCounts > 0 && poolMgmt->framePage[i] == page->pageNum && poolMgmt->frameFile[i] == bm->fileId)
+        {
+            if (__atomic_compare_exchange_n(&poolMgmt->fixCounts[i], &fixCounts, fixCounts - 1, TRUE,
+                                            __ATOMIC_RELEASE, __ATOMIC_ACQUIRE))
+                return RC_OK;
         }
+    }
 
+    pthread_mutex_lock(&poolMgmt->latch);
+    i = findFrame(shard, bm->fileId, page->pageNum);
+    if (i != -1 && FIX_COUNT(poolMgmt, i) > 0)
+    {
+        __atomic_sub_fetch(&poolMgmt->fixCounts[i], 1, __ATOMIC_RELEASE);
+//      page->fixCounts--;
     }
+    pthread_mutex_unlock(&poolMgmt->latch);
+    return RC_OK;
+}
 
-    // assign number
-    if (bm->strategy == RS_FIFO || bm->strategy == RS_LRU) {
-        int * attribute;
-        attribute = (int *)pageHandle->strategyAttribute;
-        *attribute = (bm->timer);
-        (bm->timer)++;
+/***************************************************************
+ * Function Name: forcePage
+ *
+ * Description:write the current content of the page back to the page file on disk. A page that is no longer cached was written back when it left the pool and is not written again. The page is written from the frame that holds it now, which is not page->data if the page left the pool and was loaded again
+ *
+ * Parameters:BM_BufferPool *const bm, BM_PageHandle *const page
+ *
+ * Return:RC
+ *
+ * Author:Zhipeng Liu
+ *
+ * History:
+ *      Date            Name                        Content
+ *  02/16/2016  Zhipeng Liu        finish the function
+ *  10/17/2026  agent              write the frame the page is in through the open file handle, without the shard latch
+***************************************************************/
+
+RC forcePage (BM_BufferPool *const bm, BM_PageHandle *const page)
+{
+    BM_BufferPool *shard = shardOf(bm, bm->fileId, page->pageNum);
+    BM_PoolMgmt *poolMgmt = shard->poolMgmt;
+    int i;
+    RC RC_flag;
+
+    RC_flag = finishWriteback(shard);
+    if (RC_flag != RC_OK)
+        return RC_flag;
+//      free(page->data);
+    // clean before the write, so that a markDirty during the write sticks
+    pthread_mutex_lock(&poolMgmt->latch);
+    i = findFrame(shard, bm->fileId, page->pageNum);
+    // a page that is not cached, or is being read, matches the file
+    if (i == -1 || poolMgmt->loading[i])
+    {
+        pthread_mutex_unlock(&poolMgmt->latch);
         return RC_OK;
     }
+    // page->data may be a frame that holds another page by now; the fix
+    // keeps the page in frame i until it is written
+    __atomic_add_fetch(&poolMgmt->fixCounts[i], 1, __ATOMIC_ACQUIRE);
+    setFrameDirty(shard, i, FALSE);
+//      (bm->mgmtData+i)->pageNum=-1;
+    pthread_mutex_unlock(&poolMgmt->latch);
+
+    pthread_mutex_lock(poolMgmt->fileLatch);
+    RC_flag = writeBlock(page->pageNum, bm->fh, FRAME_DATA(poolMgmt, i));
+    pthread_mutex_unlock(poolMgmt->fileLatch);
+
+    pthread_mutex_lock(&poolMgmt->latch);
+    if (RC_flag != RC_OK)
+        setFrameDirty(shard, i, TRUE);
+    else
+    {
+        (shard->numWriteIO)++;
+        poolMgmt->fileStats[bm->fileId].numForcedFlushes++;
+    }
+    __atomic_sub_fetch(&poolMgmt->fixCounts[i], 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&poolMgmt->latch);
+    if (RC_flag != RC_OK)
+        return RC_flag;
+    page->dirty = 0;
+//page->pageNum=-1;
+    return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: pinPage
+ *
+ * Description:pin a page, if the page does not exist in memory, read it from file
+ *
+ * Parameters:BM_BufferPool *const bm, BM_PageHandle *const page, const PageNumber pageNum
+ *
+ * Return:RC
+ *
+ * Author:Zhipeng Liu
+ *
+ * History:
+ *      Date            Name                        Content
+ *02/25/16       Zhipng Liu             imcomplete, need to implement the replace page part
+ *10/16/26       agent                  the work moved to pinPageRing
+***************************************************************/
+
+RC pinPage (BM_BufferPool *const bm, BM_PageHandle *const page,
+            const PageNumber pageNum)
+{
+    return pinPageRing(bm, NULL, page, pageNum);
+}
+
+/***************************************************************
+ * Function Name: pinPageRing
+ *
+ * Description: pin a page like pinPage. If the page is not cached and ring is not NULL, it is read into a frame of the ring instead of one chosen by the replacement strategy. A cached page is used wherever it is; a page of the ring pinned without the ring becomes an ordinary page of the pool.
+ *
+ * Parameters: BM_BufferPool *const bm, BM_BufferRing *const ring, BM_PageHandle *const page, const PageNumber pageNum
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+
+RC pinPageRing (BM_BufferPool *const bm, BM_BufferRing *const ring,
+                BM_PageHandle *const page, const PageNumber pageNum)
+{
+    BM_BufferPool *shard = shardOf(bm, bm->fileId, pageNum);
+    BM_PoolMgmt *poolMgmt = shard->poolMgmt;
+    BM_PoolStats *stats;
+    long long waitStart = 0;
+    bool missed = FALSE;
+    int pnum, published;
+    RC RC_flag;
+
+    // only pins that cannot take a cached page at once read the clock
+    if (pthread_mutex_trylock(&poolMgmt->latch) != 0)
+    {
+        waitStart = clockNs();
+        pthread_mutex_lock(&poolMgmt->latch);
+    }
+    for (;;)
+    {
+        pnum = findFrame(shard, bm->fileId, pageNum);
+        if (pnum != -1 && poolMgmt->loading[pnum] != 0 && waitStart == 0)
+            waitStart = clockNs();
+        if (pnum != -1)
+        {
+            // another thread is reading the page, its pin keeps the frame
+            if (poolMgmt->loading[pnum] == LOADING_READ)
+            {
+                pthread_cond_wait(&poolMgmt->loaded, &poolMgmt->latch);
+                continue;
+            }
+            // nobody waits for a prefetch read, publish it ourselves
+            if (poolMgmt->loading[pnum] == LOADING_PREFETCH)
+            {
+                pthread_mutex_unlock(&poolMgmt->latch);
+                published = publishPrefetches(bm, 1);
+                pthread_mutex_lock(&poolMgmt->latch);
+                if (published == 0)
+                    waitLoaded(poolMgmt);
+                continue;
+            }
+            if (poolMgmt->ringOf[pnum] != NULL && poolMgmt->ringOf[pnum] != ring)
+            {
+                poolMgmt->ringOf[pnum] = NULL;
+                touchFrame(shard, pnum);
+            }
+            else if (poolMgmt->ringOf[pnum] == NULL && shard->strategy != RS_FIFO)
+                touchFrame(shard, pnum);
+            __atomic_add_fetch(&poolMgmt->fixCounts[pnum], 1, __ATOMIC_ACQUIRE);
+            break;
+        }
+
+        // everything that waits for I/O drops the latch and starts over
+        if (waitStart == 0)
+            waitStart = clockNs();
+        if (pageNum >= __atomic_load_n(&bm->fh->totalNumPages, __ATOMIC_ACQUIRE))
+        {
+            pthread_mutex_unlock(&poolMgmt->latch);
+            pthread_mutex_lock(poolMgmt->fileLatch);
+            RC_flag = ensureCapacity(pageNum + 1, bm->fh);
+            pthread_mutex_unlock(poolMgmt->fileLatch);
+            if (RC_flag != RC_OK)
+                return RC_flag;
+            pthread_mutex_lock(&poolMgmt->latch);
+            continue;
+        }
+        if (__atomic_load_n(&poolMgmt->writebackBusy, __ATOMIC_ACQUIRE) && poolMgmt->writeback.pageNum == pageNum
+            && poolMgmt->writeback.fHandle == bm->fh)
+            RC_flag = RC_WRITEBACK_BUSY;
+        else if (ring != NULL)
+            RC_flag = getRingFrame(shard, ring, &pnum);
+        else
+            RC_flag = getFreeFrame(shard, &pnum);
+        if (RC_flag == RC_WRITEBACK_BUSY)
+        {
+            pthread_mutex_unlock(&poolMgmt->latch);
+            RC_flag = finishWriteback(shard);
+            if (RC_flag != RC_OK)
+                return RC_flag;
+            pthread_mutex_lock(&poolMgmt->latch);
+            continue;
+        }
+        if (RC_flag == RC_NO_FREE_FRAME && poolMgmt->numPrefetching > 0)
+        {
+            // frames of finished prefetch reads come free once published
+            pthread_mutex_unlock(&poolMgmt->latch);
+            if (publishPrefetches(bm, 1) == 0)
+                sched_yield();
+            pthread_mutex_lock(&poolMgmt->latch);
+            continue;
+        }
+        if (RC_flag != RC_OK)
+        {
+            pthread_mutex_unlock(&poolMgmt->latch);
+            return RC_flag;
+        }
+
+        // the page is entered before the read, so that other threads wait for it
+        poolMgmt->framePage[pnum] = pageNum;
+        poolMgmt->frameFile[pnum] = bm->fileId;
+        pageTableInsert(shard, pnum);
+        poolMgmt->fixCounts[pnum] = 1;
+        poolMgmt->accessCounts[pnum] = 0;
+        poolMgmt->loading[pnum] = LOADING_READ;
+        pthread_mutex_unlock(&poolMgmt->latch);
+        submitWriteback(shard);
+
+        pthread_mutex_lock(poolMgmt->fileLatch);
+        RC_flag = readBlock(pageNum, bm->fh, FRAME_DATA(poolMgmt, pnum));
+        pthread_mutex_unlock(poolMgmt->fileLatch);
+
+        pthread_mutex_lock(&poolMgmt->latch);
+        poolMgmt->loading[pnum] = 0;
+        pthread_cond_broadcast(&poolMgmt->loaded);
+        if (RC_flag != RC_OK)
+        {
+            poolMgmt->fixCounts[pnum] = 0;
+            releaseFrame(shard, pnum);
+            pthread_mutex_unlock(&poolMgmt->latch);
+            return RC_flag;
+        }
+        shard->numReadIO++;
+        missed = TRUE;
+        if (poolMgmt->ringOf[pnum] == NULL)
+            touchFrame(shard, pnum);
+        break;
+    }
+
+    stats = poolMgmt->fileStats + bm->fileId;
+    stats->numPins++;
+    if (missed)
+        stats->numMisses++;
+    else
+        stats->numHits++;
+    if (waitStart != 0)
+        stats->pinWaitNs += clockNs() - waitStart;
+    poolMgmt->accessCounts[pnum]++;
+    page->data = FRAME_DATA(poolMgmt, pnum);
+    page->fixCounts = FIX_COUNT(poolMgmt, pnum);
+    page->pageNum = pageNum;
+    page->dirty = poolMgmt->dirty[pnum];
+    page->strategyAttribute = poolMgmt->stamps + pnum;
+    pthread_mutex_unlock(&poolMgmt->latch);
+    if (__atomic_load_n(&bm->poolMgmt->traceFile, __ATOMIC_ACQUIRE) != NULL)
+        tracePin(bm, pageNum, !missed);
+    return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: prefetchPageRange
+ *
+ * Description: load the pages startPage .. startPage+numPages-1 into the pool without pinning them, like prefetchPages.
+ *
+ * Parameters: BM_BufferPool *const bm, const PageNumber startPage, const int numPages
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+RC prefetchPageRange (BM_BufferPool *const bm, const PageNumber startPage,
+                      const int numPages)
+{
+    return prefetchPageRangeRing(bm, NULL, startPage, numPages);
+}
+
+/***************************************************************
+ * Function Name: prefetchPageRangeRing
+ *
+ * Description: prefetch the pages startPage .. startPage+numPages-1 like prefetchPagesRing.
+ *
+ * Parameters: BM_BufferPool *const bm, BM_BufferRing *const ring, const PageNumber startPage, const int numPages
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+RC prefetchPageRangeRing (BM_BufferPool *const bm, BM_BufferRing *const ring,
+                          const PageNumber startPage, const int numPages)
+{
+    PageNumber pageNums[BM_AIO_QUEUE_DEPTH];
+    int n, i;
+
+    // no more reads than requests are started at once
+    n = numPages < BM_AIO_QUEUE_DEPTH ? numPages : BM_AIO_QUEUE_DEPTH;
+    for (i = 0; i < n; i++)
+        pageNums[i] = startPage + i;
+    return prefetchPagesRing(bm, ring, pageNums, n);
+}
+
+/***************************************************************
+ * Function Name: prefetchPages
+ *
+ * Description: start loading the pages pageNums[0 .. numPages-1] into the pool without pinning them, and return without waiting for the reads. Pages already cached, beyond the end of the file or being written back are skipped. The reads run on the asynchronous engine, at most BM_AIO_QUEUE_DEPTH of them at once, and every shard gives at most half of its frames to them. A pin of a page still being read waits for that read only; a read that failed leaves the frame empty and is reported by finishPrefetches.
+ *
+ * Parameters: BM_BufferPool *const bm, const PageNumber *pageNums, const int numPages
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+RC prefetchPages (BM_BufferPool *const bm, const PageNumber *pageNums, const int numPages)
+{
+    return prefetchPagesRing(bm, NULL, pageNums, numPages);
+}
+
+/***************************************************************
+ * Function Name: prefetchPagesRing
+ *
+ * Description: prefetch like prefetchPages. If ring is not NULL the pages are read into frames of the ring, and at most half of the ring is used so the pages the scan is on are not recycled.
+ *
+ * Parameters: BM_BufferPool *const bm, BM_BufferRing *const ring, const PageNumber *pageNums, const int numPages
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+
+RC prefetchPagesRing (BM_BufferPool *const bm, BM_BufferRing *const ring,
+                      const PageNumber *pageNums, const int numPages)
+{
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    BM_BufferPool *shard;
+    BM_PoolMgmt *shardMgmt;
+    SM_AsyncRequest *reads[BM_AIO_QUEUE_DEPTH];
+    SM_AsyncRequest *req;
+    int budget, numReqs, numReads, pnum, pageNum, i;
+    RC RC_flag;
+
+    // finished reads give their requests and frames back first
+    publishPrefetches(bm, 0);
+
+    budget = numPages;
+    if (ring != NULL && budget > ring->numFrames * ring->numShards / 2)
+        budget = ring->numFrames * ring->numShards / 2;
+    pthread_mutex_lock(&poolMgmt->aioLock);
+    for (numReqs = 0; numReqs < budget && poolMgmt->numFreePrefetchReqs > 0; numReqs++)
+        reads[numReqs] = poolMgmt->prefetchReqs + poolMgmt->freePrefetchReqs[--poolMgmt->numFreePrefetchReqs];
+    pthread_mutex_unlock(&poolMgmt->aioLock);
+
+    // claim a frame for every missing page, pinned and marked as loading so
+    // that pins of the page wait for the read. A page still being written
+    // back, or a shard whose writeback slot is taken, is left to pinPage.
+    numReads = 0;
+    for (i = 0; i < numPages && numReads < numReqs; i++) {
+        pageNum = pageNums[i];
+        if (pageNum < 0 || pageNum >= __atomic_load_n(&bm->fh->totalNumPages, __ATOMIC_ACQUIRE))
+            continue;
+        shard = shardOf(bm, bm->fileId, pageNum);
+        shardMgmt = shard->poolMgmt;
+        pthread_mutex_lock(&shardMgmt->latch);
+        if (shardMgmt->numPrefetching >= shard->numPages / 2 || findFrame(shard, bm->fileId, pageNum) != -1
+            || (__atomic_load_n(&shardMgmt->writebackBusy, __ATOMIC_ACQUIRE)
+                && shardMgmt->writeback.pageNum == pageNum && shardMgmt->writeback.fHandle == bm->fh)) {
+            pthread_mutex_unlock(&shardMgmt->latch);
+            continue;
+        }
+        if ((ring != NULL ? getRingFrame(shard, ring, &pnum) : getFreeFrame(shard, &pnum)) != RC_OK) {
+            pthread_mutex_unlock(&shardMgmt->latch);
+            break;
+        }
+        shardMgmt->framePage[pnum] = pageNum;
+        shardMgmt->frameFile[pnum] = bm->fileId;
+        pageTableInsert(shard, pnum);
+        shardMgmt->fixCounts[pnum] = 1;
+        shardMgmt->accessCounts[pnum] = 0;
+        shardMgmt->loading[pnum] = LOADING_PREFETCH;
+        shardMgmt->numPrefetching++;
+        pthread_mutex_unlock(&shardMgmt->latch);
+        submitWriteback(shard);
+
+        req = reads[numReads++];
+        poolMgmt->prefetchFile[req - poolMgmt->prefetchReqs] = bm->fileId;
+        req->op = SM_AIO_READ;
+        req->fHandle = bm->fh;
+        req->pageNum = pageNum;
+        req->memPage = FRAME_DATA(shardMgmt, pnum);
+        req->callback = prefetchDone;
+        req->userData = poolMgmt;
+    }
+
+    // a read that could not be submitted is published as failed
+    pthread_mutex_lock(&poolMgmt->aioLock);
+    for (i = 0; i < numReads; i++) {
+        pthread_mutex_lock(&poolMgmt->fileLock);
+        RC_flag = submitAsyncIO(poolMgmt->aio, reads[i]);
+        pthread_mutex_unlock(&poolMgmt->fileLock);
+        if (RC_flag != RC_OK) {
+            reads[i]->rc = RC_flag;
+            reads[i]->next = poolMgmt->prefetchesDone;
+            poolMgmt->prefetchesDone = reads[i];
+        } else
+            poolMgmt->readsInFlight++;
+    }
+    for (i = numReads; i < numReqs; i++)
+        poolMgmt->freePrefetchReqs[poolMgmt->numFreePrefetchReqs++] = (int)(reads[i] - poolMgmt->prefetchReqs);
+    pthread_mutex_unlock(&poolMgmt->aioLock);
+    return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: finishPrefetches
+ *
+ * Description: wait until every prefetch read of bm is done and its frame released, and return the error of the first read that failed since the last call.
+ *
+ * Parameters: BM_BufferPool *const bm
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+RC finishPrefetches (BM_BufferPool *const bm)
+{
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    bool busy;
+    RC RC_flag;
+
+    for (;;) {
+        pthread_mutex_lock(&poolMgmt->aioLock);
+        busy = poolMgmt->numFreePrefetchReqs < BM_AIO_QUEUE_DEPTH;
+        pthread_mutex_unlock(&poolMgmt->aioLock);
+        if (!busy)
+            break;
+        // a request may still be claiming frames or be published by another thread
+        if (publishPrefetches(bm, 1) == 0)
+            sched_yield();
+    }
+
+    pthread_mutex_lock(&poolMgmt->aioLock);
+    RC_flag = poolMgmt->prefetchRC;
+    poolMgmt->prefetchRC = RC_OK;
+    pthread_mutex_unlock(&poolMgmt->aioLock);
+    return RC_flag;
+}
+
+/***************************************************************
+ * Function Name: publishPrefetches
+ *
+ * Description: release the frames of the completed prefetch reads of pool bm: count the read and hand the frame to the replacement strategy, or empty it again if the read failed, and wake the pins waiting for the page. With minDone 1 it waits until at least one read of the pool completed, unless none is in flight. Returns the number of reads published. The caller holds no latch.
+ *
+ * Parameters: BM_BufferPool *const bm, int minDone
+ *
+ * Return: int
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+
+static int publishPrefetches(BM_BufferPool *const bm, int minDone) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    SM_AsyncRequest *done[BM_AIO_QUEUE_DEPTH];
+    SM_AsyncRequest *list, *req;
+    BM_BufferPool *shard;
+    BM_PoolMgmt *shardMgmt;
+    int n = 0, pnum, fileId;
+
+    // prefetchDone collects the reads, also when a writeback reaps them
+    pthread_mutex_lock(&poolMgmt->aioLock);
+    reapAsyncIO(poolMgmt->aio, done, BM_AIO_QUEUE_DEPTH, 0);
+    while (minDone > 0 && poolMgmt->prefetchesDone == NULL && poolMgmt->readsInFlight > 0)
+        reapAsyncIO(poolMgmt->aio, done, BM_AIO_QUEUE_DEPTH, 1);
+    list = poolMgmt->prefetchesDone;
+    poolMgmt->prefetchesDone = NULL;
+    pthread_mutex_unlock(&poolMgmt->aioLock);
+    if (list == NULL)
+        return 0;
+
+    for (req = list; req != NULL; req = req->next, n++) {
+        fileId = poolMgmt->prefetchFile[req - poolMgmt->prefetchReqs];
+        shard = shardOf(bm, fileId, req->pageNum);
+        shardMgmt = shard->poolMgmt;
+        pthread_mutex_lock(&shardMgmt->latch);
+        pnum = findFrame(shard, fileId, req->pageNum);
+        shardMgmt->loading[pnum] = 0;
+        shardMgmt->numPrefetching--;
+        __atomic_sub_fetch(&shardMgmt->fixCounts[pnum], 1, __ATOMIC_RELEASE);
+        if (req->rc != RC_OK) {
+            releaseFrame(shard, pnum);
+        } else {
+            shard->numReadIO++;
+            if (shardMgmt->ringOf[pnum] == NULL)
+                touchFrame(shard, pnum);
+        }
+        pthread_cond_broadcast(&shardMgmt->loaded);
+        pthread_mutex_unlock(&shardMgmt->latch);
+    }
+
+    pthread_mutex_lock(&poolMgmt->aioLock);
+    for (req = list; req != NULL; req = req->next) {
+        if (req->rc != RC_OK && poolMgmt->prefetchRC == RC_OK)
+            poolMgmt->prefetchRC = req->rc;
+        poolMgmt->freePrefetchReqs[poolMgmt->numFreePrefetchReqs++] = (int)(req - poolMgmt->prefetchReqs);
+    }
+    pthread_mutex_unlock(&poolMgmt->aioLock);
+    return n;
+}
+
+/***************************************************************
+ * Function Name: waitLoaded
+ *
+ * Description: wait on the loaded condition of a shard for a prefetch read that another thread publishes, at most a millisecond: the read may not even be submitted yet. The caller holds the shard latch.
+ *
+ * Parameters: BM_PoolMgmt *poolMgmt
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void waitLoaded(BM_PoolMgmt *poolMgmt) {
+    struct timespec wake;
+
+    clock_gettime(CLOCK_REALTIME, &wake);
+    wake.tv_nsec += 1000000;
+    if (wake.tv_nsec >= 1000000000) {
+        wake.tv_sec++;
+        wake.tv_nsec -= 1000000000;
+    }
+    pthread_cond_timedwait(&poolMgmt->loaded, &poolMgmt->latch, &wake);
+}
+
+/***************************************************************
+ * Function Name: initBufferRing
+ *
+ * Description: prepare ring for a sequential scan over bm. The ring takes up to numFrames frames from the pool as the scan reads pages through pinPageRing, at most half of the pool and at least one frame. In a partitioned pool the frames are spread evenly over the shards, at least one in each. Fails with RC_MEMORY_ALLOCATION_FAILED, leaving nothing allocated, if the ring's arrays cannot be allocated.
+ *
+ * Parameters: BM_BufferPool *const bm, BM_BufferRing *const ring, int numFrames
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+RC initBufferRing (BM_BufferPool *const bm, BM_BufferRing *const ring, int numFrames)
+{
+    int numShards = bm->poolMgmt->numShards;
+
+    // the smallest shard has bm->numPages / numShards frames
+    numFrames /= numShards;
+    if (numFrames > bm->numPages / numShards / 2)
+        numFrames = bm->numPages / numShards / 2;
+    if (numFrames < 1)
+        numFrames = 1;
+    ring->numFrames = numFrames;
+    ring->numShards = numShards;
+    ring->numUsed = (int *)calloc(numShards, sizeof(int));
+    ring->next = (int *)calloc(numShards, sizeof(int));
+    ring->frames = (int *)malloc(numShards * numFrames * sizeof(int));
+    if (ring->numUsed == NULL || ring->next == NULL || ring->frames == NULL) {
+        free(ring->numUsed);
+        free(ring->next);
+        free(ring->frames);
+        return RC_MEMORY_ALLOCATION_FAILED;
+    }
+    return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: freeBufferRing
+ *
+ * Description: give the frames of ring back to the pool. Clean unpinned frames are emptied, so the scan's pages do not stay behind; dirty or pinned frames keep their page and join the replacement strategy.
+ *
+ * Parameters: BM_BufferPool *const bm, BM_BufferRing *const ring
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+RC freeBufferRing (BM_BufferPool *const bm, BM_BufferRing *const ring)
+{
+    BM_BufferPool *shard;
+    BM_PoolMgmt *poolMgmt;
+    int i, s, pnum;
+
+    // prefetch reads may still hold frames of the ring
+    finishPrefetches(bm);
+    for (s = 0; s < ring->numShards; s++) {
+        shard = getShard(bm, s);
+        poolMgmt = shard->poolMgmt;
+        pthread_mutex_lock(&poolMgmt->latch);
+        for (i = 0; i < ring->numUsed[s]; i++) {
+            pnum = ring->frames[s * ring->numFrames + i];
+            if (poolMgmt->ringOf[pnum] != ring)
+                continue;
+            poolMgmt->ringOf[pnum] = NULL;
+            if (FIX_COUNT(poolMgmt, pnum) == 0 && !poolMgmt->dirty[pnum])
+                releaseFrame(shard, pnum);
+            else
+                touchFrame(shard, pnum);
+        }
+        pthread_mutex_unlock(&poolMgmt->latch);
+    }
+    free(ring->frames);
+    free(ring->numUsed);
+    free(ring->next);
+    ring->frames = NULL;
+    ring->numUsed = NULL;
+    ring->next = NULL;
+    return RC_OK;
+}
+
+// Statistics Interface
+
+/***************************************************************
+ * Function Name: getFrameContents
+ *
+ * Description: Returns an array of PageNumbers where the ith element is the number of the page stored in the ith page frame
+ *
+ * Parameters: BM_BufferPool *const bm
+ *
+ * Return: PageNumber *
+ *
+ * Author: Xincheng Yang
+ *
+ * History:
+ *      Date            Name                        Content
+ *   2016/2/27      Xincheng Yang             first time to implement the function
+ *   2026/10/16     agent                    copy the page numbers of all frames under the shard latches
+ *
+***************************************************************/
+PageNumber *getFrameContents (BM_BufferPool *const bm) {
+    PageNumber *arr = (PageNumber*)malloc(bm->numPages * sizeof(PageNumber));
+
+    latchShards(bm, TRUE);
+    memcpy(arr, bm->poolMgmt->framePage, bm->numPages * sizeof(PageNumber));
+    latchShards(bm, FALSE);
+    return arr;
+}
+
+/***************************************************************
+ * Function Name: getDirtyFlags
+ *
+ * Description: Returns an array of bools where the ith element is TRUE if the page stored in the ith page frame is dirty
+ *
+ * Parameters: BM_BufferPool *const bm
+ *
+ * Return: bool *
+ *
+ * Author: Xincheng Yang
+ *
+ * History:
+ *      Date            Name                        Content
+ *   2016/2/27      Xincheng Yang             first time to implement the function
+ *   2026/10/16     agent                    copy the dirty flags of all frames under the shard latches
+ *
+***************************************************************/
+bool *getDirtyFlags (BM_BufferPool *const bm) {
+    bool *arr = (bool*)malloc(bm->numPages * sizeof(bool));
+
+    latchShards(bm, TRUE);
+    memcpy(arr, bm->poolMgmt->dirty, bm->numPages * sizeof(bool));
+    latchShards(bm, FALSE);
+    return arr;
+}
+
+/***************************************************************
+ * Function Name: getFixCounts
+ *
+ * Description: Returns an array of ints where the ith element is the fix count of the page stored in the ith page frame
+ *
+ * Parameters: BM_BufferPool *const bm
+ *
+ * Return: int *
+ *
+ * Author: Xincheng Yang
+ *
+ * History:
+ *      Date            Name                        Content
+ *   2016/2/27      Xincheng Yang             first time to implement the function
+ *   2026/10/16     agent                    load the fix counts of the frame arrays atomically
+ *
+***************************************************************/
+int *getFixCounts (BM_BufferPool *const bm) {
+    int *arr = (int*)malloc(bm->numPages * sizeof(int));
+
+    int i;
+    for (i = 0; i < bm->numPages; i++) {
+        arr[i] = FIX_COUNT(bm->poolMgmt, i);
+    }
+    return arr;
+}
+
+/***************************************************************
+ * Function Name: getNumReadIO
+ *
+ * Description: Returns an array of ints where the ith element is the fix count of the page stored in the ith page frame
+ *
+ * Parameters: BM_BufferPool *const bm
+ *
+ * Return: int
+ *
+ * Author: Xincheng Yang
+ *
+ * History:
+ *      Date            Name                        Content
+ *   2016/2/27      Xincheng Yang             first time to implement the function
+ *   2026/10/16     agent                    sum over the shards under their latches
+ *
+***************************************************************/
+int getNumReadIO (BM_BufferPool *const bm) {
+    BM_BufferPool *shard;
+    int i, sum = 0;
+
+    // counters change under the shard latches
+    for (i = 0; i < bm->poolMgmt->numShards; i++) {
+        shard = getShard(bm, i);
+        pthread_mutex_lock(&shard->poolMgmt->latch);
+        sum += shard->numReadIO;
+        pthread_mutex_unlock(&shard->poolMgmt->latch);
+    }
+    return sum;
+}
+
+/***************************************************************
+ * Function Name: getNumWriteIO
+ *
+ * Description: Returns an array of ints where the ith element is the fix count of the page stored in the ith page frame
+ *
+ * Parameters: BM_BufferPool *const bm
+ *
+ * Return: int
+ *
+ * Author: Xincheng Yang
+ *
+ * History:
+ *      Date            Name                        Content
+ *   2016/2/27      Xincheng Yang             first time to implement the function
+ *   2026/10/16     agent                    sum over the shards under their latches
+ *
+***************************************************************/
+int getNumWriteIO (BM_BufferPool *const bm) {
+    BM_BufferPool *shard;
+    int i, sum = 0;
+
+    for (i = 0; i < bm->poolMgmt->numShards; i++) {
+        shard = getShard(bm, i);
+        pthread_mutex_lock(&shard->poolMgmt->latch);
+        sum += shard->numWriteIO;
+        pthread_mutex_unlock(&shard->poolMgmt->latch);
+    }
+    return sum;
+}
+
+/***************************************************************
+ * Function Name: getNumFlushRuns
+ *
+ * Description: Returns the number of runs of consecutive pages forceFlushPool wrote, one writeBlocks call each.
+ *
+ * Parameters: BM_BufferPool *const bm
+ *
+ * Return: int
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+int getNumFlushRuns (BM_BufferPool *const bm) {
+    BM_BufferPool *shard;
+    int i, sum = 0;
+
+    for (i = 0; i < bm->poolMgmt->numShards; i++) {
+        shard = getShard(bm, i);
+        pthread_mutex_lock(&shard->poolMgmt->latch);
+        sum += shard->poolMgmt->numFlushRuns;
+        pthread_mutex_unlock(&shard->poolMgmt->latch);
+    }
+    return sum;
+}
+
+/***************************************************************
+ * Function Name: getNumFlushPages
+ *
+ * Description: Returns the number of pages forceFlushPool wrote.
+ *
+ * Parameters: BM_BufferPool *const bm
+ *
+ * Return: int
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+int getNumFlushPages (BM_BufferPool *const bm) {
+    BM_BufferPool *shard;
+    int i, sum = 0;
+
+    for (i = 0; i < bm->poolMgmt->numShards; i++) {
+        shard = getShard(bm, i);
+        pthread_mutex_lock(&shard->poolMgmt->latch);
+        sum += shard->poolMgmt->numFlushPages;
+        pthread_mutex_unlock(&shard->poolMgmt->latch);
+    }
+    return sum;
+}
+
+/***************************************************************
+ * Function Name: getNumDirtyEvictions
+ *
+ * Description: return the number of dirty victims pins had to write back themselves because the background writer had not cleaned them.
+ *
+ * Parameters: BM_BufferPool *const bm
+ *
+ * Return: int
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+int getNumDirtyEvictions (BM_BufferPool *const bm) {
+    BM_BufferPool *shard;
+    int i, sum = 0;
+
+    for (i = 0; i < bm->poolMgmt->numShards; i++) {
+        shard = getShard(bm, i);
+        pthread_mutex_lock(&shard->poolMgmt->latch);
+        sum += shard->poolMgmt->numDirtyEvictions;
+        pthread_mutex_unlock(&shard->poolMgmt->latch);
+    }
+    return sum;
+}
+
+/***************************************************************
+ * Function Name: getNumWriterRounds
+ *
+ * Description: return the number of rounds the background writer made.
+ *
+ * Parameters: BM_BufferPool *const bm
+ *
+ * Return: int
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+int getNumWriterRounds (BM_BufferPool *const bm) {
+    return __atomic_load_n(&bm->poolMgmt->numWriterRounds, __ATOMIC_RELAXED);
+}
+
+/***************************************************************
+ * Function Name: getNumWriterPages
+ *
+ * Description: return the number of pages the background writer wrote.
+ *
+ * Parameters: BM_BufferPool *const bm
+ *
+ * Return: int
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+int getNumWriterPages (BM_BufferPool *const bm) {
+    BM_BufferPool *shard;
+    int i, sum = 0;
+
+    for (i = 0; i < bm->poolMgmt->numShards; i++) {
+        shard = getShard(bm, i);
+        pthread_mutex_lock(&shard->poolMgmt->latch);
+        sum += shard->poolMgmt->numWriterPages;
+        pthread_mutex_unlock(&shard->poolMgmt->latch);
+    }
+    return sum;
+}
+
+/***************************************************************
+ * Function Name: getPoolStats
+ *
+ * Description: fill *stats with the counters of the pins of bm's page file, for a file attached with attachPageFile, or of all files of the pool, for the pool itself. The counters of every shard are added up under its latch; nothing is allocated, so it can be called as often as needed.
+ *
+ * Parameters: BM_BufferPool *const bm, BM_PoolStats *stats
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+RC getPoolStats (BM_BufferPool *const bm, BM_PoolStats *stats) {
+    BM_PoolMgmt *poolMgmt;
+    BM_PoolStats *fileStats;
+    int i, fileId;
+
+    memset(stats, 0, sizeof(BM_PoolStats));
+    for (i = 0; i < bm->poolMgmt->numShards; i++) {
+        poolMgmt = getShard(bm, i)->poolMgmt;
+        pthread_mutex_lock(&poolMgmt->latch);
+        for (fileId = 0; fileId < BM_MAX_FILES; fileId++) {
+            if (bm != bm->poolMgmt->pool && fileId != bm->fileId)
+                continue;
+            fileStats = poolMgmt->fileStats + fileId;
+            stats->numPins += fileStats->numPins;
+            stats->numHits += fileStats->numHits;
+            stats->numMisses += fileStats->numMisses;
+            stats->numCleanEvictions += fileStats->numCleanEvictions;
+            stats->numDirtyEvictions += fileStats->numDirtyEvictions;
+            stats->numForcedFlushes += fileStats->numForcedFlushes;
+            stats->pinWaitNs += fileStats->pinWaitNs;
+        }
+        pthread_mutex_unlock(&poolMgmt->latch);
+    }
+    return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: getFrameAccessCounts
+ *
+ * Description: copy into counts, an array of bm->numPages entries, how often the page in each frame was pinned since it was loaded; 0 for empty frames.
+ *
+ * Parameters: BM_BufferPool *const bm, long long *counts
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+RC getFrameAccessCounts (BM_BufferPool *const bm, long long *counts) {
+    int i;
+
+    latchShards(bm, TRUE);
+    for (i = 0; i < bm->numPages; i++)
+        counts[i] = bm->poolMgmt->framePage[i] == NO_PAGE ? 0 : bm->poolMgmt->accessCounts[i];
+    latchShards(bm, FALSE);
+    return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: startPoolTrace
+ *
+ * Description: start logging every pin of the pool bm belongs to, of all its files, into the file traceFile: a BM_TraceHeader, then a BM_TraceRecord with the page, its file, the time and whether it was a hit for each pin. Records are collected in memory and written BM_TRACE_BUFFER at a time. A trace already running is stopped first.
+ *
+ * Parameters: BM_BufferPool *const bm, const char *const traceFile
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+RC startPoolTrace (BM_BufferPool *const bm, const char *const traceFile) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    BM_TraceHeader header;
+    FILE *file;
+    RC RC_flag;
+
+    RC_flag = stopPoolTrace(bm);
+    if (RC_flag != RC_OK)
+        return RC_flag;
+    file = fopen(traceFile, "wb");
+    if (file == NULL)
+        return RC_WRITE_FAILED;
+    header.magic = BM_TRACE_MAGIC;
+    header.version = BM_TRACE_VERSION;
+    header.numPages = bm->numPages;
+    header.strategy = bm->strategy;
+    if (fwrite(&header, sizeof(BM_TraceHeader), 1, file) != 1) {
+        fclose(file);
+        return RC_WRITE_FAILED;
+    }
+
+    pthread_mutex_lock(&poolMgmt->traceLock);
+    poolMgmt->traceBuffer = (BM_TraceRecord *)malloc(BM_TRACE_BUFFER * sizeof(BM_TraceRecord));
+    poolMgmt->traceUsed = 0;
+    poolMgmt->traceRC = RC_OK;
+    poolMgmt->traceStart = clockNs();
+    __atomic_store_n(&poolMgmt->traceFile, file, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&poolMgmt->traceLock);
+    return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: stopPoolTrace
+ *
+ * Description: write the records still in memory and close the trace of the pool bm belongs to. Returns the first error writing the trace; RC_OK if no trace runs.
+ *
+ * Parameters: BM_BufferPool *const bm
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+RC stopPoolTrace (BM_BufferPool *const bm) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    FILE *file;
+    RC RC_flag;
+
+    pthread_mutex_lock(&poolMgmt->traceLock);
+    file = poolMgmt->traceFile;
+    if (file == NULL) {
+        pthread_mutex_unlock(&poolMgmt->traceLock);
+        return RC_OK;
+    }
+    writeTrace(poolMgmt);
+    RC_flag = poolMgmt->traceRC;
+    __atomic_store_n(&poolMgmt->traceFile, NULL, __ATOMIC_RELEASE);
+    free(poolMgmt->traceBuffer);
+    poolMgmt->traceBuffer = NULL;
+    pthread_mutex_unlock(&poolMgmt->traceLock);
+
+    if (fclose(file) != 0 && RC_flag == RC_OK)
+        RC_flag = RC_WRITE_FAILED;
+    return RC_flag;
+}
+
+/***************************************************************
+ * Function Name: strategyFIFOandLRU
+ *
+ * Description: decide use which frame to save data using FIFO. The replacement list keeps the loaded frames ordered by their attribute, so the victim is the first unpinned frame from its head; only pinned frames are skipped.
+ *
+ * Parameters: BM_BufferPool *bm
+ *
+ * Return: int
+ *
+ * Author: Xiaoliang Wu
+ *
+ * History:
+ *      Date            Name                        Content
+ *      16/02/27        Xiaoliang Wu                Complete
+ *      26/10/16        agent                       Walk the replacement list instead of copying and scanning all attributes.
+ *
+***************************************************************/
+
+int strategyFIFOandLRU(BM_BufferPool *bm) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    int i;
+
+    for (i = poolMgmt->listHead; i != -1; i = poolMgmt->listNext[i]) {
+        if (FIX_COUNT(bm->poolMgmt, i) == 0)
+            return i;
+    }
+    return -1;
+}
+
+/***************************************************************
+ * Function Name: strategyCLOCK
+ *
+ * Description: decide use which frame to save data using CLOCK (second chance). The hand sweeps over the frames, skipping pinned ones; a frame whose reference bit is set gets the bit cleared and is passed over once, the first frame without it is the victim. Hits only set a bit, nothing is reordered.
+ *
+ * Parameters: BM_BufferPool *bm
+ *
+ * Return: int
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+
+int strategyCLOCK(BM_BufferPool *bm) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    int frameIndex;
+    int i;
+
+    // two turns clear every bit, a third finds nothing only if all frames are pinned
+    for (i = 0; i < 2 * bm->numPages + 1; ++i) {
+        frameIndex = poolMgmt->clockHand;
+        poolMgmt->clockHand = (poolMgmt->clockHand + 1) % bm->numPages;
+        if (poolMgmt->framePage[frameIndex] == NO_PAGE || FIX_COUNT(bm->poolMgmt, frameIndex) != 0
+            || poolMgmt->ringOf[frameIndex] != NULL)
+            continue;
+        if (poolMgmt->refBits[frameIndex]) {
+            poolMgmt->refBits[frameIndex] = 0;
+            continue;
+        }
+        return frameIndex;
+    }
+    return -1;
+}
+
+/***************************************************************
+ * Function Name: strategyLFU
+ *
+ * Description: decide use which frame to save data using LFU: the unpinned frame with the fewest references, the one counted longest ago among equals. Buckets are walked from the lowest count, so only pinned frames are skipped.
+ *
+ * Parameters: BM_BufferPool *bm
+ *
+ * Return: int
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+int strategyLFU(BM_BufferPool *bm) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    int bucket, i;
+
+    for (bucket = poolMgmt->bucketHead; bucket != -1; bucket = poolMgmt->bucketNext[bucket]) {
+        for (i = poolMgmt->bucketFirst[bucket]; i != -1; i = poolMgmt->listNext[i]) {
+            if (FIX_COUNT(bm->poolMgmt, i) == 0)
+                return i;
+        }
+    }
+    return -1;
+}
+
+/***************************************************************
+ * Function Name: strategyLRU_k
+ *
+ * Description: decide use which frame to save data using LRU-K: the unpinned frame with the largest backward K-distance. Frames with fewer than k references have an infinite distance and go first, least recently used first; otherwise the frame whose k-th most recent reference is oldest is chosen from the heap. Pinned frames found on the way are set aside and put back.
+ *
+ * Parameters: BM_BufferPool *bm
+ *
+ * Return: int
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+int strategyLRU_k(BM_BufferPool *bm) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    int victim = -1;
+    int numSpilled = 0;
+    int i;
+
+    for (i = poolMgmt->listHead; i != -1; i = poolMgmt->listNext[i]) {
+        if (FIX_COUNT(bm->poolMgmt, i) == 0)
+            return i;
+    }
+
+    while (poolMgmt->heapSize > 0) {
+        i = poolMgmt->heap[0];
+        if (FIX_COUNT(bm->poolMgmt, i) == 0) {
+            victim = i;
+            break;
+        }
+        heapRemove(poolMgmt, i);
+        poolMgmt->heapSpill[numSpilled++] = i;
+    }
+    while (numSpilled > 0)
+        heapInsert(poolMgmt, poolMgmt->heapSpill[--numSpilled]);
+    return victim;
+}
+
+/***************************************************************
+ * Function Name: strategyARC
+ *
+ * Description: decide use which frame to save data using ARC: the least recently used unpinned frame of T1 while T1 is larger than its target size, otherwise of T2. If every frame of that list is pinned the other list is used.
+ *
+ * Parameters: BM_BufferPool *bm
+ *
+ * Return: int
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+int strategyARC(BM_BufferPool *bm) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    int lists[2] = { poolMgmt->listHead, poolMgmt->t2Head };
+    int first, k, i;
+
+    first = poolMgmt->t1Size > poolMgmt->arcTarget || poolMgmt->t2Size == 0 ? 0 : 1;
+    for (k = 0; k < 2; k++) {
+        for (i = lists[first ^ k]; i != -1; i = poolMgmt->listNext[i]) {
+            if (FIX_COUNT(bm->poolMgmt, i) == 0)
+                return i;
+        }
+    }
+    return -1;
+}
+
+/***************************************************************
+ * Function Name: getAttributionArray
+ *
+ * Description: return an array that includes all pages strategyAttribute.
+ *
+ * Parameters: BM_BufferPool *bm
+ *
+ * Return: long long*
+ *
+ * Author: Xiaoliang Wu
+ *
+ * History:
+ *      Date            Name                        Content
+ *      16/02/27        Xiaoliang Wu                Complete.
+ *      26/10/16        agent                       Copy the 64-bit stamps of the pool.
+ *
+***************************************************************/
+
+long long *getAttributionArray(BM_BufferPool *bm) {
+    long long *attributes;
+    int i;
+
+    attributes = (long long *)calloc(bm->numPages, sizeof(long long));
+    for (i = 0; i < bm->numPages; ++i) {
+        attributes[i] = bm->poolMgmt->stamps[i];
+    }
+    return attributes;
+}
+
+/***************************************************************
+ * Function Name: freePagesBuffer
+ *
+ * Description: free all pages in pool: unmap the slab that holds the frames.
+ *
+ * Parameters: BM_BufferPool *bm
+ *
+ * Return: RC
+ *
+ * Author: Xiaoliang Wu
+ *
+ * History:
+ *      Date            Name                        Content
+ *      16/02/26        Xiaoliang Wu                Complete.
+ *      26/10/16        agent                       All frames are one slab, strategy attributes are freed with the pool.
+ *
+***************************************************************/
+
+void freePagesBuffer(BM_BufferPool *bm) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+
+    if (poolMgmt->slab != NULL)
+        munmap(poolMgmt->slab, poolMgmt->slabSize);
+    poolMgmt->slab = poolMgmt->frameData = NULL;
+}
+
+/***************************************************************
+ * Function Name: updataAttribute
+ *
+ * Description: modify the attribute about strategy. FIFO only use this function when page initial. LRU, CLOCK, LFU, LRU-K and ARC use this function when pinPage occurs. pageHandle is a handle pinned from bm; the work is done by touchFrame on the frame it points to.
+ *
+ * Parameters: BM_BufferPool *bm, BM_PageHandle *pageHandle
+ *
+ * Return: RC
+ *
+ * Author: Xiaoliang Wu
+ *
+ * History:
+ *      Date            Name                        Content
+ *      16/02/26        Xiaoliang Wu                FIFO, LRU complete.
+ *      26/10/17        agent                       The work moved to touchFrame, check the frame still holds the page.
+ *
+***************************************************************/
+
+RC updataAttribute(BM_BufferPool *bm, BM_PageHandle *pageHandle) {
+    BM_BufferPool *shard = shardOf(bm, bm->fileId, pageHandle->pageNum);
+    BM_PoolMgmt *poolMgmt = shard->poolMgmt;
+    int i;
+
+    if (bm->strategy < RS_FIFO || bm->strategy > RS_ARC)
+        return RC_STRATEGY_NOT_FOUND;
+    pthread_mutex_lock(&poolMgmt->latch);
+    // the handle's frame may hold another page by now
+    i = -1;
+    if (pageHandle->strategyAttribute >= poolMgmt->stamps
+        && pageHandle->strategyAttribute < poolMgmt->stamps + shard->numPages)
+        i = (int)(pageHandle->strategyAttribute - poolMgmt->stamps);
+    if (i == -1 || poolMgmt->framePage[i] != pageHandle->pageNum || poolMgmt->frameFile[i] != bm->fileId)
+        i = findFrame(shard, bm->fileId, pageHandle->pageNum);
+    if (i == -1) {
+        pthread_mutex_unlock(&poolMgmt->latch);
+        return RC_READ_NON_EXISTING_PAGE;
+    }
+    touchFrame(shard, i);
+    pthread_mutex_unlock(&poolMgmt->latch);
+    return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: touchFrame
+ *
+ * Description: record a reference of frame frameIndex for the replacement strategy of bm: stamp it with the pool clock and update the strategy's list, bits, counts or history. The frame moves to the tail of the replacement list, which keeps the list in attribute order. The caller holds the shard latch.
+ *
+ * Parameters: BM_BufferPool *const bm, int frameIndex
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void touchFrame(BM_BufferPool *const bm, int frameIndex) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+
+    // assign number
+    if (bm->strategy == RS_FIFO || bm->strategy == RS_LRU) {
+        poolMgmt->stamps[frameIndex] = (bm->timer)++;
+        if (poolMgmt->listPrev[frameIndex] != LIST_UNLINKED)
+            listRemove(poolMgmt, &poolMgmt->listHead, &poolMgmt->listTail, frameIndex);
+        listAppend(poolMgmt, &poolMgmt->listHead, &poolMgmt->listTail, frameIndex);
+    } else if (bm->strategy == RS_CLOCK) {
+        poolMgmt->stamps[frameIndex] = (bm->timer)++;
+        poolMgmt->refBits[frameIndex] = 1;
+    } else if (bm->strategy == RS_LFU) {
+        poolMgmt->stamps[frameIndex] = (bm->timer)++;
+        lfuCount(bm, frameIndex);
+    } else if (bm->strategy == RS_LRU_K) {
+        poolMgmt->stamps[frameIndex] = bm->timer;
+        lrukReference(bm, frameIndex);
+        (bm->timer)++;
+    } else if (bm->strategy == RS_ARC) {
+        poolMgmt->stamps[frameIndex] = (bm->timer)++;
+        arcReference(bm, frameIndex);
+    }
+}
+
+/***************************************************************
+ * Function Name: findFrame
+ *
+ * Description: return the index of the frame that holds page pageNum of file fileId, or -1 if the page is not in the pool.
+ *
+ * Parameters: BM_BufferPool *const bm, int fileId, const PageNumber pageNum
+ *
+ * Return: int
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+
+static int findFrame(BM_BufferPool *const bm, int fileId, const PageNumber pageNum) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    uint32_t slot;
+    int frameIndex;
+
+    for (slot = pageSlot(poolMgmt, fileId, pageNum); (frameIndex = poolMgmt->pageTable[slot]) != -1;
+         slot = (slot + 1) & poolMgmt->pageTableMask) {
+        if (poolMgmt->framePage[frameIndex] == pageNum && poolMgmt->frameFile[frameIndex] == fileId)
+            return frameIndex;
+    }
+    return -1;
+}
+
+/***************************************************************
+ * Function Name: getFreeFrame
+ *
+ * Description: choose the frame a new page is loaded into: an empty frame from the free frame stack, otherwise the victim of the replacement strategy. A dirty victim is copied aside and written back asynchronously, so the caller's read of the new page overlaps the write. Frames are slices of the pool's slab, aligned and sized for the page file, so they also work with SM_MODE_DIRECT files.
+ *
+ * Parameters: BM_BufferPool *const bm, int *frameIndex
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+
+static RC getFreeFrame(BM_BufferPool *const bm, int *frameIndex) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+
+    if (poolMgmt->numFreeFrames == 0)
+        return evictFrame(bm, frameIndex);
+    *frameIndex = poolMgmt->freeFrames[--poolMgmt->numFreeFrames];
+    return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: evictFrame
+ *
+ * Description: empty the victim of the replacement strategy and return its frame, like getFreeFrame does when no frame is empty. A dirty victim is written back asynchronously with startWriteback, so RC_WRITEBACK_BUSY may come back. The caller holds the shard latch.
+ *
+ * Parameters: BM_BufferPool *const bm, int *frameIndex
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+
+static RC evictFrame(BM_BufferPool *const bm, int *frameIndex) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    BM_PoolStats *stats;
+    int pnum = -1;
+    RC RC_flag;
+
+    if (bm->strategy == RS_FIFO || bm->strategy == RS_LRU) {
+        pnum = strategyFIFOandLRU(bm);
+    } else if (bm->strategy == RS_CLOCK) {
+        pnum = strategyCLOCK(bm);
+    } else if (bm->strategy == RS_LFU) {
+        pnum = strategyLFU(bm);
+    } else if (bm->strategy == RS_LRU_K) {
+        pnum = strategyLRU_k(bm);
+    } else if (bm->strategy == RS_ARC) {
+        pnum = strategyARC(bm);
+    } else {
+        return RC_STRATEGY_NOT_FOUND;
+    }
+    if (pnum == -1)
+        return RC_NO_FREE_FRAME;
+
+    stats = poolMgmt->fileStats + poolMgmt->frameFile[pnum];
+    if (poolMgmt->dirty[pnum]) {
+        RC_flag = startWriteback(bm, pnum);
+        if (RC_flag != RC_OK)
+            return RC_flag;
+        stats->numDirtyEvictions++;
+    } else {
+        stats->numCleanEvictions++;
+    }
+    // the caller enters the new page once it is read
+    if (bm->strategy == RS_LFU)
+        lfuRemove(poolMgmt, pnum);
+    else if (bm->strategy == RS_LRU_K)
+        lrukForget(bm, pnum);
+    else if (bm->strategy == RS_ARC)
+        arcForget(bm, pnum, TRUE);
+    else if (poolMgmt->listPrev[pnum] != LIST_UNLINKED)
+        listRemove(poolMgmt, &poolMgmt->listHead, &poolMgmt->listTail, pnum);
+    pageTableRemove(bm, pnum);
+    poolMgmt->framePage[pnum] = NO_PAGE;
+
+    *frameIndex = pnum;
+    return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: getRingFrame
+ *
+ * Description: choose the frame of ring a new page is loaded into. Until the ring is full it takes frames from the pool with getFreeFrame; then it recycles its frames in turn, writing a dirty one back like a victim. A recycled frame that is pinned, or that the pool took over, is replaced in the ring by a new frame from the pool. bm is a shard, the ring keeps separate frames in every shard.
+ *
+ * Parameters: BM_BufferPool *const bm, BM_BufferRing *const ring, int *frameIndex
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+
+static RC getRingFrame(BM_BufferPool *const bm, BM_BufferRing *const ring, int *frameIndex) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    int shardIndex = poolMgmt->shardIndex;
+    int *frames = ring->frames + shardIndex * ring->numFrames;
+    BM_PoolStats *stats;
+    int pnum;
+    RC RC_flag;
+
+    if (ring->numUsed[shardIndex] == ring->numFrames) {
+        pnum = frames[ring->next[shardIndex]];
+        if (poolMgmt->ringOf[pnum] == ring && FIX_COUNT(poolMgmt, pnum) == 0) {
+            stats = poolMgmt->fileStats + poolMgmt->frameFile[pnum];
+            if (poolMgmt->dirty[pnum]) {
+                RC_flag = startWriteback(bm, pnum);
+                if (RC_flag != RC_OK)
+                    return RC_flag;
+                stats->numDirtyEvictions++;
+            } else {
+                stats->numCleanEvictions++;
+            }
+            pageTableRemove(bm, pnum);
+            poolMgmt->framePage[pnum] = NO_PAGE;
+            ring->next[shardIndex] = (ring->next[shardIndex] + 1) % ring->numFrames;
+            *frameIndex = pnum;
+            return RC_OK;
+        }
+        // a pinned frame stays with its page and joins the pool
+        if (poolMgmt->ringOf[pnum] == ring) {
+            poolMgmt->ringOf[pnum] = NULL;
+            touchFrame(bm, pnum);
+        }
+    }
+
+    RC_flag = getFreeFrame(bm, &pnum);
+    if (RC_flag != RC_OK)
+        return RC_flag;
+    poolMgmt->ringOf[pnum] = ring;
+    if (ring->numUsed[shardIndex] < ring->numFrames) {
+        frames[ring->numUsed[shardIndex]++] = pnum;
+    } else {
+        frames[ring->next[shardIndex]] = pnum;
+        ring->next[shardIndex] = (ring->next[shardIndex] + 1) % ring->numFrames;
+    }
+    *frameIndex = pnum;
+    return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: startWriteback
+ *
+ * Description: write a dirty frame back without waiting for the write. Only one writeback per shard is in flight; while it is, or while another thread uses the asynchronous engine, RC_WRITEBACK_BUSY is returned and the caller finishes the writeback with finishWriteback after dropping the shard latch. The page is copied into the shard's writeback buffer so the frame can take a new page immediately, and the frame counts as clean from now on. The write is only set up here: the caller submits it with submitWriteback once it dropped the shard latch, since the engine completes some writes, such as those of memory-mapped files, in the submitting thread.
+ *
+ * Parameters: BM_BufferPool *const bm, int frameIndex
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+
+static RC startWriteback(BM_BufferPool *const bm, int frameIndex) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    RC RC_flag;
+
+    // the caller holds the shard latch and must not wait for I/O here
+    if (pthread_mutex_trylock(poolMgmt->aioLatch) != 0)
+        return RC_WRITEBACK_BUSY;
+    if (__atomic_load_n(&poolMgmt->writebackBusy, __ATOMIC_ACQUIRE)) {
+        pthread_mutex_unlock(poolMgmt->aioLatch);
+        return RC_WRITEBACK_BUSY;
+    }
+    RC_flag = poolMgmt->writebackRC;
+    poolMgmt->writebackRC = RC_OK;
+    if (RC_flag != RC_OK) {
+        pthread_mutex_unlock(poolMgmt->aioLatch);
+        return RC_flag;
+    }
+
+    memcpy(poolMgmt->writebackData, FRAME_DATA(poolMgmt, frameIndex), poolMgmt->pageSize);
+    poolMgmt->writeback.op = SM_AIO_WRITE;
+    poolMgmt->writeback.fHandle = poolMgmt->files[poolMgmt->frameFile[frameIndex]];
+    poolMgmt->writeback.pageNum = poolMgmt->framePage[frameIndex];
+    poolMgmt->writeback.memPage = poolMgmt->writebackData;
+    __atomic_store_n(&poolMgmt->writebackBusy, true, __ATOMIC_RELEASE);
+    poolMgmt->writebackStaged = TRUE;
+    pthread_mutex_unlock(poolMgmt->aioLatch);
+
+    bm->numWriteIO++;
+    poolMgmt->numDirtyEvictions++;
+    setFrameDirty(bm, frameIndex, FALSE);
+    // the background writer should have cleaned this frame
+    kickWriter(bm);
+    return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: submitWriteback
+ *
+ * Description: submit the writeback startWriteback set up in shard bm, if it is not submitted yet. The caller must not hold the shard latch.
+ *
+ * Parameters: BM_BufferPool *const bm
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void submitWriteback(BM_BufferPool *const bm) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+
+    // waitWriteback may have submitted it already
+    if (!__atomic_load_n(&poolMgmt->writebackBusy, __ATOMIC_ACQUIRE))
+        return;
+    pthread_mutex_lock(poolMgmt->aioLatch);
+    issueWriteback(bm);
+    pthread_mutex_unlock(poolMgmt->aioLatch);
+}
+
+/***************************************************************
+ * Function Name: issueWriteback
+ *
+ * Description: submit the writeback set up in shard bm if it is still waiting to be submitted. A submit that fails counts as a failed writeback, reported by the next waitWriteback or startWriteback. The caller holds aioLatch.
+ *
+ * Parameters: BM_BufferPool *const bm
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void issueWriteback(BM_BufferPool *const bm) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    RC RC_flag;
+
+    if (!poolMgmt->writebackStaged)
+        return;
+    poolMgmt->writebackStaged = FALSE;
+    pthread_mutex_lock(poolMgmt->fileLatch);
+    RC_flag = submitAsyncIO(poolMgmt->aio, &poolMgmt->writeback);
+    pthread_mutex_unlock(poolMgmt->fileLatch);
+    if (RC_flag != RC_OK) {
+        poolMgmt->writebackRC = RC_flag;
+        __atomic_store_n(&poolMgmt->writebackBusy, false, __ATOMIC_RELEASE);
+    }
+}
+
+/***************************************************************
+ * Function Name: waitWriteback
+ *
+ * Description: wait until the pending writeback, if any, is on disk. Returns the error of a writeback that failed since the last call. The caller holds aioLatch.
+ *
+ * Parameters: BM_BufferPool *const bm
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static RC waitWriteback(BM_BufferPool *const bm) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    SM_AsyncRequest *done[BM_AIO_QUEUE_DEPTH];
+    RC RC_flag;
+
+    // the thread that set it up may not have got to it yet
+    issueWriteback(bm);
+
+    // writebackDone clears writebackBusy
+    while (__atomic_load_n(&poolMgmt->writebackBusy, __ATOMIC_ACQUIRE)) {
+        reapAsyncIO(poolMgmt->aio, done, BM_AIO_QUEUE_DEPTH, 1);
+    }
+
+    RC_flag = poolMgmt->writebackRC;
+    poolMgmt->writebackRC = RC_OK;
+    return RC_flag;
+}
+
+/***************************************************************
+ * Function Name: writebackDone
+ *
+ * Description: completion callback of the writeback request.
+ *
+ * Parameters: SM_AsyncRequest *req
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void writebackDone(SM_AsyncRequest *req) {
+    BM_PoolMgmt *poolMgmt = (BM_PoolMgmt *)req->userData;
+
+    if (req->rc != RC_OK)
+        poolMgmt->writebackRC = req->rc;
+    __atomic_store_n(&poolMgmt->writebackBusy, false, __ATOMIC_RELEASE);
+}
+
+/***************************************************************
+ * Function Name: prefetchDone
+ *
+ * Description: completion callback of a prefetch read. It runs in whatever thread reaps the engine and must not take a shard latch, so it only queues the read; publishPrefetches releases the frame.
+ *
+ * Parameters: SM_AsyncRequest *req
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void prefetchDone(SM_AsyncRequest *req) {
+    BM_PoolMgmt *poolMgmt = (BM_PoolMgmt *)req->userData;
+
+    poolMgmt->readsInFlight--;
+    req->next = poolMgmt->prefetchesDone;
+    poolMgmt->prefetchesDone = req;
+}
+
+/***************************************************************
+ * Function Name: comparePageNums
+ *
+ * Description: qsort comparator ordering BM_FrameRefs by the file and page they hold.
+ *
+ * Parameters: const void *a, const void *b
+ *
+ * Return: int
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+
+static int comparePageNums(const void *a, const void *b) {
+    const BM_FrameRef *x = (const BM_FrameRef *)a;
+    const BM_FrameRef *y = (const BM_FrameRef *)b;
+
+    if (x->fileId != y->fileId)
+        return (x->fileId > y->fileId) - (x->fileId < y->fileId);
+    return (x->pageNum > y->pageNum) - (x->pageNum < y->pageNum);
+}
+
+/***************************************************************
+ * Function Name: pageSlot
+ *
+ * Description: home slot of page pageNum of file fileId in the page table. Page numbers are scrambled with a multiplicative hash so that runs of adjacent pages spread over the table; the file id offsets the page number, so page 0 of every file has a different slot.
+ *
+ * Parameters: BM_PoolMgmt *poolMgmt, int fileId, const PageNumber pageNum
+ *
+ * Return: uint32_t
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+
+static uint32_t pageSlot(BM_PoolMgmt *poolMgmt, int fileId, const PageNumber pageNum) {
+    uint32_t h = ((uint32_t)pageNum + (uint32_t)fileId * 0x9e3779b9u) * 2654435761u;
+
+    return (h ^ (h >> 16)) & poolMgmt->pageTableMask;
+}
+
+/***************************************************************
+ * Function Name: pageTableInsert
+ *
+ * Description: enter the page held by frame frameIndex in the page table. The table has at least twice as many slots as frames, so there is always an empty slot.
+ *
+ * Parameters: BM_BufferPool *const bm, int frameIndex
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void pageTableInsert(BM_BufferPool *const bm, int frameIndex) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    uint32_t slot;
+
+    slot = pageSlot(poolMgmt, poolMgmt->frameFile[frameIndex], poolMgmt->framePage[frameIndex]);
+    while (poolMgmt->pageTable[slot] != -1)
+        slot = (slot + 1) & poolMgmt->pageTableMask;
+    poolMgmt->pageTable[slot] = frameIndex;
+}
+
+/***************************************************************
+ * Function Name: pageTableRemove
+ *
+ * Description: take the page of frame frameIndex out of the page table. Later entries of the same probe sequence are shifted back into the gap, so lookups never need tombstones.
+ *
+ * Parameters: BM_BufferPool *const bm, int frameIndex
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+
+static void pageTableRemove(BM_BufferPool *const bm, int frameIndex) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    uint32_t mask = poolMgmt->pageTableMask;
+    uint32_t gap, slot, home;
+    int other;
+
+    for (gap = pageSlot(poolMgmt, poolMgmt->frameFile[frameIndex], poolMgmt->framePage[frameIndex]); ;
+         gap = (gap + 1) & mask) {
+        other = poolMgmt->pageTable[gap];
+        if (other == -1)
+            return;
+        if (other == frameIndex)
+            break;
+    }
+
+    for (slot = (gap + 1) & mask; (other = poolMgmt->pageTable[slot]) != -1; slot = (slot + 1) & mask) {
+        home = pageSlot(poolMgmt, poolMgmt->frameFile[other], poolMgmt->framePage[other]);
+        // an entry may move into the gap unless its home lies in (gap, slot]
+        if (((slot - home) & mask) >= ((slot - gap) & mask)) {
+            poolMgmt->pageTable[gap] = other;
+            gap = slot;
+        }
+    }
+    poolMgmt->pageTable[gap] = -1;
+}
+
+/***************************************************************
+ * Function Name: releaseFrame
+ *
+ * Description: empty frame frameIndex after a failed read or when a scan ring is freed: take its page out of the page table and the replacement list and push the frame on the free frame stack.
+ *
+ * Parameters: BM_BufferPool *const bm, int frameIndex
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void releaseFrame(BM_BufferPool *const bm, int frameIndex) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+
+    if (poolMgmt->framePage[frameIndex] != NO_PAGE) {
+        pageTableRemove(bm, frameIndex);
+        poolMgmt->framePage[frameIndex] = NO_PAGE;
+    }
+    bm->poolMgmt->ringOf[frameIndex] = NULL;
+    if (bm->strategy == RS_LFU)
+        lfuRemove(bm->poolMgmt, frameIndex);
+    else if (bm->strategy == RS_LRU_K)
+        lrukForget(bm, frameIndex);
+    else if (bm->strategy == RS_ARC)
+        arcForget(bm, frameIndex, FALSE);
+    else if (bm->poolMgmt->listPrev[frameIndex] != LIST_UNLINKED)
+        listRemove(bm->poolMgmt, &bm->poolMgmt->listHead, &bm->poolMgmt->listTail, frameIndex);
+    bm->poolMgmt->freeFrames[bm->poolMgmt->numFreeFrames++] = frameIndex;
+}
+
+/***************************************************************
+ * Function Name: listAppend
+ *
+ * Description: link frame frameIndex in at the tail of the frame list from *head to *tail: the replacement list or an LFU bucket.
+ *
+ * Parameters: BM_PoolMgmt *poolMgmt, int *head, int *tail, int frameIndex
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void listAppend(BM_PoolMgmt *poolMgmt, int *head, int *tail, int frameIndex) {
+    poolMgmt->listPrev[frameIndex] = *tail;
+    poolMgmt->listNext[frameIndex] = -1;
+    if (*tail != -1)
+        poolMgmt->listNext[*tail] = frameIndex;
+    else
+        *head = frameIndex;
+    *tail = frameIndex;
+}
+
+/***************************************************************
+ * Function Name: listRemove
+ *
+ * Description: unlink frame frameIndex from the frame list from *head to *tail.
+ *
+ * Parameters: BM_PoolMgmt *poolMgmt, int *head, int *tail, int frameIndex
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void listRemove(BM_PoolMgmt *poolMgmt, int *head, int *tail, int frameIndex) {
+    int prev = poolMgmt->listPrev[frameIndex];
+    int next = poolMgmt->listNext[frameIndex];
+
+    if (prev != -1)
+        poolMgmt->listNext[prev] = next;
+    else
+        *head = next;
+    if (next != -1)
+        poolMgmt->listPrev[next] = prev;
+    else
+        *tail = prev;
+    poolMgmt->listPrev[frameIndex] = poolMgmt->listNext[frameIndex] = LIST_UNLINKED;
+}
+
+/***************************************************************
+ * Function Name: lfuCount
+ *
+ * Description: count one reference to frame frameIndex: move it from its bucket to the bucket of the next higher count, creating that bucket right after the old one if needed. A frame that was not counted yet starts in the bucket of count 1.
+ *
+ * Parameters: BM_BufferPool *const bm, int frameIndex
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void lfuCount(BM_BufferPool *const bm, int frameIndex) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    int bucket = poolMgmt->bucketOf[frameIndex];
+    int next, count;
+
+    if (bucket == -1) {
+        next = poolMgmt->bucketHead;
+        count = 1;
+    } else {
+        next = poolMgmt->bucketNext[bucket];
+        count = poolMgmt->bucketCount[bucket] + 1;
+    }
+    if (next == -1 || poolMgmt->bucketCount[next] != count)
+        next = lfuNewBucket(poolMgmt, count, bucket);
+
+    if (bucket != -1)
+        lfuRemove(poolMgmt, frameIndex);
+    listAppend(poolMgmt, &poolMgmt->bucketFirst[next], &poolMgmt->bucketLast[next], frameIndex);
+    poolMgmt->bucketOf[frameIndex] = next;
+
+    if (poolMgmt->agingInterval > 0 && ++poolMgmt->refsSinceAging >= poolMgmt->agingInterval) {
+        lfuAge(poolMgmt);
+        poolMgmt->refsSinceAging = 0;
+    }
+}
+
+/***************************************************************
+ * Function Name: lfuRemove
+ *
+ * Description: take frame frameIndex out of its LFU bucket and free the bucket if it became empty.
+ *
+ * Parameters: BM_PoolMgmt *poolMgmt, int frameIndex
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void lfuRemove(BM_PoolMgmt *poolMgmt, int frameIndex) {
+    int bucket = poolMgmt->bucketOf[frameIndex];
+
+    if (bucket == -1)
+        return;
+    listRemove(poolMgmt, &poolMgmt->bucketFirst[bucket], &poolMgmt->bucketLast[bucket], frameIndex);
+    poolMgmt->bucketOf[frameIndex] = -1;
+    if (poolMgmt->bucketFirst[bucket] == -1)
+        lfuFreeBucket(poolMgmt, bucket);
+}
+
+/***************************************************************
+ * Function Name: lfuNewBucket
+ *
+ * Description: take an empty bucket for count from the free stack and link it in after bucket prev, or at the head for prev -1.
+ *
+ * Parameters: BM_PoolMgmt *poolMgmt, int count, int prev
+ *
+ * Return: int
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static int lfuNewBucket(BM_PoolMgmt *poolMgmt, int count, int prev) {
+    int bucket = poolMgmt->freeBuckets[--poolMgmt->numFreeBuckets];
+    int next = prev == -1 ? poolMgmt->bucketHead : poolMgmt->bucketNext[prev];
+
+    poolMgmt->bucketCount[bucket] = count;
+    poolMgmt->bucketFirst[bucket] = poolMgmt->bucketLast[bucket] = -1;
+    poolMgmt->bucketPrev[bucket] = prev;
+    poolMgmt->bucketNext[bucket] = next;
+    if (prev == -1)
+        poolMgmt->bucketHead = bucket;
+    else
+        poolMgmt->bucketNext[prev] = bucket;
+    if (next != -1)
+        poolMgmt->bucketPrev[next] = bucket;
+    return bucket;
+}
+
+/***************************************************************
+ * Function Name: lfuFreeBucket
+ *
+ * Description: unlink an empty bucket and push it on the free stack.
+ *
+ * Parameters: BM_PoolMgmt *poolMgmt, int bucket
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void lfuFreeBucket(BM_PoolMgmt *poolMgmt, int bucket) {
+    int prev = poolMgmt->bucketPrev[bucket];
+    int next = poolMgmt->bucketNext[bucket];
+
+    if (prev == -1)
+        poolMgmt->bucketHead = next;
+    else
+        poolMgmt->bucketNext[prev] = next;
+    if (next != -1)
+        poolMgmt->bucketPrev[next] = prev;
+    poolMgmt->freeBuckets[poolMgmt->numFreeBuckets++] = bucket;
+}
+
+/***************************************************************
+ * Function Name: lfuAge
+ *
+ * Description: halve every reference count, keeping at least 1, so pages that were hot long ago can be evicted again. Halving keeps the bucket order; a bucket whose new count equals its predecessor's is merged into it behind the predecessor's frames. The cost is amortized over agingInterval references.
+ *
+ * Parameters: BM_PoolMgmt *poolMgmt
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void lfuAge(BM_PoolMgmt *poolMgmt) {
+    int bucket, prev, next, count, i;
+
+    prev = -1;
+    for (bucket = poolMgmt->bucketHead; bucket != -1; bucket = next) {
+        next = poolMgmt->bucketNext[bucket];
+        count = poolMgmt->bucketCount[bucket] / 2;
+        if (count < 1)
+            count = 1;
+        if (prev == -1 || poolMgmt->bucketCount[prev] != count) {
+            poolMgmt->bucketCount[bucket] = count;
+            prev = bucket;
+            continue;
+        }
+        // splice the frames behind those of prev
+        for (i = poolMgmt->bucketFirst[bucket]; i != -1; i = poolMgmt->listNext[i])
+            poolMgmt->bucketOf[i] = prev;
+        poolMgmt->listPrev[poolMgmt->bucketFirst[bucket]] = poolMgmt->bucketLast[prev];
+        poolMgmt->listNext[poolMgmt->bucketLast[prev]] = poolMgmt->bucketFirst[bucket];
+        poolMgmt->bucketLast[prev] = poolMgmt->bucketLast[bucket];
+        lfuFreeBucket(poolMgmt, bucket);
+    }
+}
+
+/***************************************************************
+ * Function Name: lrukReference
+ *
+ * Description: record a reference to frame frameIndex at the current time. A page just loaded first gets back the history kept from its last eviction. With fewer than k references the frame moves to the tail of the replacement list, otherwise it moves in the heap.
+ *
+ * Parameters: BM_BufferPool *const bm, int frameIndex
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void lrukReference(BM_BufferPool *const bm, int frameIndex) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    long long *times = poolMgmt->refTimes + (size_t)frameIndex * poolMgmt->k;
+    PageNumber pageNum = poolMgmt->framePage[frameIndex];
+    int fileId = poolMgmt->frameFile[frameIndex];
+    int slot;
+
+    if (poolMgmt->numRefs[frameIndex] == 0 && poolMgmt->historySize > 0) {
+        slot = historySlot(poolMgmt, fileId, pageNum);
+        if (poolMgmt->historyPage[slot] == pageNum && poolMgmt->historyFile[slot] == fileId) {
+            memcpy(times, poolMgmt->historyTimes + (size_t)slot * poolMgmt->k, poolMgmt->k * sizeof(long long));
+            poolMgmt->numRefs[frameIndex] = poolMgmt->historyRefs[slot];
+            poolMgmt->historyPage[slot] = NO_PAGE;
+        }
+    }
+
+    memmove(times + 1, times, (poolMgmt->k - 1) * sizeof(long long));
+    times[0] = bm->timer;
+    if (poolMgmt->numRefs[frameIndex] < poolMgmt->k)
+        poolMgmt->numRefs[frameIndex]++;
+
+    if (poolMgmt->numRefs[frameIndex] < poolMgmt->k) {
+        if (poolMgmt->listPrev[frameIndex] != LIST_UNLINKED)
+            listRemove(poolMgmt, &poolMgmt->listHead, &poolMgmt->listTail, frameIndex);
+        listAppend(poolMgmt, &poolMgmt->listHead, &poolMgmt->listTail, frameIndex);
+    } else if (poolMgmt->heapPos[frameIndex] == -1) {
+        if (poolMgmt->listPrev[frameIndex] != LIST_UNLINKED)
+            listRemove(poolMgmt, &poolMgmt->listHead, &poolMgmt->listTail, frameIndex);
+        heapInsert(poolMgmt, frameIndex);
+    } else {
+        // the k-th most recent reference only gets younger
+        heapSiftDown(poolMgmt, poolMgmt->heapPos[frameIndex]);
+    }
+}
+
+/***************************************************************
+ * Function Name: lrukForget
+ *
+ * Description: take frame frameIndex out of the LRU-K structures when its page leaves the pool, keeping the page's references in the history table.
+ *
+ * Parameters: BM_BufferPool *const bm, int frameIndex
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void lrukForget(BM_BufferPool *const bm, int frameIndex) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    PageNumber pageNum = poolMgmt->framePage[frameIndex];
+    int slot;
+
+    if (poolMgmt->numRefs[frameIndex] == 0)
+        return;
+    if (poolMgmt->historySize > 0 && pageNum != NO_PAGE) {
+        // a newer eviction takes the slot over
+        slot = historySlot(poolMgmt, poolMgmt->frameFile[frameIndex], pageNum);
+        poolMgmt->historyPage[slot] = pageNum;
+        poolMgmt->historyFile[slot] = poolMgmt->frameFile[frameIndex];
+        poolMgmt->historyRefs[slot] = poolMgmt->numRefs[frameIndex];
+        memcpy(poolMgmt->historyTimes + (size_t)slot * poolMgmt->k,
+               poolMgmt->refTimes + (size_t)frameIndex * poolMgmt->k, poolMgmt->k * sizeof(long long));
+    }
+    if (poolMgmt->heapPos[frameIndex] != -1)
+        heapRemove(poolMgmt, frameIndex);
+    else if (poolMgmt->listPrev[frameIndex] != LIST_UNLINKED)
+        listRemove(poolMgmt, &poolMgmt->listHead, &poolMgmt->listTail, frameIndex);
+    poolMgmt->numRefs[frameIndex] = 0;
+}
+
+/***************************************************************
+ * Function Name: lrukKey
+ *
+ * Description: heap key of frame frameIndex, the time of its k-th most recent reference.
+ *
+ * Parameters: BM_PoolMgmt *poolMgmt, int frameIndex
+ *
+ * Return: long long
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static long long lrukKey(BM_PoolMgmt *poolMgmt, int frameIndex) {
+    return poolMgmt->refTimes[(size_t)frameIndex * poolMgmt->k + poolMgmt->k - 1];
+}
+
+/***************************************************************
+ * Function Name: historySlot
+ *
+ * Description: slot of page pageNum of file fileId in the history table of evicted pages.
+ *
+ * Parameters: BM_PoolMgmt *poolMgmt, int fileId, const PageNumber pageNum
+ *
+ * Return: int
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static int historySlot(BM_PoolMgmt *poolMgmt, int fileId, const PageNumber pageNum) {
+    uint32_t h = ((uint32_t)pageNum + (uint32_t)fileId * 0x9e3779b9u) * 2654435761u;
+
+    return (int)((h ^ (h >> 16)) % (uint32_t)poolMgmt->historySize);
+}
+
+/***************************************************************
+ * Function Name: heapInsert
+ *
+ * Description: add frame frameIndex to the LRU-K heap.
+ *
+ * Parameters: BM_PoolMgmt *poolMgmt, int frameIndex
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void heapInsert(BM_PoolMgmt *poolMgmt, int frameIndex) {
+    int pos = poolMgmt->heapSize++;
+
+    poolMgmt->heap[pos] = frameIndex;
+    poolMgmt->heapPos[frameIndex] = pos;
+    heapSiftUp(poolMgmt, pos);
+}
+
+/***************************************************************
+ * Function Name: heapRemove
+ *
+ * Description: take frame frameIndex out of the LRU-K heap; the last element fills its place.
+ *
+ * Parameters: BM_PoolMgmt *poolMgmt, int frameIndex
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void heapRemove(BM_PoolMgmt *poolMgmt, int frameIndex) {
+    int pos = poolMgmt->heapPos[frameIndex];
+    int last = poolMgmt->heap[--poolMgmt->heapSize];
+
+    poolMgmt->heapPos[frameIndex] = -1;
+    if (last == frameIndex)
+        return;
+    poolMgmt->heap[pos] = last;
+    poolMgmt->heapPos[last] = pos;
+    heapSiftUp(poolMgmt, pos);
+    heapSiftDown(poolMgmt, poolMgmt->heapPos[last]);
+}
+
+/***************************************************************
+ * Function Name: heapSiftUp
+ *
+ * Description: move the element at pos up until its parent's key is not larger.
+ *
+ * Parameters: BM_PoolMgmt *poolMgmt, int pos
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void heapSiftUp(BM_PoolMgmt *poolMgmt, int pos) {
+    int frameIndex = poolMgmt->heap[pos];
+    long long key = lrukKey(poolMgmt, frameIndex);
+    int parent;
+
+    while (pos > 0) {
+        parent = (pos - 1) / 2;
+        if (lrukKey(poolMgmt, poolMgmt->heap[parent]) <= key)
+            break;
+        poolMgmt->heap[pos] = poolMgmt->heap[parent];
+        poolMgmt->heapPos[poolMgmt->heap[pos]] = pos;
+        pos = parent;
+    }
+    poolMgmt->heap[pos] = frameIndex;
+    poolMgmt->heapPos[frameIndex] = pos;
+}
+
+/***************************************************************
+ * Function Name: heapSiftDown
+ *
+ * Description: move the element at pos down until no child has a smaller key.
+ *
+ * Parameters: BM_PoolMgmt *poolMgmt, int pos
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void heapSiftDown(BM_PoolMgmt *poolMgmt, int pos) {
+    int frameIndex = poolMgmt->heap[pos];
+    long long key = lrukKey(poolMgmt, frameIndex);
+    int child;
+
+    while ((child = 2 * pos + 1) < poolMgmt->heapSize) {
+        if (child + 1 < poolMgmt->heapSize
+            && lrukKey(poolMgmt, poolMgmt->heap[child + 1]) < lrukKey(poolMgmt, poolMgmt->heap[child]))
+            child++;
+        if (lrukKey(poolMgmt, poolMgmt->heap[child]) >= key)
+            break;
+        poolMgmt->heap[pos] = poolMgmt->heap[child];
+        poolMgmt->heapPos[poolMgmt->heap[pos]] = pos;
+        pos = child;
+    }
+    poolMgmt->heap[pos] = frameIndex;
+    poolMgmt->heapPos[frameIndex] = pos;
+}
+
+/***************************************************************
+ * Function Name: arcReference
+ *
+ * Description: record a reference to frame frameIndex for ARC. A hit moves the frame to the most recent end of T2. A page just loaded goes to T2 if it was a ghost, moving the target size of T1 up for a B1 ghost and down for a B2 ghost by the ratio of the ghost list sizes; any other page goes to T1, and the oldest ghost of B1 or B2 is dropped when |T1| + |B1| would exceed numPages or all four lists 2 * numPages.
+ *
+ * Parameters: BM_BufferPool *const bm, int frameIndex
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void arcReference(BM_BufferPool *const bm, int frameIndex) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    int c = bm->numPages;
+    int entry, delta;
+
+    if (poolMgmt->arcList[frameIndex] != 0) {
+        arcForget(bm, frameIndex, FALSE);
+        listAppend(poolMgmt, &poolMgmt->t2Head, &poolMgmt->t2Tail, frameIndex);
+        poolMgmt->arcList[frameIndex] = ARC_T2;
+        poolMgmt->t2Size++;
+        return;
+    }
+
+    entry = arcFindGhost(bm, poolMgmt->frameFile[frameIndex], poolMgmt->framePage[frameIndex]);
+    if (entry != -1) {
+        if (poolMgmt->arcList[entry] == ARC_B1) {
+            delta = poolMgmt->b1Size >= poolMgmt->b2Size ? 1 : poolMgmt->b2Size / poolMgmt->b1Size;
+            poolMgmt->arcTarget = poolMgmt->arcTarget + delta < c ? poolMgmt->arcTarget + delta : c;
+        } else {
+            delta = poolMgmt->b2Size >= poolMgmt->b1Size ? 1 : poolMgmt->b1Size / poolMgmt->b2Size;
+            poolMgmt->arcTarget = poolMgmt->arcTarget - delta > 0 ? poolMgmt->arcTarget - delta : 0;
+        }
+        arcDropGhost(bm, entry);
+        listAppend(poolMgmt, &poolMgmt->t2Head, &poolMgmt->t2Tail, frameIndex);
+        poolMgmt->arcList[frameIndex] = ARC_T2;
+        poolMgmt->t2Size++;
+        return;
+    }
+
+    if (poolMgmt->t1Size + 1 + poolMgmt->b1Size > c && poolMgmt->b1Size > 0)
+        arcDropGhost(bm, poolMgmt->b1Head);
+    else if (poolMgmt->t1Size + poolMgmt->t2Size + poolMgmt->b1Size + poolMgmt->b2Size + 1 > 2 * c
+             && poolMgmt->b2Size > 0)
+        arcDropGhost(bm, poolMgmt->b2Head);
+    listAppend(poolMgmt, &poolMgmt->listHead, &poolMgmt->listTail, frameIndex);
+    poolMgmt->arcList[frameIndex] = ARC_T1;
+    poolMgmt->t1Size++;
+}
+
+/***************************************************************
+ * Function Name: arcForget
+ *
+ * Description: take frame frameIndex off T1 or T2. With keepGhost its page is remembered at the most recent end of B1 or B2; when all ghost entries are in use the oldest ghost of B1 is dropped if |T1| + |B1| has reached numPages, of B2 otherwise.
+ *
+ * Parameters: BM_BufferPool *const bm, int frameIndex, bool keepGhost
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void arcForget(BM_BufferPool *const bm, int frameIndex, bool keepGhost) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    char list = poolMgmt->arcList[frameIndex];
+    PageNumber pageNum = poolMgmt->framePage[frameIndex];
+    uint32_t slot;
+    int entry;
+
+    if (list == ARC_T1) {
+        listRemove(poolMgmt, &poolMgmt->listHead, &poolMgmt->listTail, frameIndex);
+        poolMgmt->t1Size--;
+    } else if (list == ARC_T2) {
+        listRemove(poolMgmt, &poolMgmt->t2Head, &poolMgmt->t2Tail, frameIndex);
+        poolMgmt->t2Size--;
+    } else {
+        return;
+    }
+    poolMgmt->arcList[frameIndex] = 0;
+    if (!keepGhost || pageNum == NO_PAGE)
+        return;
+
+    if (poolMgmt->numFreeGhosts == 0) {
+        if ((poolMgmt->t1Size + poolMgmt->b1Size >= bm->numPages && poolMgmt->b1Size > 0) || poolMgmt->b2Size == 0)
+            arcDropGhost(bm, poolMgmt->b1Head);
+        else
+            arcDropGhost(bm, poolMgmt->b2Head);
+    }
+    entry = poolMgmt->freeGhosts[--poolMgmt->numFreeGhosts];
+    poolMgmt->ghostPage[entry - bm->numPages] = pageNum;
+    poolMgmt->ghostFile[entry - bm->numPages] = poolMgmt->frameFile[frameIndex];
+    slot = pageSlot(poolMgmt, poolMgmt->frameFile[frameIndex], pageNum);
+    while (poolMgmt->ghostTable[slot] != -1)
+        slot = (slot + 1) & poolMgmt->pageTableMask;
+    poolMgmt->ghostTable[slot] = entry;
+    if (list == ARC_T1) {
+        listAppend(poolMgmt, &poolMgmt->b1Head, &poolMgmt->b1Tail, entry);
+        poolMgmt->arcList[entry] = ARC_B1;
+        poolMgmt->b1Size++;
+    } else {
+        listAppend(poolMgmt, &poolMgmt->b2Head, &poolMgmt->b2Tail, entry);
+        poolMgmt->arcList[entry] = ARC_B2;
+        poolMgmt->b2Size++;
+    }
+}
+
+/***************************************************************
+ * Function Name: arcDropGhost
+ *
+ * Description: forget ghost entry entry: unlink it from B1 or B2, take its page out of the ghost table the way pageTableRemove does and push the entry on the free stack.
+ *
+ * Parameters: BM_BufferPool *const bm, int entry
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void arcDropGhost(BM_BufferPool *const bm, int entry) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    uint32_t mask = poolMgmt->pageTableMask;
+    uint32_t gap, slot, home;
+    int other;
+
+    if (poolMgmt->arcList[entry] == ARC_B1) {
+        listRemove(poolMgmt, &poolMgmt->b1Head, &poolMgmt->b1Tail, entry);
+        poolMgmt->b1Size--;
+    } else {
+        listRemove(poolMgmt, &poolMgmt->b2Head, &poolMgmt->b2Tail, entry);
+        poolMgmt->b2Size--;
+    }
+    poolMgmt->arcList[entry] = 0;
+
+    for (gap = pageSlot(poolMgmt, poolMgmt->ghostFile[entry - bm->numPages], poolMgmt->ghostPage[entry - bm->numPages]);
+         poolMgmt->ghostTable[gap] != entry; gap = (gap + 1) & mask)
+        ;
+    for (slot = (gap + 1) & mask; (other = poolMgmt->ghostTable[slot]) != -1; slot = (slot + 1) & mask) {
+        home = pageSlot(poolMgmt, poolMgmt->ghostFile[other - bm->numPages], poolMgmt->ghostPage[other - bm->numPages]);
+        if (((slot - home) & mask) >= ((slot - gap) & mask)) {
+            poolMgmt->ghostTable[gap] = other;
+            gap = slot;
+        }
+    }
+    poolMgmt->ghostTable[gap] = -1;
+    poolMgmt->freeGhosts[poolMgmt->numFreeGhosts++] = entry;
+}
+
+/***************************************************************
+ * Function Name: arcFindGhost
+ *
+ * Description: ghost entry of page pageNum of file fileId in B1 or B2.
+ *
+ * Parameters: BM_BufferPool *const bm, int fileId, const PageNumber pageNum
+ *
+ * Return: int, -1 if the page is no ghost
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static int arcFindGhost(BM_BufferPool *const bm, int fileId, const PageNumber pageNum) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    uint32_t slot;
+    int entry;
+
+    for (slot = pageSlot(poolMgmt, fileId, pageNum); (entry = poolMgmt->ghostTable[slot]) != -1;
+         slot = (slot + 1) & poolMgmt->pageTableMask) {
+        if (poolMgmt->ghostPage[entry - bm->numPages] == pageNum && poolMgmt->ghostFile[entry - bm->numPages] == fileId)
+            return entry;
+    }
+    return -1;
+}
+
+/***************************************************************
+ * Function Name: shardOf
+ *
+ * Description: return the shard of bm that caches page pageNum of file fileId; the pool itself when it is not partitioned. Runs of BM_SHARD_PAGES pages share a shard, so a prefetched or flushed run mostly stays in one shard.
+ *
+ * Parameters: BM_BufferPool *const bm, int fileId, const PageNumber pageNum
+ *
+ * Return: BM_BufferPool *
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+
+static BM_BufferPool *shardOf(BM_BufferPool *const bm, int fileId, const PageNumber pageNum) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    uint32_t h;
+
+    if (poolMgmt->shards == NULL)
+        return poolMgmt->bm;
+    h = ((uint32_t)(pageNum / BM_SHARD_PAGES) + (uint32_t)fileId * 0x9e3779b9u) * 2654435761u;
+    return poolMgmt->shards + (h ^ (h >> 16)) % (uint32_t)poolMgmt->numShards;
+}
+
+/***************************************************************
+ * Function Name: getShard
+ *
+ * Description: return shard i of bm, 0 <= i < numShards.
+ *
+ * Parameters: BM_BufferPool *const bm, int i
+ *
+ * Return: BM_BufferPool *
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+
+static BM_BufferPool *getShard(BM_BufferPool *const bm, int i) {
+    return bm->poolMgmt->shards == NULL ? bm->poolMgmt->bm : bm->poolMgmt->shards + i;
+}
+
+/***************************************************************
+ * Function Name: finishWriteback
+ *
+ * Description: wait for the pending writeback of shard like waitWriteback. The caller must not hold the shard latch.
+ *
+ * Parameters: BM_BufferPool *const shard
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static RC finishWriteback(BM_BufferPool *const shard) {
+    RC RC_flag;
+
+    pthread_mutex_lock(shard->poolMgmt->aioLatch);
+    RC_flag = waitWriteback(shard);
+    pthread_mutex_unlock(shard->poolMgmt->aioLatch);
+    return RC_flag;
+}
+
+/***************************************************************
+ * Function Name: latchShards
+ *
+ * Description: take (lock TRUE) or release the latches of all shards of bm, for a consistent picture of all frames. They are taken in shard order; everything else holds at most one shard latch.
+ *
+ * Parameters: BM_BufferPool *const bm, bool lock
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void latchShards(BM_BufferPool *const bm, bool lock) {
+    int i;
+
+    for (i = 0; i < bm->poolMgmt->numShards; i++) {
+        if (lock)
+            pthread_mutex_lock(&getShard(bm, i)->poolMgmt->latch);
+        else
+            pthread_mutex_unlock(&getShard(bm, i)->poolMgmt->latch);
+    }
+}
+
+/***************************************************************
+ * Function Name: setFrameDirty
+ *
+ * Description: set the dirty flag of a frame of shard and keep the shard's count of dirty frames. Kicks the background writer when fewer than lowWatermark percent of the frames stay clean. The caller holds the shard latch.
+ *
+ * Parameters: BM_BufferPool *const shard, int frameIndex, bool dirty
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void setFrameDirty(BM_BufferPool *const shard, int frameIndex, bool dirty) {
+    BM_PoolMgmt *poolMgmt = shard->poolMgmt;
+    BM_PoolMgmt *pool = poolMgmt->pool->poolMgmt;
+
+    if (poolMgmt->dirty[frameIndex] == dirty)
+        return;
+    poolMgmt->dirty[frameIndex] = dirty;
+    if (!dirty) {
+        poolMgmt->numDirty--;
+        return;
+    }
+    poolMgmt->numDirty++;
+    if (__atomic_load_n(&pool->writerRunning, __ATOMIC_ACQUIRE)
+        && (shard->numPages - poolMgmt->numDirty) * 100 < pool->writerParams.lowWatermark * shard->numPages)
+        kickWriter(shard);
+}
+
+/***************************************************************
+ * Function Name: kickWriter
+ *
+ * Description: wake the background writer of the pool shard belongs to, if one runs, without waiting for its interval.
+ *
+ * Parameters: BM_BufferPool *const shard
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void kickWriter(BM_BufferPool *const shard) {
+    BM_PoolMgmt *pool = shard->poolMgmt->pool->poolMgmt;
+
+    if (!__atomic_load_n(&pool->writerRunning, __ATOMIC_ACQUIRE)
+        || __atomic_load_n(&pool->writerKick, __ATOMIC_RELAXED))
+        return;
+    pthread_mutex_lock(&pool->writerLock);
+    pool->writerKick = TRUE;
+    pthread_cond_signal(&pool->writerWake);
+    pthread_mutex_unlock(&pool->writerLock);
+}
+
+/***************************************************************
+ * Function Name: backgroundWriter
+ *
+ * Description: main function of the background writer thread of pool arg. Each round cleans every shard with cleanShard until maxPagesPerRound pages are written.
+ *
+ * Parameters: void *arg
+ *
+ * Return: void *
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void *backgroundWriter(void *arg) {
+    BM_BufferPool *bm = (BM_BufferPool *)arg;
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    struct timespec wake;
+    int budget, i;
+
+    pthread_mutex_lock(&poolMgmt->writerLock);
+    while (!poolMgmt->writerStop) {
+        if (!poolMgmt->writerKick) {
+            clock_gettime(CLOCK_REALTIME, &wake);
+            wake.tv_sec += poolMgmt->writerParams.intervalMs / 1000;
+            wake.tv_nsec += (long)(poolMgmt->writerParams.intervalMs % 1000) * 1000000;
+            if (wake.tv_nsec >= 1000000000) {
+                wake.tv_sec++;
+                wake.tv_nsec -= 1000000000;
+            }
+            pthread_cond_timedwait(&poolMgmt->writerWake, &poolMgmt->writerLock, &wake);
+            if (poolMgmt->writerStop)
+                break;
+        }
+        __atomic_store_n(&poolMgmt->writerKick, FALSE, __ATOMIC_RELAXED);
+        pthread_mutex_unlock(&poolMgmt->writerLock);
+
+        budget = poolMgmt->writerParams.maxPagesPerRound;
+        for (i = 0; i < poolMgmt->numShards && budget > 0; i++)
+            cleanShard(getShard(bm, i), &budget);
+        __atomic_add_fetch(&poolMgmt->numWriterRounds, 1, __ATOMIC_RELAXED);
+
+        pthread_mutex_lock(&poolMgmt->writerLock);
+    }
+    pthread_mutex_unlock(&poolMgmt->writerLock);
+    return NULL;
+}
+
+/***************************************************************
+ * Function Name: cleanShard
+ *
+ * Description: one round of the background writer in shard: write the dirty unpinned frames among the cleanAhead percent of frames the strategy evicts next, at most *budget of them, and take them off *budget.
+ *
+ * Parameters: BM_BufferPool *const shard, int *budget
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static void cleanShard(BM_BufferPool *const shard, int *budget) {
+    BM_PoolMgmt *poolMgmt = shard->poolMgmt;
+    int *dirty;
+    int *victims;
+    int ahead, numVictims, numDirty, pnum, i;
+
+    ahead = shard->numPages * poolMgmt->pool->poolMgmt->writerParams.cleanAhead / 100;
+    if (ahead < 1)
+        ahead = 1;
+    victims = (int *)malloc(ahead * sizeof(int));
+    dirty = (int *)malloc(ahead * sizeof(int));
+
+    numDirty = 0;
+    pthread_mutex_lock(&poolMgmt->latch);
+    if (poolMgmt->numDirty > 0) {
+        numVictims = nextVictims(shard, victims, ahead);
+        for (i = 0; i < numVictims && numDirty < *budget; i++) {
+            pnum = victims[i];
+            if (poolMgmt->dirty[pnum] && FIX_COUNT(poolMgmt, pnum) == 0 && !poolMgmt->loading[pnum]
+                && poolMgmt->framePage[pnum] != NO_PAGE) {
+                poolMgmt->fixCounts[pnum] = 1;
+                setFrameDirty(shard, pnum, FALSE);
+                dirty[numDirty++] = pnum;
+            }
+        }
+    }
+    pthread_mutex_unlock(&poolMgmt->latch);
+
+    if (numDirty > 0)
+        writeFrames(shard, dirty, numDirty, &poolMgmt->numWriterPages, &poolMgmt->numWriterRuns, FALSE);
+    *budget -= numDirty;
+    free(dirty);
+    free(victims);
+}
+
+/***************************************************************
+ * Function Name: nextVictims
+ *
+ * Description: store up to max frames of bm in frames in about the order the replacement strategy would evict them, pinned frames included, and return their number. The caller holds the shard latch.
+ *
+ * Parameters: BM_BufferPool *const bm, int *frames, int max
+ *
+ * Return: int
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/16        agent                       Complete.
+ *
+***************************************************************/
+
+static int nextVictims(BM_BufferPool *const bm, int *frames, int max) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    int lists[2] = { poolMgmt->listHead, poolMgmt->t2Head };
+    int n = 0;
+    int first, bucket, pass, i, j;
+
+    if (bm->strategy == RS_CLOCK) {
+        // the hand takes frames with a clear reference bit first
+        for (pass = 0; pass < 2; pass++) {
+            for (j = 0; j < bm->numPages && n < max; j++) {
+                i = (poolMgmt->clockHand + j) % bm->numPages;
+                if (poolMgmt->refBits[i] == pass && poolMgmt->ringOf[i] == NULL)
+                    frames[n++] = i;
+            }
+        }
+    } else if (bm->strategy == RS_LFU) {
+        for (bucket = poolMgmt->bucketHead; bucket != -1 && n < max; bucket = poolMgmt->bucketNext[bucket]) {
+            for (i = poolMgmt->bucketFirst[bucket]; i != -1 && n < max; i = poolMgmt->listNext[i])
+                frames[n++] = i;
+        }
+    } else if (bm->strategy == RS_ARC) {
+        first = poolMgmt->t1Size > poolMgmt->arcTarget || poolMgmt->t2Size == 0 ? 0 : 1;
+        for (j = 0; j < 2; j++) {
+            for (i = lists[first ^ j]; i != -1 && n < max; i = poolMgmt->listNext[i])
+                frames[n++] = i;
+        }
+    } else {
+        // FIFO, LRU, and the LRU-K frames with fewer than k references
+        for (i = poolMgmt->listHead; i != -1 && n < max; i = poolMgmt->listNext[i])
+            frames[n++] = i;
+        // then the LRU-K heap, roughly in key order
+        if (bm->strategy == RS_LRU_K) {
+            for (j = 0; j < poolMgmt->heapSize && n < max; j++)
+                frames[n++] = poolMgmt->heap[j];
+        }
+    }
+    return n;
+}
+
+/***************************************************************
+ * Function Name: clockNs
+ *
+ * Description: return the monotonic clock in nanoseconds, for the time pins wait.
+ *
+ * Parameters: void
+ *
+ * Return: long long
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+
+static long long clockNs(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/***************************************************************
+ * Function Name: tracePin
+ *
+ * Description: add a pin of page pageNum of bm's file to the trace of the pool, if it still runs. The pin holds no shard latch.
+ *
+ * Parameters: BM_BufferPool *const bm, const PageNumber pageNum, bool hit
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
+
+static void tracePin(BM_BufferPool *const bm, const PageNumber pageNum, bool hit) {
+    BM_PoolMgmt *poolMgmt = bm->poolMgmt;
+    BM_TraceRecord *record;
+
+    pthread_mutex_lock(&poolMgmt->traceLock);
+    if (poolMgmt->traceFile != NULL) {
+        record = poolMgmt->traceBuffer + poolMgmt->traceUsed++;
+        record->timeNs = clockNs() - poolMgmt->traceStart;
+        record->pageNum = pageNum;
+        record->fileId = (short)bm->fileId;
+        record->hit = hit ? 1 : 0;
+        record->unused = 0;
+        if (poolMgmt->traceUsed == BM_TRACE_BUFFER)
+            writeTrace(poolMgmt);
+    }
+    pthread_mutex_unlock(&poolMgmt->traceLock);
+}
+
+/***************************************************************
+ * Function Name: writeTrace
+ *
+ * Description: append the trace records collected in memory to the trace file and empty the buffer. A failed write is kept in traceRC for stopPoolTrace. The caller holds traceLock.
+ *
+ * Parameters: BM_PoolMgmt *poolMgmt
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      26/10/17        agent                       Complete.
+ *
+***************************************************************/
 
-    return RC_STRATEGY_NOT_FOUND;
+static void writeTrace(BM_PoolMgmt *poolMgmt) {
+    if (poolMgmt->traceUsed > 0
+        && fwrite(poolMgmt->traceBuffer, sizeof(BM_TraceRecord), poolMgmt->traceUsed, poolMgmt->traceFile)
+           != (size_t)poolMgmt->traceUsed
+        && poolMgmt->traceRC == RC_OK)
+        poolMgmt->traceRC = RC_WRITE_FAILED;
+    poolMgmt->traceUsed = 0;
 }
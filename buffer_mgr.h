@@ -7,13 +7,17 @@
 // Include bool DT
 #include "dt.h"
 
+// Include page file handle
+#include "storage_mgr.h"
+
 // Replacement Strategies
 typedef enum ReplacementStrategy {
   RS_FIFO = 0,
   RS_LRU = 1,
   RS_CLOCK = 2,
   RS_LFU = 3,
-  RS_LRU_K = 4
+  RS_LRU_K = 4,
+  RS_ARC = 5
 } ReplacementStrategy;
 
 // Data Types and Structures
@@ -25,18 +29,101 @@ typedef struct BM_PageHandle {
   char *data;
   bool dirty; // mark whether this is a dirty page.
   int fixCounts; // count how many clients are using this page.
-  int *strategyAttribute; // record attribution for strategy, like midify time or create time.
+  long long *strategyAttribute; // record attribution for strategy, like midify time or create time.
 } BM_PageHandle;
 
+// stratData of RS_LRU_K, NULL for the defaults
+typedef struct BM_LRUKParams {
+  int k; // references remembered per page, default 2
+  int historySize; // evicted pages whose references are remembered, default numPages
+} BM_LRUKParams;
+
+#define BM_LRU_K_DEFAULT_K 2
+
+// a small set of frames private to one sequential scan. Pages the scan
+// reads through pinPageRing go into these frames, which are recycled in
+// turn, so the scan does not push the pool's other pages out. A partitioned
+// pool gives the ring numFrames frames in every shard.
+typedef struct BM_BufferRing {
+  int numFrames; // ring size per shard, at most half of the shard
+  int numShards;
+  int *numUsed; // frames taken from each shard so far
+  int *next; // ring slot recycled next in each shard
+  int *frames; // numFrames slots per shard
+} BM_BufferRing;
+
+// consecutive pages that go to the same shard of a partitioned pool
+#define BM_SHARD_PAGES 8
+
+// settings of the background writer, 0 for the defaults. Watermarks are
+// percent of the frames of each shard.
+typedef struct BM_WriterParams {
+  int intervalMs; // pause between two rounds, default 100
+  int lowWatermark; // wake up early when fewer frames are clean, default 25
+  int cleanAhead; // frames next in line for eviction kept clean, default 25
+  int maxPagesPerRound; // pages written per round at most, default 256
+} BM_WriterParams;
+
+#define BM_WRITER_INTERVAL_MS 100
+#define BM_WRITER_LOW_WATERMARK 25
+#define BM_WRITER_CLEAN_AHEAD 25
+#define BM_WRITER_MAX_PAGES 256
+
+// how the slab that holds all frames of a pool is backed
+typedef enum BM_HugePages {
+  BM_HUGE_PAGES_OFF = 0, // ordinary pages
+  BM_HUGE_PAGES_ADVISE = 1, // ask for transparent huge pages with madvise, the default
+  BM_HUGE_PAGES_ON = 2 // reserved huge pages (MAP_HUGETLB), ADVISE when none are left
+} BM_HugePages;
+
+// page files one pool serves at once: its own and those attached with
+// attachPageFile
+#define BM_MAX_FILES 64
+
+// counters of the pins of one page file, or of all files of a pool, read
+// with getPoolStats. 64-bit, they never wrap.
+typedef struct BM_PoolStats {
+  long long numPins; // numHits + numMisses
+  long long numHits; // pins that found the page cached or being read
+  long long numMisses; // pins that read the page themselves
+  long long numCleanEvictions; // pages that left their frame clean
+  long long numDirtyEvictions; // pages written back when they left their frame
+  long long numForcedFlushes; // pages written by forcePage and forceFlushPool
+  long long pinWaitNs; // time spent in pins that could not take a cached page at once
+} BM_PoolStats;
+
+// trace of the pins of a pool written by startPoolTrace: one BM_TraceHeader
+// followed by one BM_TraceRecord per pin, in the byte order of the machine
+#define BM_TRACE_MAGIC 0x52544d42 // "BMTR"
+#define BM_TRACE_VERSION 1
+
+typedef struct BM_TraceHeader {
+  int magic;
+  int version;
+  int numPages; // frames of the pool when the trace started
+  int strategy; // ReplacementStrategy of the pool
+} BM_TraceHeader;
+
+typedef struct BM_TraceRecord {
+  long long timeNs; // since startPoolTrace
+  PageNumber pageNum;
+  short fileId; // 0 for the pool's own file, the id of an attached file otherwise
+  char hit; // 1: the page was cached, 0: the pin read it
+  char unused;
+} BM_TraceRecord;
+
 typedef struct BM_BufferPool {
   char *pageFile;
+  SM_FileHandle *fh; // page file kept open for the lifetime of the pool.
+  int fileId; // 0 for the pool's own file; > 0 for a file attached with attachPageFile
   int numPages;
   ReplacementStrategy strategy;
-  BM_PageHandle *mgmtData; // use this one to store the bookkeeping info your buffer 
-                  // manager needs for a buffer pool
+  BM_PageHandle *mgmtData; // unused, NULL: the frames are kept in poolMgmt
+                  // as one slab and a struct of arrays
   int numReadIO; // the number of read from page file.                
   int numWriteIO; // the number of write from page file.                               
-  int timer; // initial is 0, use this timer to compare modify/create time.
+  long long timer; // initial is 0, use this timer to compare modify/create time. 64-bit, it never wraps.
+  struct BM_PoolMgmt *poolMgmt; // private pool state, see buffer_mgr.c
 } BM_BufferPool;
 
 
@@ -51,15 +138,46 @@ typedef struct BM_BufferPool {
 RC initBufferPool(BM_BufferPool *const bm, const char *const pageFileName, 
 		  const int numPages, ReplacementStrategy strategy, 
 		  void *stratData);
+RC initBufferPoolPartitioned(BM_BufferPool *const bm, const char *const pageFileName,
+			     const int numPages, ReplacementStrategy strategy,
+			     void *stratData, int numShards);
+RC initSharedBufferPool(BM_BufferPool *const bm, const int numPages, const int pageSize,
+			ReplacementStrategy strategy, void *stratData, int numShards);
 RC shutdownBufferPool(BM_BufferPool *const bm);
+// bm becomes the handle of another page file whose pages share the frames of pool
+RC attachPageFile(BM_BufferPool *const pool, BM_BufferPool *const bm,
+		  const char *const pageFileName);
+RC detachPageFile(BM_BufferPool *const bm);
+// grow or shrink the frames of the pool bm belongs to; no other call on the pool may run meanwhile
+RC resizeBufferPool(BM_BufferPool *const bm, const int numPages);
 RC forceFlushPool(BM_BufferPool *const bm);
+RC startBackgroundWriter(BM_BufferPool *const bm, BM_WriterParams *params);
+RC stopBackgroundWriter(BM_BufferPool *const bm);
+void setBufferPoolHugePages(BM_HugePages mode); // for pools created afterwards
 
 // Buffer Manager Interface Access Pages
+// safe to call from several threads at once
 RC markDirty (BM_BufferPool *const bm, BM_PageHandle *const page);
 RC unpinPage (BM_BufferPool *const bm, BM_PageHandle *const page);
 RC forcePage (BM_BufferPool *const bm, BM_PageHandle *const page);
 RC pinPage (BM_BufferPool *const bm, BM_PageHandle *const page, 
 	    const PageNumber pageNum);
+RC prefetchPageRange (BM_BufferPool *const bm, const PageNumber startPage,
+		      const int numPages);
+// prefetches return before the reads are done; finishPrefetches waits for them
+RC prefetchPages (BM_BufferPool *const bm, const PageNumber *pageNums,
+		  const int numPages);
+RC finishPrefetches (BM_BufferPool *const bm);
+
+// Buffer Manager Interface Scan Rings
+RC initBufferRing (BM_BufferPool *const bm, BM_BufferRing *const ring, int numFrames);
+RC freeBufferRing (BM_BufferPool *const bm, BM_BufferRing *const ring);
+RC pinPageRing (BM_BufferPool *const bm, BM_BufferRing *const ring,
+		BM_PageHandle *const page, const PageNumber pageNum);
+RC prefetchPageRangeRing (BM_BufferPool *const bm, BM_BufferRing *const ring,
+			  const PageNumber startPage, const int numPages);
+RC prefetchPagesRing (BM_BufferPool *const bm, BM_BufferRing *const ring,
+		      const PageNumber *pageNums, const int numPages);
 
 // Statistics Interface
 PageNumber *getFrameContents (BM_BufferPool *const bm);
@@ -67,12 +185,26 @@ bool *getDirtyFlags (BM_BufferPool *const bm);
 int *getFixCounts (BM_BufferPool *const bm);
 int getNumReadIO (BM_BufferPool *const bm);
 int getNumWriteIO (BM_BufferPool *const bm);
+int getNumFlushRuns (BM_BufferPool *const bm);
+int getNumFlushPages (BM_BufferPool *const bm);
+int getNumDirtyEvictions (BM_BufferPool *const bm);
+int getNumWriterRounds (BM_BufferPool *const bm);
+int getNumWriterPages (BM_BufferPool *const bm);
+// no allocation: stats and counts (numPages entries) belong to the caller
+RC getPoolStats (BM_BufferPool *const bm, BM_PoolStats *stats);
+RC getFrameAccessCounts (BM_BufferPool *const bm, long long *counts);
+// log every pin of the pool bm belongs to, until stopPoolTrace or shutdownBufferPool
+RC startPoolTrace (BM_BufferPool *const bm, const char *const traceFile);
+RC stopPoolTrace (BM_BufferPool *const bm);
 
 // Added by myself
 int strategyFIFOandLRU(BM_BufferPool *bm);
+int strategyCLOCK(BM_BufferPool *bm);
+int strategyLFU(BM_BufferPool *bm);
 //int strategyLRU(BM_BufferPool *bm);
 int strategyLRU_k(BM_BufferPool *bm);
-int *getAttributionArray(BM_BufferPool *bm);
+int strategyARC(BM_BufferPool *bm);
+long long *getAttributionArray(BM_BufferPool *bm);
 void freePagesBuffer(BM_BufferPool *bm);
 RC updataAttribute(BM_BufferPool *bm, BM_PageHandle *pageHandle);
 #endif
@@ -6,6 +6,7 @@
 
 // local functions
 static void printStrat (BM_BufferPool *const bm);
+static const char *stratName (ReplacementStrategy strategy);
 
 // external functions
 void 
@@ -51,6 +52,31 @@ sprintPoolContent (BM_BufferPool *const bm)
 }
 
 
+void
+printPoolStats (BM_BufferPool *const bm)
+{
+  char line[512];
+
+  sprintPoolStats(bm, line, sizeof(line));
+  printf("%s\n", line);
+}
+
+int
+sprintPoolStats (BM_BufferPool *const bm, char *buf, int size)
+{
+  BM_PoolStats stats;
+  const char *name = stratName(bm->strategy);
+
+  getPoolStats(bm, &stats);
+  return snprintf(buf, size,
+		  "{\"strategy\":\"%s\",\"numPages\":%i,\"pins\":%lld,\"hits\":%lld,\"misses\":%lld,"
+		  "\"hitRatio\":%.4f,\"cleanEvictions\":%lld,\"dirtyEvictions\":%lld,"
+		  "\"forcedFlushes\":%lld,\"pinWaitNs\":%lld}",
+		  name != NULL ? name : "unknown", bm->numPages, stats.numPins, stats.numHits, stats.numMisses,
+		  stats.numPins > 0 ? (double) stats.numHits / stats.numPins : 0.0,
+		  stats.numCleanEvictions, stats.numDirtyEvictions, stats.numForcedFlushes, stats.pinWaitNs);
+}
+
 void
 printPageContent (BM_PageHandle *const page)
 {
@@ -81,25 +107,32 @@ sprintPageContent (BM_PageHandle *const page)
 void
 printStrat (BM_BufferPool *const bm)
 {
-  switch (bm->strategy)
+  const char *name = stratName(bm->strategy);
+
+  if (name != NULL)
+    printf("%s", name);
+  else
+    printf("%i", bm->strategy);
+}
+
+const char *
+stratName (ReplacementStrategy strategy)
+{
+  switch (strategy)
     {
     case RS_FIFO:
-      printf("FIFO");
-      break;
+      return "FIFO";
     case RS_LRU:
-      printf("LRU");
-      break;
+      return "LRU";
     case RS_CLOCK:
-      printf("CLOCK");
-      break;
+      return "CLOCK";
     case RS_LFU:
-      printf("LFU");
-      break;
+      return "LFU";
     case RS_LRU_K:
-      printf("LRU-K");
-      break;
+      return "LRU-K";
+    case RS_ARC:
+      return "ARC";
     default:
-      printf("%i", bm->strategy);
-      break;
+      return NULL;
     }
 }
@@ -9,4 +9,9 @@ void printPageContent (BM_PageHandle *const page);
 char *sprintPoolContent (BM_BufferPool *const bm);
 char *sprintPageContent (BM_PageHandle *const page);
 
+// counters of getPoolStats as one line of JSON; sprintPoolStats writes at
+// most size bytes into buf like snprintf and allocates nothing
+void printPoolStats (BM_BufferPool *const bm);
+int sprintPoolStats (BM_BufferPool *const bm, char *buf, int size);
+
 #endif
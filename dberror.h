@@ -18,6 +18,13 @@ typedef int RC;
 #define RC_GET_NUMBER_OF_BYTES_FAILED 6 //added by myself in assign 1
 #define RC_SHUTDOWN_POOL_FAILED 7 //added by myself in assign 2
 #define RC_STRATEGY_NOT_FOUND 8 //added by myself in assign 2
+#define RC_FILE_MODE_NOT_SUPPORTED 9
+#define RC_NO_FREE_FRAME 10
+#define RC_FILE_HEADER_INVALID 11
+#define RC_PAGE_SIZE_MISMATCH 12
+#define RC_TOO_MANY_FILES 13
+#define RC_RESIZE_POOL_FAILED 14
+#define RC_MEMORY_ALLOCATION_FAILED 15
 
 #define RC_RM_COMPARE_VALUE_OF_DIFFERENT_DATATYPE 200
 #define RC_RM_EXPR_RESULT_IS_NOT_BOOLEAN 201
@@ -8,10 +8,31 @@
 #include "tables.h"
 #include "expr.h"
 
+// number of data pages a scan reads ahead of the page it is on
+#define SCAN_READ_AHEAD_PAGES 8
+
+// frames of the ring a scan reads its data pages into
+#define SCAN_RING_PAGES 32
+
+// slot size of new tables
+#define RM_SLOT_SIZE 256
+
+// frames of the pool of a table that does not fit into the shared pool
+#define RM_TABLE_POOL_PAGES 10
+
+// buffer pool of all open tables, set up by initRecordManager
+static BM_BufferPool *sharedPool = NULL;
+
+// local functions
+static void readAheadDataPages (RM_ScanHandle *scan, BM_PageHandle *dir);
+static RC readRecord (RM_TableData *rel, RID id, Record *record, BM_BufferRing *ring);
+static int slotsPerRecord (RM_TableData *rel);
+static int recordsPerPage (RM_TableData *rel);
+
 /***************************************************************
  * Function Name: initRecordManager
  *
- * Description: initial record manager
+ * Description: initial record manager and the buffer pool all open tables share. mgmtData may point to an RM_Config with the size, frame size, replacement strategy and shards of the pool; NULL gives RM_POOL_PAGES frames of PAGE_SIZE bytes, RS_LRU and one shard. The pool is sized once, until shutdownRecordManager.
  *
  * Parameters: void *mgmtData
  *
@@ -22,12 +43,36 @@
  * History:
  *      Date            Name                        Content
  *      2016/03/12      Xiaoliang Wu                Complete
+ *      2026/10/17      agent                       Create the shared buffer pool.
  *
 ***************************************************************/
 
 RC initRecordManager (void *mgmtData) {
+    RM_Config *config = (RM_Config *)mgmtData;
+    ReplacementStrategy strategy = RS_LRU;
+    int numPages = RM_POOL_PAGES, pageSize = PAGE_SIZE, numShards = 1;
+    RC RC_flag;
+
     printf("----------------------------- Initial Record Manager ---------------------------------\n");
-    return RC_OK;
+    if (sharedPool != NULL)
+        return RC_OK;
+    if (config != NULL) {
+        strategy = config->strategy;
+        if (config->numPages > 0)
+            numPages = config->numPages;
+        if (config->pageSize > 0)
+            pageSize = config->pageSize;
+        if (config->numShards > 0)
+            numShards = config->numShards;
+    }
+
+    sharedPool = MAKE_POOL();
+    RC_flag = initSharedBufferPool(sharedPool, numPages, pageSize, strategy, NULL, numShards);
+    if (RC_flag != RC_OK) {
+        free(sharedPool);
+        sharedPool = NULL;
+    }
+    return RC_flag;
 }
 
 /***************************************************************
@@ -44,11 +89,21 @@ RC initRecordManager (void *mgmtData) {
  * History:
  *      Date            Name                        Content
  *      2016/03/12      Xiaoliang Wu                Complete
+ *      2026/10/17      agent                       Shut the shared buffer pool down.
  *
 ***************************************************************/
 
 RC shutdownRecordManager () {
+    RC RC_flag;
+
     printf("-------------------------------- shutdown record manager ---------------------------------\n");
+    if (sharedPool == NULL)
+        return RC_OK;
+    RC_flag = shutdownBufferPool(sharedPool);
+    if (RC_flag != RC_OK)
+        return RC_flag;
+    free(sharedPool);
+    sharedPool = NULL;
     return RC_OK;
 }
 
@@ -67,13 +122,36 @@ RC shutdownRecordManager () {
  *      Date            Name                        Content
  *      03/19/16        Xiaoliang Wu                Complete.
  *      03/22/16        Xiaoliang Wu                Change int convert to string method.
+ *      10/16/26        agent                       Create through createTableWithOptions.
  *
 ***************************************************************/
 
 RC createTable (char *name, Schema *schema) {
+    return createTableWithOptions(name, schema, NULL);
+}
+
+/***************************************************************
+ * Function Name: createTableWithOptions
+ *
+ * Description: create a table whose page file is created with options, e.g. a larger page size for tables with wide rows. options may be NULL for the defaults.
+ *
+ * Parameters: char *name, Schema *schema, SM_FileOptions *options
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      10/16/26        agent                       Complete.
+ *
+***************************************************************/
+
+RC createTableWithOptions (char *name, Schema *schema, SM_FileOptions *options) {
     RC RC_flag;
     SM_FileHandle fh;
     SM_PageHandle ph;
+    int pageSize;
     int fileMetadataSize;
     int recordSize;
     int slotSize;
@@ -84,7 +162,7 @@ RC createTable (char *name, Schema *schema) {
     int i, j, k;
 
     // create file
-    RC_flag = createPageFile(name);
+    RC_flag = createPageFileWithOptions(name, options);
 
     if (RC_flag != RC_OK) {
         return RC_flag;
@@ -96,23 +174,24 @@ RC createTable (char *name, Schema *schema) {
     if (RC_flag != RC_OK) {
         return RC_flag;
     }
+    pageSize = fh.pageSize;
 
     // get file metadata size
     fileMetadataSize = strlen(serializeSchema(schema)) + 4 * sizeof(int);
 
-    if (fileMetadataSize % PAGE_SIZE == 0) {
-        fileMetadataSize = fileMetadataSize / PAGE_SIZE;
+    if (fileMetadataSize % pageSize == 0) {
+        fileMetadataSize = fileMetadataSize / pageSize;
     }
     else {
-        fileMetadataSize = fileMetadataSize / PAGE_SIZE + 1;
+        fileMetadataSize = fileMetadataSize / pageSize + 1;
     }
 
     // get metadata and store in file
-    slotSize = 256;
+    slotSize = RM_SLOT_SIZE;
     recordSize = (getRecordSize(schema) / (slotSize));
     recordNum = 0;
 
-    input = (char *)calloc(PAGE_SIZE, sizeof(char));
+    input = (char *)calloc(pageSize, sizeof(char));
 
     memcpy(input, &fileMetadataSize, sizeof(int));
     memcpy(input + sizeof(int), &recordSize, sizeof(int));
@@ -127,20 +206,20 @@ RC createTable (char *name, Schema *schema) {
         return RC_flag;
     }
 
-    if (strlen(charSchema) < PAGE_SIZE - 4 * sizeof(int)) {
+    if (strlen(charSchema) < pageSize - 4 * sizeof(int)) {
         memcpy(input + 4 * sizeof(int), charSchema, strlen(charSchema));
         RC_flag = writeBlock(0, &fh, input);
         free(input);
     } else {
-        memcpy(input + 4 * sizeof(int), charSchema, PAGE_SIZE - 4 * sizeof(int));
+        memcpy(input + 4 * sizeof(int), charSchema, pageSize - 4 * sizeof(int));
         RC_flag = writeBlock(0, &fh, input);
         free(input);
         for (i = 1; i < fileMetadataSize; ++i) {
-            input = (char *)calloc(PAGE_SIZE, sizeof(char));
+            input = (char *)calloc(pageSize, sizeof(char));
             if (i == fileMetadataSize - 1) {
-                memcpy(input, charSchema + i * PAGE_SIZE, strlen(charSchema + i * PAGE_SIZE));
+                memcpy(input, charSchema + i * pageSize, strlen(charSchema + i * pageSize));
             } else {
-                memcpy(input, charSchema + i * PAGE_SIZE, PAGE_SIZE);
+                memcpy(input, charSchema + i * pageSize, pageSize);
             }
             RC_flag = writeBlock(i, &fh, input);
             free(input);
@@ -176,12 +255,13 @@ RC createTable (char *name, Schema *schema) {
  * History:
  *      Date            Name                        Content
  *      03/23/16        Xiaoliang Wu                Complete.
+ *      10/17/26        agent                       Cache the table in the shared buffer pool, keep page size and slot size in rel.
  *
 ***************************************************************/
 
 RC openTable (RM_TableData *rel, char *name) {
     RC RC_flag;
-    SM_FileHandle *fh = (SM_FileHandle*)calloc(1, sizeof(SM_FileHandle));
+    SM_FileHandle *fh;
     BM_BufferPool *bm = MAKE_POOL();
     BM_PageHandle *h = MAKE_PAGE_HANDLE();
 
@@ -199,17 +279,20 @@ RC openTable (RM_TableData *rel, char *name) {
     char * flag2;
     char * temp;
 
-    // open file and initial buffer pool
-    RC_flag = openPageFile(name, fh);
-
-    if (RC_flag != RC_OK) {
-        return RC_flag;
-    }
-
-    RC_flag = initBufferPool(bm, name, 10, RS_LRU, NULL);
+    // the table's pages go into the shared pool if they fit its frames, into
+    // a pool of their own otherwise; the table uses the file handle opened
+    // by the pool
+    RC_flag = RC_PAGE_SIZE_MISMATCH;
+    if (sharedPool != NULL)
+        RC_flag = attachPageFile(sharedPool, bm, name);
+    if (RC_flag == RC_PAGE_SIZE_MISMATCH || RC_flag == RC_TOO_MANY_FILES)
+        RC_flag = initBufferPool(bm, name, RM_TABLE_POOL_PAGES, RS_LRU, NULL);
     if (RC_flag != RC_OK) {
+        free(bm);
+        free(h);
         return RC_flag;
     }
+    fh = bm->fh;
 
     // read first page, get how many page are used to store file metadata
 
@@ -342,6 +425,8 @@ RC openTable (RM_TableData *rel, char *name) {
     rel->schema = schema;
     rel->bm = bm;
     rel->fh = fh;
+    rel->pageSize = fh->pageSize;
+    rel->slotSize = getSlotSize(bm);
 
     return RC_OK;
 }
@@ -360,14 +445,23 @@ RC openTable (RM_TableData *rel, char *name) {
  * History:
  *      Date            Name                        Content
  *      03/22/16        Xiaoliang Wu                Complete;
+ *      10/17/26        agent                       The buffer pool owns the file handle, a table in the shared pool only takes its pages out.
  *
 ***************************************************************/
 
 RC closeTable (RM_TableData *rel) {
+    RC RC_flag;
+
+    // both also close rel->fh
+    if (rel->bm->fileId != 0)
+        RC_flag = detachPageFile(rel->bm);
+    else
+        RC_flag = shutdownBufferPool(rel->bm);
+    if (RC_flag != RC_OK)
+        return RC_flag;
     freeSchema(rel->schema);
-    shutdownBufferPool(rel->bm);
     free(rel->bm);
-    free(rel->fh);
+    rel->fh = NULL;
     return RC_OK;
 }
 
@@ -433,13 +527,15 @@ int getNumTuples (RM_TableData *rel) {
  * History:
  *      Date            Name                        Content
  *   2016/3/27      Xincheng Yang             first time to implement the function
+ *   2026/10/16     agent                     page and slot size from rel, a page is full after recordsPerPage records
  *
 ***************************************************************/
 RC insertRecord (RM_TableData *rel, Record *record) {
     BM_PageHandle *h = MAKE_PAGE_HANDLE();
     int r_size = getRecordSize(rel->schema);
     int p_mata_index = getFileMetaDataSize(rel->bm);
-    int r_slotnum = (r_size + sizeof(bool)) / 256 + 1;
+    int r_slotnum = slotsPerRecord(rel);
+    int r_max_num = recordsPerPage(rel);
     int offset = 0;
     int r_current_num, numTuples;
     bool r_stat = true;
@@ -447,7 +543,7 @@ RC insertRecord (RM_TableData *rel, Record *record) {
     // Find out the target page and slot at the end.
     do {
         pinPage(rel->bm, h, p_mata_index);
-        memcpy(&p_mata_index, h->data + PAGE_SIZE - sizeof(int), sizeof(int));
+        memcpy(&p_mata_index, h->data + rel->pageSize - sizeof(int), sizeof(int));
         if(p_mata_index != -1){
             unpinPage(rel->bm, h);
         } else {
@@ -459,13 +555,13 @@ RC insertRecord (RM_TableData *rel, Record *record) {
     do {
         memcpy(&r_current_num, h->data + offset + sizeof(int), sizeof(int));
         offset += 2*sizeof(int);
-    } while (r_current_num == PAGE_SIZE / 256);
+    } while (r_current_num == r_max_num);
 
     // If no page exist, add new page.
     if(r_current_num == -1){       
         // If page mata is full, add new matadata block.
-        if(offset == PAGE_SIZE){       
-            memcpy(h->data + PAGE_SIZE - sizeof(int), &rel->fh->totalNumPages, sizeof(int));   // Link into new meta data page. 
+        if(offset == rel->pageSize){       
+            memcpy(h->data + rel->pageSize - sizeof(int), &rel->fh->totalNumPages, sizeof(int));   // Link into new meta data page. 
             addPageMetadataBlock(rel->fh);
             markDirty(rel->bm, h);
             unpinPage(rel->bm, h);      // Unpin the last meta page.
@@ -487,8 +583,8 @@ RC insertRecord (RM_TableData *rel, Record *record) {
 
     // Insert record header and record data into page.
     pinPage(rel->bm, h, record->id.page);
-    memcpy(h->data + 256*record->id.slot, &r_stat, sizeof(bool));   // Record header is a del_flag 
-    memcpy(h->data + 256*record->id.slot + sizeof(bool), record->data, r_size); // Record body is values.
+    memcpy(h->data + rel->slotSize*record->id.slot, &r_stat, sizeof(bool));   // Record header is a del_flag 
+    memcpy(h->data + rel->slotSize*record->id.slot + sizeof(bool), record->data, r_size); // Record body is values.
     markDirty(rel->bm, h);
     unpinPage(rel->bm, h);
     // Tuple number add 1.
@@ -517,6 +613,7 @@ RC insertRecord (RM_TableData *rel, Record *record) {
  * History:
  *      Date            Name                        Content
  *   2016/3/27      Xincheng Yang             first time to implement the function
+ *   2026/10/16     agent                     slot size from rel
  *
 ***************************************************************/
 RC deleteRecord (RM_TableData *rel, RID id) {
@@ -527,7 +624,7 @@ RC deleteRecord (RM_TableData *rel, RID id) {
     
     // Delete record and mark record status as false(calloc 0).
     pinPage(rel->bm, h, id.page);
-    memcpy(h->data + 256*id.slot, r_deleted, sizeof(bool) + r_size);
+    memcpy(h->data + rel->slotSize*id.slot, r_deleted, sizeof(bool) + r_size);
     markDirty(rel->bm, h);
     unpinPage(rel->bm, h);
     
@@ -558,6 +655,7 @@ RC deleteRecord (RM_TableData *rel, RID id) {
  * History:
  *      Date            Name                        Content
  *   2016/3/27      Xincheng Yang             first time to implement the function
+ *   2026/10/16     agent                     slot size from rel
  *
 ***************************************************************/
 RC updateRecord (RM_TableData *rel, Record *record) {
@@ -565,7 +663,7 @@ RC updateRecord (RM_TableData *rel, Record *record) {
     int r_size = getRecordSize(rel->schema);
     
     pinPage(rel->bm, h, record->id.page);
-    memcpy(h->data + 256*record->id.slot + sizeof(bool), record->data, r_size);
+    memcpy(h->data + rel->slotSize*record->id.slot + sizeof(bool), record->data, r_size);
     markDirty(rel->bm, h);
     unpinPage(rel->bm, h);
     
@@ -587,24 +685,46 @@ RC updateRecord (RM_TableData *rel, Record *record) {
  * History:
  *      Date            Name                        Content
  *   2016/3/27      Xincheng Yang             first time to implement the function
+ *   2026/10/16     agent                     the work moved to readRecord
  *
 ***************************************************************/
 RC getRecord (RM_TableData *rel, RID id, Record *record) {
+    return readRecord(rel, id, record, NULL);
+}
+
+/***************************************************************
+ * Function Name: readRecord
+ *
+ * Description: get a record by id like getRecord, reading its page through the scan ring ring if it is not NULL
+ *
+ * Parameters: RM_TableData *rel, RID id, Record *record, BM_BufferRing *ring
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *   2026/10/16     agent                     Complete.
+ *
+***************************************************************/
+static RC readRecord (RM_TableData *rel, RID id, Record *record, BM_BufferRing *ring) {
     BM_PageHandle *h = MAKE_PAGE_HANDLE();
     int r_size = getRecordSize(rel->schema);
     bool r_stat;
     
     record->id = id;
-    pinPage(rel->bm, h, id.page);
+    pinPageRing(rel->bm, ring, h, id.page);
 
     // If the record status not valid.(not exist or wrong status or deleted)
-    memcpy(&r_stat, h->data + 256*id.slot, sizeof(bool));
+    memcpy(&r_stat, h->data + rel->slotSize*id.slot, sizeof(bool));
     if(r_stat != true){
+        unpinPage(rel->bm, h);
         free(h);
         return RC_RM_RECORD_NOT_EXIST;
     } else {
         record->data = (char*) malloc(r_size);
-        memcpy(record->data, h->data + 256*id.slot + sizeof(bool), r_size);
+        memcpy(record->data, h->data + rel->slotSize*id.slot + sizeof(bool), r_size);
         unpinPage(rel->bm, h);
         free(h);
         return RC_OK;
@@ -625,15 +745,30 @@ RC getRecord (RM_TableData *rel, RID id, Record *record) {
  * History:
  *      Date            Name                        Content
  *03/26/2016    liu zhipeng             first time to implement the function
+ *10/16/2026    agent                   data pages go through a ring of frames kept in mgmtData
 ***************************************************************/
 
 RC startScan (RM_TableData *rel, RM_ScanHandle *scan, Expr *cond)
 {
+    RC RC_flag;
+
     scan->rel=rel;
     scan->currentPage=0;
     scan->currentSlot=0;
     scan->expr=cond;
-    return RC_OK;
+    scan->mgmtData=malloc(sizeof(BM_BufferRing));
+    if(scan->mgmtData==NULL)
+    {
+        return RC_MEMORY_ALLOCATION_FAILED;
+    }
+    RC_flag=initBufferRing(rel->bm,(BM_BufferRing *)scan->mgmtData,SCAN_RING_PAGES);
+    if(RC_flag!=RC_OK)
+    {
+        // closeScan must not free a ring that was never set up
+        free(scan->mgmtData);
+        scan->mgmtData=NULL;
+    }
+    return RC_flag;
 }
 
 /***************************************************************
@@ -650,11 +785,12 @@ RC startScan (RM_TableData *rel, RM_ScanHandle *scan, Expr *cond)
  * History:
  *      Date            Name                        Content
  *03/26/2016    liu zhipeng             design the outline of the function
+ *10/16/2026    agent                   read data pages through the scan's ring and read ahead, walk every directory entry
 ***************************************************************/
 
 RC next (RM_ScanHandle *scan, Record *record) 
 {
-    int index,maxslot,rpage,trs,rc;
+    int index,maxslot,rpage,trs,rc,entries;
     BM_BufferPool *tmpbm;
     tmpbm=scan->rel->bm;
     BM_PageHandle *ph=(BM_PageHandle*)calloc(1,sizeof(BM_PageHandle));
@@ -665,23 +801,26 @@ RC next (RM_ScanHandle *scan, Record *record)
 
 
 //printf("ceshi : %s\n",scan->rel->name);
-    trs=(getRecordSize (scan->rel->schema)+sizeof(bool))/256+1;
+    trs=slotsPerRecord(scan->rel);
     index=getFileMetaDataSize(tmpbm);
+    entries=scan->rel->pageSize/(2*sizeof(int))-1; // last entry links the next directory page
     
     pinPage(tmpbm,ph,index);
 
-    while(scan->currentPage!=index)
+    while(scan->currentPage<entries)
     {
         memcpy(&rpage,ph->data+(scan->currentPage)*2*sizeof(int),sizeof(int));
         memcpy(&maxslot, ph->data + ((scan->currentPage) *2+1)* sizeof(int), sizeof(int));
         int i;
         if(maxslot!=-1)
         {
+            if(scan->currentSlot==0)
+                readAheadDataPages(scan,ph);
             for(i=scan->currentSlot;i<maxslot;i++)
             {
                 rid.page=rpage;
                 rid.slot=i*trs;
-                if((rc=getRecord(scan->rel,rid,tmp))==RC_OK)
+                if((rc=readRecord(scan->rel,rid,tmp,(BM_BufferRing *)scan->mgmtData))==RC_OK)
                 {   
                     evalExpr (tmp, scan->rel->schema, scan->expr,&result);;
                     if(result->v.boolV)
@@ -713,6 +852,7 @@ RC next (RM_ScanHandle *scan, Record *record)
             return RC_RM_NO_MORE_TUPLES;
         }
         scan->currentPage++;
+        scan->currentSlot=0;
     }
     unpinPage (tmpbm, ph);
     free(ph);
@@ -733,13 +873,19 @@ RC next (RM_ScanHandle *scan, Record *record)
  * History:
  *      Date            Name                        Content
  * 03/19/2016    liuzhipeng first time to implement the function
+ * 10/16/2026    agent give the scan's ring back to the pool
 ***************************************************************/
 
 RC closeScan (RM_ScanHandle *scan)
 {
     //free(scan->rel);
-    //free(scan->mgmtData);
     //free(scan);
+    if(scan->mgmtData!=NULL)
+    {
+        freeBufferRing(scan->rel->bm,(BM_BufferRing *)scan->mgmtData);
+        free(scan->mgmtData);
+        scan->mgmtData=NULL;
+    }
 
     return RC_OK;
 }
@@ -1032,6 +1178,7 @@ RC setAttr (Record *record, Schema *schema, int attrNum, Value *value) {
  * History:
  *      Date            Name                        Content
  *      03/22/16        Xiaoliang Wu                Complete.
+ *      10/16/26        agent                       Directory entries per page from the file's page size.
  *
 ***************************************************************/
 RC addPageMetadataBlock(SM_FileHandle *fh) {
@@ -1048,9 +1195,9 @@ RC addPageMetadataBlock(SM_FileHandle *fh) {
     }
 
 
-    pageMetadataNum = PAGE_SIZE / (2*sizeof(int));
+    pageMetadataNum = fh->pageSize / (2*sizeof(int));
 
-    pageMetadataInput = (char *)calloc(PAGE_SIZE, sizeof(char));
+    pageMetadataInput = (char *)calloc(fh->pageSize, sizeof(char));
     pageNum = fh->totalNumPages;
     capacity = -1;
 
@@ -1153,3 +1300,77 @@ int getSlotSize(BM_BufferPool *bm) {
     free(h);
     return slotSize;
 }
+
+/***************************************************************
+ * Function Name: readAheadDataPages
+ *
+ * Description: before a scan starts on a data page, look up the following entries of the page directory and prefetch the next SCAN_READ_AHEAD_PAGES data pages, wherever they are in the file. The reads run in the background while the scan works on the current page.
+ *
+ * Parameters: RM_ScanHandle *scan, BM_PageHandle *dir
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      10/16/26        agent                       Complete.
+ *
+***************************************************************/
+
+static void readAheadDataPages(RM_ScanHandle *scan, BM_PageHandle *dir) {
+    int entriesPerPage = scan->rel->pageSize / (2 * sizeof(int)) - 1; // last entry links the next directory page
+    PageNumber pageNums[SCAN_READ_AHEAD_PAGES];
+    int numPages, numRecords;
+
+    for (numPages = 0; numPages < SCAN_READ_AHEAD_PAGES; ++numPages) {
+        if (scan->currentPage + numPages >= entriesPerPage) break;
+        memcpy(pageNums + numPages, dir->data + (scan->currentPage + numPages) * 2 * sizeof(int), sizeof(int));
+        memcpy(&numRecords, dir->data + ((scan->currentPage + numPages) * 2 + 1) * sizeof(int), sizeof(int));
+        if (numRecords == -1) break;
+    }
+
+    prefetchPagesRing(scan->rel->bm, (BM_BufferRing *)scan->mgmtData, pageNums, numPages);
+}
+
+/***************************************************************
+ * Function Name: slotsPerRecord
+ *
+ * Description: number of slots one record takes, including its deleted flag.
+ *
+ * Parameters: RM_TableData *rel
+ *
+ * Return: int
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      10/16/26        agent                       Complete.
+ *
+***************************************************************/
+
+static int slotsPerRecord(RM_TableData *rel) {
+    return (getRecordSize(rel->schema) + sizeof(bool)) / rel->slotSize + 1;
+}
+
+/***************************************************************
+ * Function Name: recordsPerPage
+ *
+ * Description: number of records that fit on one data page of the table.
+ *
+ * Parameters: RM_TableData *rel
+ *
+ * Return: int
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      10/16/26        agent                       Complete.
+ *
+***************************************************************/
+
+static int recordsPerPage(RM_TableData *rel) {
+    return rel->pageSize / (rel->slotSize * slotsPerRecord(rel));
+}
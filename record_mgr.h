@@ -15,10 +15,24 @@ typedef struct RM_ScanHandle
   void *mgmtData;
 } RM_ScanHandle;
 
+// mgmtData of initRecordManager, NULL for the defaults. The open tables
+// share one buffer pool; a table whose pages do not fit into its frames
+// gets a pool of its own.
+typedef struct RM_Config
+{
+  int numPages; // frames of the shared pool, 0: RM_POOL_PAGES
+  int pageSize; // bytes per frame, 0: PAGE_SIZE
+  ReplacementStrategy strategy;
+  int numShards; // 0: one shard
+} RM_Config;
+
+#define RM_POOL_PAGES 64
+
 // table and manager
 extern RC initRecordManager (void *mgmtData);
 extern RC shutdownRecordManager ();
 extern RC createTable (char *name, Schema *schema);
+extern RC createTableWithOptions (char *name, Schema *schema, SM_FileOptions *options);
 extern RC openTable (RM_TableData *rel, char *name);
 extern RC closeTable (RM_TableData *rel);
 extern RC deleteTable (char *name);
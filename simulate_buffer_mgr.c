@@ -0,0 +1,227 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dberror.h"
+#include "storage_mgr.h"
+#include "buffer_mgr.h"
+
+// simulator parameters
+#define SIM_FILE "simulate_buffer_%i.bin" // scratch page file per file id of the trace
+#define SIM_MIN_FRAMES 4
+#define SIM_LFU_AGING 10 // LFU halves its counts every SIM_LFU_AGING * frames references
+
+// simulator methods
+static void simulate (BM_TraceRecord *trace, int n, int fileId, int maxFrames);
+static void replay (BM_TraceRecord *trace, int n, int fileId, int numFrames,
+		    ReplacementStrategy strategy, BM_PoolStats *stats);
+
+// helper methods
+static BM_TraceRecord *readTrace (char *fileName, BM_TraceHeader *header, int *n);
+static int countPages (BM_TraceRecord *trace, int n, int fileId);
+
+static ReplacementStrategy strategies[] = { RS_FIFO, RS_LRU, RS_CLOCK, RS_LFU, RS_LRU_K, RS_ARC };
+static char *names[] = { "FIFO", "LRU", "CLOCK", "LFU", "LRU-K", "ARC" };
+static bool usedFiles[BM_MAX_FILES];
+
+// main method: replay a trace written by startPoolTrace against every
+// replacement strategy at pool sizes from SIM_MIN_FRAMES up to the pages the
+// trace touches, or up to maxFrames
+int
+main (int argc, char *argv[])
+{
+  BM_TraceHeader header;
+  BM_TraceRecord *trace;
+  char fileName[64];
+  int maxFrames, numFiles, hits;
+  int n, i;
+
+  if (argc < 2)
+    {
+      printf("usage: %s trace [maxFrames]\n", argv[0]);
+      return 1;
+    }
+  trace = readTrace(argv[1], &header, &n);
+  maxFrames = argc > 2 ? atoi(argv[2]) : 0;
+
+  hits = 0;
+  for (i = 0; i < n; i++)
+    {
+      usedFiles[trace[i].fileId] = TRUE;
+      hits += trace[i].hit;
+    }
+  printf("%i pins of %i pages in %.1f s, recorded with %s and %i frames: hit ratio %.1f%%\n",
+	 n, countPages(trace, n, -1), n > 0 ? trace[n - 1].timeNs / 1e9 : 0.0,
+	 header.strategy >= RS_FIFO && header.strategy <= RS_ARC ? names[header.strategy] : "?",
+	 header.numPages, n > 0 ? 100.0 * hits / n : 0.0);
+
+  // the pages only need to exist; the files stay sparse
+  setPreallocationLimit(0);
+  numFiles = 0;
+  for (i = 0; i < BM_MAX_FILES; i++)
+    if (usedFiles[i])
+      {
+	sprintf(fileName, SIM_FILE, i);
+	CHECK(createPageFile(fileName));
+	numFiles++;
+      }
+
+  simulate(trace, n, -1, maxFrames);
+  // each file on its own, as if it had a pool of its own
+  for (i = 0; numFiles > 1 && i < BM_MAX_FILES; i++)
+    if (usedFiles[i])
+      simulate(trace, n, i, maxFrames);
+
+  for (i = 0; i < BM_MAX_FILES; i++)
+    if (usedFiles[i])
+      {
+	sprintf(fileName, SIM_FILE, i);
+	CHECK(destroyPageFile(fileName));
+      }
+  setPreallocationLimit(SM_DEFAULT_PREALLOC_PAGES);
+  free(trace);
+  return 0;
+}
+
+// ************************************************************
+// hit ratio curve of every strategy for the pins of file fileId, -1 for all
+// files: pool sizes double from SIM_MIN_FRAMES, the last one holds every
+// page the trace touches
+static void
+simulate (BM_TraceRecord *trace, int n, int fileId, int maxFrames)
+{
+  BM_PoolStats stats;
+  int numPages = countPages(trace, n, fileId);
+  int frames, k;
+
+  if (maxFrames <= 0 || maxFrames > numPages)
+    maxFrames = numPages;
+  if (maxFrames < 1)
+    return;
+
+  if (fileId == -1)
+    printf("\nhit ratio, all files, %i pages\n", numPages);
+  else
+    printf("\nhit ratio, file %i, %i pages\n", fileId, numPages);
+  printf("%8s", "frames");
+  for (k = 0; k < (int) (sizeof(strategies) / sizeof(strategies[0])); k++)
+    printf(" %7s", names[k]);
+  printf("\n");
+
+  frames = maxFrames < SIM_MIN_FRAMES ? maxFrames : SIM_MIN_FRAMES;
+  for (;;)
+    {
+      printf("%8i", frames);
+      for (k = 0; k < (int) (sizeof(strategies) / sizeof(strategies[0])); k++)
+	{
+	  replay(trace, n, fileId, frames, strategies[k], &stats);
+	  printf(" %6.1f%%", stats.numPins > 0 ? 100.0 * stats.numHits / stats.numPins : 0.0);
+	}
+      printf("\n");
+      if (frames == maxFrames)
+	break;
+      frames = frames * 2 < maxFrames ? frames * 2 : maxFrames;
+    }
+}
+
+// ************************************************************
+// pin and unpin the pages of the trace in a pool of numFrames frames that
+// caches one scratch file per file id of the trace
+static void
+replay (BM_TraceRecord *trace, int n, int fileId, int numFrames,
+	ReplacementStrategy strategy, BM_PoolStats *stats)
+{
+  BM_BufferPool *pool = MAKE_POOL();
+  BM_BufferPool *views[BM_MAX_FILES];
+  BM_PageHandle h;
+  char *fileNames[BM_MAX_FILES];
+  int agingInterval = SIM_LFU_AGING * numFrames;
+  int i;
+
+  CHECK(initSharedBufferPool(pool, numFrames, PAGE_SIZE, strategy,
+			     strategy == RS_LFU ? &agingInterval : NULL, 1));
+  for (i = 0; i < BM_MAX_FILES; i++)
+    {
+      views[i] = NULL;
+      if (!usedFiles[i] || (fileId != -1 && i != fileId))
+	continue;
+      fileNames[i] = (char *) malloc(64);
+      sprintf(fileNames[i], SIM_FILE, i);
+      views[i] = MAKE_POOL();
+      CHECK(attachPageFile(pool, views[i], fileNames[i]));
+    }
+
+  for (i = 0; i < n; i++)
+    {
+      if (views[trace[i].fileId] == NULL)
+	continue;
+      CHECK(pinPage(views[trace[i].fileId], &h, trace[i].pageNum));
+      CHECK(unpinPage(views[trace[i].fileId], &h));
+    }
+  CHECK(getPoolStats(pool, stats));
+
+  for (i = 0; i < BM_MAX_FILES; i++)
+    if (views[i] != NULL)
+      {
+	CHECK(detachPageFile(views[i]));
+	free(views[i]);
+	free(fileNames[i]);
+      }
+  CHECK(shutdownBufferPool(pool));
+  free(pool);
+}
+
+// ************************************************************
+// read the header and all records of a trace
+static BM_TraceRecord *
+readTrace (char *fileName, BM_TraceHeader *header, int *n)
+{
+  BM_TraceRecord *trace;
+  FILE *file = fopen(fileName, "rb");
+  long size;
+
+  if (file == NULL || fread(header, sizeof(BM_TraceHeader), 1, file) != 1
+      || header->magic != BM_TRACE_MAGIC || header->version != BM_TRACE_VERSION)
+    {
+      printf("%s is not a buffer pool trace\n", fileName);
+      exit(1);
+    }
+  fseek(file, 0, SEEK_END);
+  size = ftell(file) - (long) sizeof(BM_TraceHeader);
+  fseek(file, sizeof(BM_TraceHeader), SEEK_SET);
+
+  *n = (int) (size / sizeof(BM_TraceRecord));
+  trace = (BM_TraceRecord *) malloc((*n > 0 ? *n : 1) * sizeof(BM_TraceRecord));
+  *n = (int) fread(trace, sizeof(BM_TraceRecord), *n, file);
+  fclose(file);
+  return trace;
+}
+
+// ************************************************************
+// distinct pages of file fileId in the trace, -1 for all files
+static int
+countPages (BM_TraceRecord *trace, int n, int fileId)
+{
+  char *seen[BM_MAX_FILES];
+  int maxPage[BM_MAX_FILES];
+  int count = 0;
+  int i;
+
+  for (i = 0; i < BM_MAX_FILES; i++)
+    maxPage[i] = -1;
+  for (i = 0; i < n; i++)
+    if (trace[i].pageNum > maxPage[trace[i].fileId])
+      maxPage[trace[i].fileId] = trace[i].pageNum;
+  for (i = 0; i < BM_MAX_FILES; i++)
+    seen[i] = (char *) calloc(maxPage[i] + 1, 1);
+
+  for (i = 0; i < n; i++)
+    if ((fileId == -1 || trace[i].fileId == fileId) && !seen[trace[i].fileId][trace[i].pageNum])
+      {
+	seen[trace[i].fileId][trace[i].pageNum] = 1;
+	count++;
+      }
+
+  for (i = 0; i < BM_MAX_FILES; i++)
+    free(seen[i]);
+  return count;
+}
@@ -1,12 +1,93 @@
+#define _GNU_SOURCE
+#define _FILE_OFFSET_BITS 64
 #include <stdio.h> 
 #include <stdlib.h> 
 #include <fcntl.h> 
+#include <unistd.h> 
 #include <sys/types.h> 
 #include <sys/stat.h> 
+#include <sys/mman.h> 
+#include <sys/uio.h> 
 #include <errno.h> 
 #include <string.h> 
 #include <limits.h> 
+#include <stdint.h> 
 #include "storage_mgr.h" 
+#include "dt.h" 
+
+/************************************************************
+ *                    private data structures               *
+ ************************************************************/
+// size of the header block in front of page 0. It keeps the pages aligned
+// for SM_MODE_DIRECT.
+#define SM_HEADER_SIZE 4096
+#define SM_HEADER_MAGIC "SMPGFILE"
+#define SM_HEADER_VERSION 1
+
+// pages written per pwrite when a file system without fallocate grows a file
+#define SM_ZERO_WRITE_PAGES 64
+
+// stored at offset 0 of the page file, the first segment of segmented files
+typedef struct SM_FileHeader {
+  char magic[8];
+  int version;
+  int pageSize;
+  int segmentPages; // pages per segment file, 0: all pages in one file
+  int freeListHead; // first trunk page of the free-page list, valid while freePageCount > 0
+  int freePageCount; // pages on the free-page list, trunk pages included
+} SM_FileHeader;
+
+// a trunk page of the free-page list: the next trunk page (-1 for the last
+// one), the number of leaf pages it records and their page numbers. Leaf
+// pages hold no data.
+#define SM_TRUNK_NEXT 0
+#define SM_TRUNK_COUNT 1
+#define SM_TRUNK_LEAVES 2
+
+// kept in SM_FileHandle->mgmtInfo between openPageFile and closePageFile
+typedef struct SM_FileMgmt {
+  int *fds; // one descriptor per segment, -1 until the segment is first used
+  int numSegments; // length of fds
+  int segmentPages; // from the header, 0 for a single file
+  int openFlags; // flags every segment is opened with
+  char *fileName; // copy of the name the segment names are derived from
+  int pageSize; // from the header
+  off_t headerSize; // SM_HEADER_SIZE, 0 for files written before the header
+  SM_FileMode mode; // how pages are moved between the file and memory
+  char *map; // SM_MODE_MMAP: shared mapping of the whole file, NULL while empty
+  size_t mapSize; // SM_MODE_MMAP: length of map in bytes
+  SM_PageHandle bounce; // SM_MODE_DIRECT: aligned copy of caller pages that are not aligned
+  int freeListHead; // free-page list, written back to the header on every change
+  int freePageCount;
+} SM_FileMgmt;
+
+#define FILE_MGMT(fHandle) ((SM_FileMgmt *)(fHandle)->mgmtInfo)
+#define IS_IO_ALIGNED(memPage) (((uintptr_t)(memPage)) % SM_IO_ALIGNMENT == 0)
+
+// mode used by openPageFile
+static SM_FileMode defaultFileMode = SM_MODE_PREAD;
+
+// largest extent growFile preallocates at once, 0 turns preallocation off
+static int preallocLimit = SM_DEFAULT_PREALLOC_PAGES;
+
+// give the blocks of freed leaf pages back to the file system
+static bool punchFreePages = false;
+
+static RC readPage (SM_FileHandle *fHandle, int pageNum, SM_PageHandle memPage);
+static RC writePage (SM_FileHandle *fHandle, int pageNum, SM_PageHandle memPage);
+static RC transferPages (SM_FileHandle *fHandle, int startPage, int count, SM_PageHandle *memPages, bool write);
+static bool allAligned (SM_PageHandle *memPages, int count);
+static RC growFile (SM_FileHandle *fHandle, int numberOfPages);
+static bool preallocate (SM_FileHandle *fHandle, int numberOfPages);
+static RC writeZeroPages (SM_FileHandle *fHandle, int fd, int fromPage, int toPage);
+static RC remapFile (SM_FileMgmt *mgmt, size_t size);
+static int segmentOf (SM_FileMgmt *mgmt, int pageNum);
+static off_t pageOffset (SM_FileMgmt *mgmt, int pageNum);
+static int segmentFd (SM_FileHandle *fHandle, int segment, bool create);
+static char *segmentFileName (char *fileName, int segment);
+static bool validPageSize (int pageSize);
+static RC transferRun (SM_FileMgmt *mgmt, int fd, off_t offset, int count, SM_PageHandle *memPages, bool write);
+static RC writeHeader (SM_FileHandle *fHandle);
 
 /************************************************************
  *                    handle data structures                *
@@ -99,32 +180,82 @@ void initStorageManager(void){
  *      Date            Name                        Content
  *      --------------  --------------------------  ----------------
  *      2016/02/07      Xiaoliang Wu                implement function
+ *      2026/10/16      agent                       create through createPageFileWithOptions
  *
 ***************************************************************/
 
 
 RC createPageFile(char *fileName){
+    return createPageFileWithOptions(fileName, NULL);
+}
+
+/***************************************************************
+ * Function Name: createPageFileWithOptions
+ * 
+ * Description: Create a new page file with one empty page. The file starts with a header block that records the layout: options->pageSize chooses the page size (a power of two from SM_MIN_PAGE_SIZE to SM_MAX_PAGE_SIZE, 0 for PAGE_SIZE); with options->segmentPages > 0 the pages are spread over segment files fileName, fileName.1, fileName.2, ... of that many pages each. Segment files left over from an earlier file of the same name are removed. options may be NULL for the defaults.
+ *
+ * Parameters: char *fileName, SM_FileOptions *options
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+
+
+RC createPageFileWithOptions(char *fileName, SM_FileOptions *options){
     FILE *fp;
-    char fill[PAGE_SIZE];
-    int write_result;
+    SM_FileHeader header;
+    char *fill;
+    char *name;
+    size_t fillSize;
+    size_t write_result;
+    int segment;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SM_HEADER_MAGIC, sizeof(header.magic));
+    header.version = SM_HEADER_VERSION;
+    header.freeListHead = -1;
+    header.pageSize = options != NULL && options->pageSize != 0 ? options->pageSize : PAGE_SIZE;
+    header.segmentPages = options != NULL ? options->segmentPages : 0;
+    if(header.segmentPages < 0 || !validPageSize(header.pageSize)){
+        return RC_CREATE_FILE_FAIL;
+    }
 
     fp = fopen(fileName,"w+");
 
     if(fp == NULL){
-        fclose(fp);
         return RC_CREATE_FILE_FAIL;
     }
 
-    memset(fill, '\0', sizeof(fill));
-    write_result = fwrite(fill, 1, PAGE_SIZE, fp);
+    // header block and one empty page
+    fillSize = SM_HEADER_SIZE + header.pageSize;
+    fill = (char *)calloc(fillSize, sizeof(char));
+    memcpy(fill, &header, sizeof(header));
+    write_result = fwrite(fill, 1, fillSize, fp);
+    free(fill);
 
-    if(write_result != PAGE_SIZE){
+    if(write_result != fillSize){
         fclose(fp);
         destroyPageFile(fileName);
         return RC_CREATE_FILE_FAIL;
     }
 
     fclose(fp);
+
+    // stale segments would be taken for pages of the new file
+    for(segment = 1; ; segment++){
+        name = segmentFileName(fileName, segment);
+        write_result = remove(name);
+        free(name);
+        if(write_result != 0){
+            break;
+        }
+    }
     return RC_OK;
 }
 
@@ -142,47 +273,313 @@ RC createPageFile(char *fileName){
  * History:
  *      Date            Name                        Content
  *      2016/02/07      Xiaoliang Wu                implement function
+ *      2026/10/16      agent                       keep the file descriptor open in mgmtInfo, open with the default file mode
  *
 ***************************************************************/
 
 
 RC openPageFile (char *fileName, SM_FileHandle *fHandle){
-    FILE *fp;
-    int size;
-    int seek_result;
+    return openPageFileWithMode(fileName, fHandle, defaultFileMode);
+}
+
+/***************************************************************
+ * Function Name: openPageFileWithMode
+ * 
+ * Description: Opens an existing page file. In SM_MODE_MMAP the whole file is mapped and pages are copied into and out of the mapping. In SM_MODE_DIRECT the file is opened with O_DIRECT so pages bypass the kernel page cache. A file that does not start with the header magic was written before page files had a header and is opened with the old layout: PAGE_SIZE pages from offset 0, one file, no free-page list. A header with the magic must be valid; the segment files of a segmented page file are opened when first used, memory mapping is not available for them.
+ *
+ * Parameters: char *fileName, SM_FileHandle *fHandle, SM_FileMode mode
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
 
-    fp = fopen(fileName, "r");
 
-    if(fp == NULL){
+RC openPageFileWithMode (char *fileName, SM_FileHandle *fHandle, SM_FileMode mode){
+    SM_FileMgmt *mgmt;
+    SM_FileHeader header;
+    struct stat st;
+    char *headerBlock;
+    char *name;
+    off_t dataSize, headerSize;
+    ssize_t n;
+    int fd, flags;
+    int numSegments;
+    int totalNumPages, physicalNumPages;
+
+    if(mode != SM_MODE_PREAD && mode != SM_MODE_MMAP && mode != SM_MODE_DIRECT){
+        return RC_FILE_MODE_NOT_SUPPORTED;
+    }
+
+    flags = mode == SM_MODE_DIRECT ? O_RDWR | O_DIRECT : O_RDWR;
+    fd = open(fileName, flags);
+
+    if(fd == -1){
+        // the file system does not support O_DIRECT
+        if(errno == EINVAL){
+            return RC_FILE_MODE_NOT_SUPPORTED;
+        }
         return RC_FILE_NOT_FOUND;
     }
 
-    seek_result = fseek(fp, 0, SEEK_END);
+    // the header is read into an aligned block so this also works with O_DIRECT
+    if(posix_memalign((void **)&headerBlock, SM_IO_ALIGNMENT, SM_HEADER_SIZE) != 0){
+        close(fd);
+        return RC_FILE_NOT_FOUND;
+    }
+    n = pread(fd, headerBlock, SM_HEADER_SIZE, 0);
+    memcpy(&header, headerBlock, sizeof(header));
+    free(headerBlock);
+    headerSize = SM_HEADER_SIZE;
+    if(n >= 0 && (n < (ssize_t)sizeof(header.magic) || memcmp(header.magic, SM_HEADER_MAGIC, sizeof(header.magic)) != 0)){
+        // written before the header: page 0 starts at offset 0
+        memset(&header, 0, sizeof(header));
+        header.pageSize = PAGE_SIZE;
+        headerSize = 0;
+    } else if(n != SM_HEADER_SIZE || header.version != SM_HEADER_VERSION || !validPageSize(header.pageSize)
+              || header.segmentPages < 0 || header.freePageCount < 0){
+        close(fd);
+        return RC_FILE_HEADER_INVALID;
+    }
+    // a segmented file is mapped segment by segment, which SM_MODE_MMAP does not do
+    if(mode == SM_MODE_MMAP && header.segmentPages > 0){
+        close(fd);
+        return RC_FILE_MODE_NOT_SUPPORTED;
+    }
 
-    if(seek_result != 0){
-        fclose(fp);
+    // segments are only counted here, each is opened on first use
+    numSegments = 1;
+    if(header.segmentPages > 0){
+        while(true){
+            name = segmentFileName(fileName, numSegments);
+            n = stat(name, &st);
+            free(name);
+            if(n != 0){
+                break;
+            }
+            numSegments++;
+        }
+        if(numSegments > 1){
+            name = segmentFileName(fileName, numSegments - 1);
+            n = stat(name, &st);
+            free(name);
+        } else {
+            n = fstat(fd, &st);
+        }
+    } else {
+        n = fstat(fd, &st);
+    }
+    if(n != 0){
+        close(fd);
         return RC_GET_NUMBER_OF_BYTES_FAILED;
     }
 
-    size = ftell(fp);
-    if(size == -1){
-        fclose(fp);
-        return RC_GET_NUMBER_OF_BYTES_FAILED;
+    // st now describes the last segment
+    dataSize = numSegments == 1 ? st.st_size - headerSize : st.st_size;
+    totalNumPages = (int)((dataSize + header.pageSize - 1) / header.pageSize);
+    // st_blocks counts 512 byte units, including extents preallocated past the end
+    physicalNumPages = (int)(((off_t)st.st_blocks * 512 - (numSegments == 1 ? headerSize : 0)) / header.pageSize);
+    if(header.segmentPages > 0 && physicalNumPages > header.segmentPages){
+        physicalNumPages = header.segmentPages;
+    }
+    if(numSegments > 1){
+        totalNumPages += (numSegments - 1) * header.segmentPages;
+        physicalNumPages += (numSegments - 1) * header.segmentPages;
+    }
+    if(physicalNumPages < totalNumPages){
+        physicalNumPages = totalNumPages;
     }
 
-    fHandle->fileName = fileName;
-    if(size%PAGE_SIZE == 0){
-    	fHandle->totalNumPages = (size / PAGE_SIZE);
-    }else{
-    	fHandle->totalNumPages = (size/PAGE_SIZE +1);
+    mgmt = (SM_FileMgmt *)calloc(1, sizeof(SM_FileMgmt));
+    mgmt->fds = (int *)malloc(numSegments * sizeof(int));
+    memset(mgmt->fds, -1, numSegments * sizeof(int));
+    mgmt->fds[0] = fd;
+    mgmt->numSegments = numSegments;
+    mgmt->segmentPages = header.segmentPages;
+    mgmt->openFlags = flags;
+    mgmt->fileName = strdup(fileName);
+    mgmt->pageSize = header.pageSize;
+    mgmt->headerSize = headerSize;
+    mgmt->mode = mode;
+    mgmt->freeListHead = header.freeListHead;
+    mgmt->freePageCount = header.freePageCount;
+
+    if(mode == SM_MODE_MMAP){
+        // pad a trailing partial page so every mapped page is backed by the file
+        if(st.st_size != headerSize + (off_t)totalNumPages * header.pageSize
+           && ftruncate(fd, headerSize + (off_t)totalNumPages * header.pageSize) != 0){
+            close(fd);
+            free(mgmt->fileName);
+            free(mgmt->fds);
+            free(mgmt);
+            return RC_WRITE_FAILED;
+        }
+        if(remapFile(mgmt, (size_t)headerSize + (size_t)totalNumPages * header.pageSize) != RC_OK){
+            close(fd);
+            free(mgmt->fileName);
+            free(mgmt->fds);
+            free(mgmt);
+            return RC_FILE_NOT_FOUND;
+        }
     }
+    if(mode == SM_MODE_DIRECT){
+        mgmt->bounce = allocPageBufferSize(header.pageSize);
+    }
+
+    fHandle->fileName = fileName;
+    fHandle->pageSize = header.pageSize;
+    fHandle->totalNumPages = totalNumPages;
+    fHandle->physicalNumPages = physicalNumPages;
     fHandle->curPagePos = 0;
-    
-    fclose(fp);
+    fHandle->mgmtInfo = mgmt;
+
     return RC_OK;
 
 }
 
+/***************************************************************
+ * Function Name: setDefaultPageFileMode
+ * 
+ * Description: choose the mode that openPageFile uses for files opened afterwards.
+ *
+ * Parameters: SM_FileMode mode
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+
+
+void setDefaultPageFileMode (SM_FileMode mode){
+    defaultFileMode = mode;
+}
+
+/***************************************************************
+ * Function Name: setPreallocationLimit
+ * 
+ * Description: set the largest extent, in pages, that a growing file preallocates at once. Extents double with the file size until they reach this cap. 0 turns preallocation off.
+ *
+ * Parameters: int maxExtentPages
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+
+
+void setPreallocationLimit (int maxExtentPages){
+    preallocLimit = maxExtentPages < 0 ? 0 : maxExtentPages;
+}
+
+/***************************************************************
+ * Function Name: setFreePageHolePunching
+ * 
+ * Description: choose whether freePage punches a hole over the pages it frees, so the file system can reuse their blocks while the file keeps its size. Off by default.
+ *
+ * Parameters: bool enable
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+
+
+void setFreePageHolePunching (bool enable){
+    punchFreePages = enable;
+}
+
+/***************************************************************
+ * Function Name: allocPageBuffer
+ * 
+ * Description: allocate a zero-filled page buffer of PAGE_SIZE bytes aligned to SM_IO_ALIGNMENT, so it can be used with every file mode including SM_MODE_DIRECT.
+ *
+ * Parameters: void
+ *
+ * Return: SM_PageHandle
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+
+
+SM_PageHandle allocPageBuffer (void){
+    return allocPageBufferSize(PAGE_SIZE);
+}
+
+/***************************************************************
+ * Function Name: allocPageBufferSize
+ * 
+ * Description: allocate a zero-filled, aligned buffer for one page of pageSize bytes, for files created with a page size other than PAGE_SIZE.
+ *
+ * Parameters: int pageSize
+ *
+ * Return: SM_PageHandle
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+
+
+SM_PageHandle allocPageBufferSize (int pageSize){
+    void *memPage;
+
+    if(posix_memalign(&memPage, SM_IO_ALIGNMENT, pageSize) != 0){
+        return NULL;
+    }
+    memset(memPage, 0, pageSize);
+    return (SM_PageHandle)memPage;
+}
+
+/***************************************************************
+ * Function Name: freePageBuffer
+ * 
+ * Description: free a buffer returned by allocPageBuffer.
+ *
+ * Parameters: SM_PageHandle memPage
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+
+
+void freePageBuffer (SM_PageHandle memPage){
+    free(memPage);
+}
+
 /***************************************************************
  * Function Name: closePageFile
  * 
@@ -197,14 +594,38 @@ RC openPageFile (char *fileName, SM_FileHandle *fHandle){
  * History:
  *      Date            Name                        Content
  *      2016/02/07      Xiaoliang Wu                implement function
+ *      2026/10/16      agent                       close every open segment, unmap SM_MODE_MMAP files and free mgmtInfo
  *
 ***************************************************************/
 
 
 RC closePageFile (SM_FileHandle *fHandle){
+    SM_FileMgmt *mgmt = FILE_MGMT(fHandle);
+    int segment;
+
+    if(mgmt == NULL){
+        return RC_FILE_HANDLE_NOT_INIT;
+    }
+
+    if(mgmt->map != NULL){
+        munmap(mgmt->map, mgmt->mapSize);
+    }
+    freePageBuffer(mgmt->bounce);
+    for(segment = 0; segment < mgmt->numSegments; segment++){
+        if(mgmt->fds[segment] != -1){
+            close(mgmt->fds[segment]);
+        }
+    }
+    free(mgmt->fds);
+    free(mgmt->fileName);
+    free(mgmt);
+
     fHandle->fileName = "";
     fHandle->curPagePos = 0;
+    fHandle->pageSize = 0;
     fHandle->totalNumPages = 0;
+    fHandle->physicalNumPages = 0;
+    fHandle->mgmtInfo = NULL;
     return RC_OK;
 }
 
@@ -222,18 +643,90 @@ RC closePageFile (SM_FileHandle *fHandle){
  * History:
  *      Date            Name                        Content
  *      2016/02/07      Xiaoliang Wu                implement function
+ *      2026/10/16      agent                       also delete the segment files
  *
 ***************************************************************/
 
 
 RC destroyPageFile (char *fileName){
     int remove_result;
+    int segment;
+    char *name;
+
     remove_result = remove(fileName);
-    if(remove_result == 0){
-        return RC_OK;
-    }else{
+    if(remove_result != 0){
         return RC_FILE_NOT_FOUND;
     }
+    for(segment = 1; ; segment++){
+        name = segmentFileName(fileName, segment);
+        remove_result = remove(name);
+        free(name);
+        if(remove_result != 0){
+            break;
+        }
+    }
+    return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: getPageFileMode
+ * 
+ * Description: return the mode the page file was opened with.
+ *
+ * Parameters: SM_FileHandle *fHandle
+ *
+ * Return: SM_FileMode
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+
+
+SM_FileMode getPageFileMode (SM_FileHandle *fHandle){
+    return FILE_MGMT(fHandle)->mode;
+}
+
+/***************************************************************
+ * Function Name: getBlockLocation
+ * 
+ * Description: return the file descriptor and byte offset of page pageNum, for callers that issue their own I/O on the page (the asynchronous engine). For segmented files these are the segment's descriptor and the offset inside the segment. Memory-mapped files have no such location.
+ *
+ * Parameters: int pageNum, SM_FileHandle *fHandle, int *fd, long long *offset
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+
+
+RC getBlockLocation (int pageNum, SM_FileHandle *fHandle, int *fd, long long *offset){
+    SM_FileMgmt *mgmt = FILE_MGMT(fHandle);
+
+    if(mgmt == NULL){
+        return RC_FILE_HANDLE_NOT_INIT;
+    }
+    if(mgmt->mode == SM_MODE_MMAP){
+        return RC_FILE_MODE_NOT_SUPPORTED;
+    }
+    if(pageNum < 0 || pageNum >= fHandle->totalNumPages){
+        return RC_READ_NON_EXISTING_PAGE;
+    }
+
+    *fd = segmentFd(fHandle, segmentOf(mgmt, pageNum), false);
+    if(*fd == -1){
+        return RC_READ_NON_EXISTING_PAGE;
+    }
+    *offset = (long long)pageOffset(mgmt, pageNum);
+    return RC_OK;
 }
 
 /* reading blocks from disc */
@@ -253,6 +746,7 @@ RC destroyPageFile (char *fileName){
  * History:
  *      Date            Name                        Content
  *      2016/1/30      Zhipeng Liu            first time to implement the function
+ *      2026/10/16      agent                       read at pageNum with pread on the open descriptor
  *
 ***************************************************************/
 
@@ -263,15 +757,10 @@ RC readBlock (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage)
 		return RC_READ_NON_EXISTING_PAGE;
 	else
 	{
-		FILE *fp;
-		fp=fopen(fHandle->fileName,"r");
-		int offset;
-		offset=fHandle->curPagePos*PAGE_SIZE;
-		fseek(fp,offset,SEEK_SET);
-		fread(memPage,sizeof(char),PAGE_SIZE,fp);
-		fHandle->curPagePos=pageNum;
-		fclose(fp);
-		return RC_OK;
+		RC rv=readPage(fHandle,pageNum,memPage);
+		if(rv==RC_OK)
+			fHandle->curPagePos=pageNum;
+		return rv;
 	}
 }
 
@@ -312,19 +801,14 @@ int getBlockPos (SM_FileHandle *fHandle)
  * History:
  *      Date                     Name                        Content
  *      2016/1/30      Zhipeng Liu                    first time to implement the function
+ *      2026/10/16      agent                       use readBlock
  *
 ***************************************************************/
 
 
 RC readFirstBlock (SM_FileHandle *fHandle, SM_PageHandle memPage)
 {
-	FILE *fp;
-	fp=fopen(fHandle->fileName,"r");
-	fseek(fp,0,SEEK_SET);
-	fread(memPage,sizeof(char),PAGE_SIZE,fp);
-	fHandle->curPagePos=0;
-	fclose(fp);
-	return RC_OK;
+	return readBlock(0,fHandle,memPage);
 }
 
 /***************************************************************
@@ -341,6 +825,7 @@ RC readFirstBlock (SM_FileHandle *fHandle, SM_PageHandle memPage)
  * History:
  *      Date                     Name                             Content
  *      2016/1/27       Zhipeng Liu                    first time to implement the function
+ *      2026/10/16      agent                       use readBlock
  *
 ***************************************************************/
 
@@ -350,16 +835,7 @@ RC readPreviousBlock (SM_FileHandle *fHandle, SM_PageHandle memPage)
 	if(fHandle->curPagePos<=0||fHandle->curPagePos>fHandle->totalNumPages-1)
 		return RC_READ_NON_EXISTING_PAGE;
 	else
-	{
-		FILE *fp;
-		fp=fopen(fHandle->fileName,"r");
-		int offset=(fHandle->curPagePos-1)*PAGE_SIZE;
-		fseek(fp,offset,SEEK_SET);
-		fread(memPage,sizeof(char),PAGE_SIZE,fp);
-		fHandle->curPagePos=fHandle->curPagePos-1;
-		fclose(fp);
-		return RC_OK;
-	}
+		return readBlock(fHandle->curPagePos-1,fHandle,memPage);
 }
 
 /***************************************************************
@@ -376,6 +852,7 @@ RC readPreviousBlock (SM_FileHandle *fHandle, SM_PageHandle memPage)
  * History:
  *      Date            Name                        Content
  *   2016/1/27     Zhipeng Liu             first time to implement the function
+ *      2026/10/16      agent                       use pread on the open descriptor
  *
 ***************************************************************/
 
@@ -385,15 +862,7 @@ RC readCurrentBlock (SM_FileHandle *fHandle, SM_PageHandle memPage)
 	if(fHandle->curPagePos<0||fHandle->curPagePos>fHandle->totalNumPages-1)
 		return RC_READ_NON_EXISTING_PAGE;
 	else
-	{
-		FILE *fp;
-		fp=fopen(fHandle->fileName,"r");
-		int offset=fHandle->curPagePos*PAGE_SIZE;
-		fseek(fp,offset,SEEK_SET);
-		fread(memPage,sizeof(char),PAGE_SIZE,fp);
-		fclose(fp);
-		return RC_OK;
-	}
+		return readPage(fHandle,fHandle->curPagePos,memPage);
 }
 
 /***************************************************************
@@ -410,6 +879,7 @@ RC readCurrentBlock (SM_FileHandle *fHandle, SM_PageHandle memPage)
  * History:
  *      Date            Name                        Content
  *   2016/1/27     Zhipeng Liu             first time to implement the function
+ *      2026/10/16      agent                       use readBlock
  *
 ***************************************************************/
 
@@ -419,16 +889,7 @@ RC readNextBlock (SM_FileHandle *fHandle, SM_PageHandle memPage)
 	if(fHandle->curPagePos<0||fHandle->curPagePos>fHandle->totalNumPages-2)
 		return RC_READ_NON_EXISTING_PAGE;
 	else
-	{
-		FILE *fp;
-		fp=fopen(fHandle->fileName,"r");
-		int offset=(fHandle->curPagePos+1)*PAGE_SIZE;
-		fseek(fp,offset,SEEK_SET);
-		fread(memPage,sizeof(char),PAGE_SIZE,fp);
-		fHandle->curPagePos=fHandle->curPagePos+1;
-		fclose(fp);
-		return RC_OK;
-	}
+		return readBlock(fHandle->curPagePos+1,fHandle,memPage);
 }
 
 /***************************************************************
@@ -445,20 +906,47 @@ RC readNextBlock (SM_FileHandle *fHandle, SM_PageHandle memPage)
  * History:
  *      Date            Name                        Content
  *   2016/1/27     Zhipeng Liu             first time to implement the function
+ *      2026/10/16      agent                       use readBlock
  *
 ***************************************************************/
 
 
 RC readLastBlock (SM_FileHandle *fHandle, SM_PageHandle memPage)
 {
-	FILE *fp;
-	fp=fopen(fHandle->fileName,"r");
-	int offset=-PAGE_SIZE;
-	fseek(fp,offset,SEEK_END);
-	fread(memPage,sizeof(char),PAGE_SIZE,fp);
-	fHandle->curPagePos=fHandle->totalNumPages-1;
-	fclose(fp);
-	return RC_OK;
+	return readBlock(fHandle->totalNumPages-1,fHandle,memPage);
+}
+
+/***************************************************************
+ * Function Name: readBlocks
+ * 
+ * Description: read count consecutive blocks starting at startPage into the buffers memPages[0..count-1] with vectored reads, so a contiguous range costs one preadv per IOV_MAX pages.
+ *
+ * Parameters: int startPage, int count, SM_FileHandle *fHandle, SM_PageHandle *memPages
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+
+
+RC readBlocks (int startPage, int count, SM_FileHandle *fHandle, SM_PageHandle *memPages)
+{
+	RC rv;
+
+	if(startPage<0||count<0||startPage+count>fHandle->totalNumPages)
+		return RC_READ_NON_EXISTING_PAGE;
+	if(count==0)
+		return RC_OK;
+
+	rv=transferPages(fHandle,startPage,count,memPages,false);
+	if(rv==RC_OK)
+		fHandle->curPagePos=startPage+count-1;
+	return rv;
 }
 
 /* writing blocks to a page file */
@@ -478,25 +966,25 @@ RC readLastBlock (SM_FileHandle *fHandle, SM_PageHandle memPage)
  *      Date            Name                        Content
  *   2016/2/2		Xincheng Yang             first time to implement the function
  *   2016/2/2		Xincheng Yang			  modified some codes
+ *      2026/10/16      agent                       use pwrite on the open descriptor
  *
 ***************************************************************/
 RC writeBlock (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage){
-	ensureCapacity (pageNum, fHandle);		//Make sure the program have enough capacity to write block.
-	
-	FILE *fp;
 	RC rv;
 
-	fp=fopen(fHandle->fileName,"rb+");
-	if(fseek(fp,pageNum * PAGE_SIZE, SEEK_SET) != 0){
-		rv = RC_READ_NON_EXISTING_PAGE;	
-	} else if (fwrite(memPage, PAGE_SIZE, 1, fp) != 1){
-		rv = RC_WRITE_FAILED; 
-	} else {
-		fHandle->curPagePos=pageNum;		//Success write block, then curPagePos should be changed.
-		rv = RC_OK;
+	if(pageNum < 0){
+		return RC_READ_NON_EXISTING_PAGE;
+	}
+
+	rv = ensureCapacity (pageNum + 1, fHandle);		//Make sure the program have enough capacity to write block.
+	if(rv != RC_OK){
+		return rv;
 	}
 
-	fclose(fp);
+	rv = writePage(fHandle, pageNum, memPage);
+	if(rv == RC_OK){
+		fHandle->curPagePos=pageNum;		//Success write block, then curPagePos should be changed.
+	}
 	return rv;
 }
 
@@ -529,52 +1017,48 @@ RC writeCurrentBlock (SM_FileHandle *fHandle, SM_PageHandle memPage){
 }
 
 /***************************************************************
- * Function Name: appendEmptyBlock 
+ * Function Name: writeBlocks 
  * 
- * Description: Increase the number of pages in the file by one. The new last page should be filled with zero bytes.
+ * Description: write the buffers memPages[0..count-1] to count consecutive blocks starting at startPage with vectored writes, growing the file first if needed.
  *
- * Parameters: int numberOfPages, SM_FileHandle *fHandle
+ * Parameters: int startPage, int count, SM_FileHandle *fHandle, SM_PageHandle *memPages
  *
  * Return: RC
  *
- * Author: Xincheng Yang
+ * Author: agent
  *
  * History:
  *      Date            Name                        Content
- *   2016/2/1		Xincheng Yang             first time to implement the function
- *   2016/2/2		Xincheng Yang			  modified some codes
+ *      2026/10/16      agent                       Complete.
  *
 ***************************************************************/
-RC appendEmptyBlock (SM_FileHandle *fHandle){
-	if(fHandle == NULL){
-		return RC_FILE_HANDLE_NOT_INIT;
-	} 
-
-	FILE *fp;
-	char *allocData;
+RC writeBlocks (int startPage, int count, SM_FileHandle *fHandle, SM_PageHandle *memPages){
 	RC rv;
 
-	allocData = (char *)calloc(1, PAGE_SIZE);
-	fp=fopen(fHandle->fileName,"ab+");
-
-	if(fwrite(allocData, PAGE_SIZE, 1, fp) != 1)   
-	{
-		rv = RC_WRITE_FAILED;
-	} else {
-		fHandle -> totalNumPages += 1;
-		rv = RC_OK;		
+	if(startPage < 0 || count < 0){
+		return RC_READ_NON_EXISTING_PAGE;
+	}
+	if(count == 0){
+		return RC_OK;
 	}
 
-	free(allocData);
-	fclose(fp);
+	rv = ensureCapacity (startPage + count, fHandle);
+	if(rv != RC_OK){
+		return rv;
+	}
 
-	return  rv;
+	rv = transferPages(fHandle, startPage, count, memPages, true);
+	if(rv == RC_OK){
+		fHandle->curPagePos = startPage + count - 1;
+	}
+	return rv;
 }
 
+
 /***************************************************************
- * Function Name: ensureCapacity 
+ * Function Name: appendEmptyBlock 
  * 
- * Description: If the file has less than numberOfPages pages then increase the size to numberOfPages.
+ * Description: Increase the number of pages in the file by one. The new last page should be filled with zero bytes.
  *
  * Parameters: int numberOfPages, SM_FileHandle *fHandle
  *
@@ -585,36 +1069,889 @@ RC appendEmptyBlock (SM_FileHandle *fHandle){
  * History:
  *      Date            Name                        Content
  *   2016/2/1		Xincheng Yang             first time to implement the function
+ *   2016/2/2		Xincheng Yang			  modified some codes
+ *      2026/10/16      agent                       grow through growFile
+ *
+***************************************************************/
+RC appendEmptyBlock (SM_FileHandle *fHandle){
+	if(fHandle == NULL || fHandle->mgmtInfo == NULL){
+		return RC_FILE_HANDLE_NOT_INIT;
+	} 
+
+	return growFile(fHandle, fHandle->totalNumPages + 1);
+}
+
+/***************************************************************
+ * Function Name: ensureCapacity 
+ * 
+ * Description: If the file has less than numberOfPages pages then increase the size to numberOfPages.
+ *
+ * Parameters: int numberOfPages, SM_FileHandle *fHandle
+ *
+ * Return: RC
+ *
+ * Author: Xincheng Yang
+ *
+ * History:
+ *      Date            Name                        Content
+ *   2016/2/1		Xincheng Yang             first time to implement the function
+ *      2026/10/16      agent                       grow through growFile
  *
 ***************************************************************/
 RC ensureCapacity (int numberOfPages, SM_FileHandle *fHandle){
-	if(fHandle == NULL){
+	if(fHandle == NULL || fHandle->mgmtInfo == NULL){
 		return RC_FILE_HANDLE_NOT_INIT;
 	} 
 	if(fHandle -> totalNumPages >= numberOfPages){
 		return RC_OK;
 	}
-	
-	FILE *fp;
-	long allocCapacity;
-	char *allocData;
+
+	return growFile(fHandle, numberOfPages);
+}
+
+/***************************************************************
+ * Function Name: allocatePage
+ * 
+ * Description: hand out a zero-filled page for new data. Pages on the free-page list are reused first, the file only grows by one page when the list is empty.
+ *
+ * Parameters: SM_FileHandle *fHandle, int *pageNum
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+RC allocatePage (SM_FileHandle *fHandle, int *pageNum){
+	SM_FileMgmt *mgmt;
+	SM_PageHandle trunk;
+	int *entries;
+	int page;
 	RC rv;
 
-	allocCapacity= (numberOfPages - fHandle -> totalNumPages) * PAGE_SIZE;
-	allocData = (char *)calloc(1,allocCapacity);
-	
-	fp=fopen(fHandle->fileName,"ab+");
-   
-	if(fwrite(allocData, allocCapacity, 1, fp) == 0)   
-	{
-		rv = RC_WRITE_FAILED;
+	if(fHandle == NULL || fHandle->mgmtInfo == NULL){
+		return RC_FILE_HANDLE_NOT_INIT;
+	}
+	mgmt = FILE_MGMT(fHandle);
+	if(mgmt->freePageCount == 0){
+		rv = appendEmptyBlock(fHandle);
+		if(rv == RC_OK){
+			*pageNum = fHandle->totalNumPages - 1;
+		}
+		return rv;
+	}
+
+	trunk = allocPageBufferSize(mgmt->pageSize);
+	entries = (int *)trunk;
+	rv = readPage(fHandle, mgmt->freeListHead, trunk);
+	if(rv != RC_OK){
+		freePageBuffer(trunk);
+		return rv;
+	}
+	if(entries[SM_TRUNK_COUNT] > 0){
+		// take the last leaf, the trunk stays where it is
+		page = entries[SM_TRUNK_LEAVES + --entries[SM_TRUNK_COUNT]];
+		rv = writePage(fHandle, mgmt->freeListHead, trunk);
 	} else {
-		fHandle -> totalNumPages = numberOfPages;		//When write success, totalNumPages should be changed to numberOfPages.	
-		rv = RC_OK;
+		// an empty trunk page is handed out itself
+		page = mgmt->freeListHead;
+		mgmt->freeListHead = entries[SM_TRUNK_NEXT];
+	}
+	if(rv == RC_OK){
+		mgmt->freePageCount--;
+		rv = writeHeader(fHandle);
 	}
+	if(rv == RC_OK){
+		memset(trunk, 0, mgmt->pageSize);
+		rv = writePage(fHandle, page, trunk);
+	}
+	freePageBuffer(trunk);
+	if(rv == RC_OK){
+		*pageNum = page;
+	}
+	return rv;
+}
 
-	free(allocData);
-	fclose(fp);
+/***************************************************************
+ * Function Name: freePage
+ * 
+ * Description: put page pageNum on the free-page list so allocatePage can reuse it. The list is kept in the file: the header points to a chain of trunk pages, each recording as many freed leaf pages as fit on it. A page freed while the first trunk is full becomes the new first trunk. The caller must not use the page, or free it again, until allocatePage returns it. Files written before the header have no list and return RC_FILE_HEADER_INVALID.
+ *
+ * Parameters: int pageNum, SM_FileHandle *fHandle
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+RC freePage (int pageNum, SM_FileHandle *fHandle){
+	SM_FileMgmt *mgmt;
+	SM_PageHandle trunk;
+	int *entries;
+	int capacity, fd;
+	RC rv;
 
+	if(fHandle == NULL || fHandle->mgmtInfo == NULL){
+		return RC_FILE_HANDLE_NOT_INIT;
+	}
+	if(pageNum < 0 || pageNum >= fHandle->totalNumPages){
+		return RC_READ_NON_EXISTING_PAGE;
+	}
+	mgmt = FILE_MGMT(fHandle);
+	if(mgmt->headerSize == 0){
+		return RC_FILE_HEADER_INVALID;
+	}
+	capacity = mgmt->pageSize / sizeof(int) - SM_TRUNK_LEAVES;
+
+	trunk = allocPageBufferSize(mgmt->pageSize);
+	entries = (int *)trunk;
+	rv = RC_OK;
+	if(mgmt->freePageCount > 0){
+		rv = readPage(fHandle, mgmt->freeListHead, trunk);
+	}
+	if(rv == RC_OK && mgmt->freePageCount > 0 && entries[SM_TRUNK_COUNT] < capacity){
+		entries[SM_TRUNK_LEAVES + entries[SM_TRUNK_COUNT]++] = pageNum;
+		rv = writePage(fHandle, mgmt->freeListHead, trunk);
+		// only leaves are punched, trunk pages hold the list
+		if(rv == RC_OK && punchFreePages){
+			fd = segmentFd(fHandle, segmentOf(mgmt, pageNum), false);
+			if(fd != -1){
+				fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, pageOffset(mgmt, pageNum), mgmt->pageSize);
+			}
+		}
+	} else if(rv == RC_OK){
+		memset(trunk, 0, mgmt->pageSize);
+		entries[SM_TRUNK_NEXT] = mgmt->freePageCount > 0 ? mgmt->freeListHead : -1;
+		entries[SM_TRUNK_COUNT] = 0;
+		rv = writePage(fHandle, pageNum, trunk);
+		if(rv == RC_OK){
+			mgmt->freeListHead = pageNum;
+		}
+	}
+	if(rv == RC_OK){
+		mgmt->freePageCount++;
+		rv = writeHeader(fHandle);
+	}
+	freePageBuffer(trunk);
 	return rv;
 }
+
+/***************************************************************
+ * Function Name: getNumFreePages
+ * 
+ * Description: return the number of pages on the free-page list of an open page file.
+ *
+ * Parameters: SM_FileHandle *fHandle
+ *
+ * Return: int
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+int getNumFreePages (SM_FileHandle *fHandle){
+	if(fHandle == NULL || fHandle->mgmtInfo == NULL){
+		return 0;
+	}
+	return FILE_MGMT(fHandle)->freePageCount;
+}
+
+/***************************************************************
+ * Function Name: readPage
+ * 
+ * Description: read one page at its absolute position with pread on the open file descriptor, or copy it out of the mapping in SM_MODE_MMAP. In SM_MODE_DIRECT an unaligned memPage is filled through the bounce buffer. Bytes past the end of file are returned as zero.
+ *
+ * Parameters: SM_FileHandle *fHandle, int pageNum, SM_PageHandle memPage
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+static RC readPage (SM_FileHandle *fHandle, int pageNum, SM_PageHandle memPage){
+	SM_FileMgmt *mgmt = FILE_MGMT(fHandle);
+	off_t offset;
+	size_t done = 0;
+	ssize_t n;
+	int fd;
+
+	if(mgmt == NULL){
+		return RC_FILE_HANDLE_NOT_INIT;
+	}
+	offset = pageOffset(mgmt, pageNum);
+	if(mgmt->mode == SM_MODE_MMAP){
+		if((size_t)offset + mgmt->pageSize > mgmt->mapSize){
+			return RC_READ_NON_EXISTING_PAGE;
+		}
+		memcpy(memPage, mgmt->map + offset, mgmt->pageSize);
+		return RC_OK;
+	}
+	fd = segmentFd(fHandle, segmentOf(mgmt, pageNum), false);
+	if(fd == -1){
+		return RC_READ_NON_EXISTING_PAGE;
+	}
+	if(mgmt->mode == SM_MODE_DIRECT){
+		SM_PageHandle buf = IS_IO_ALIGNED(memPage) ? memPage : mgmt->bounce;
+		do {
+			n = pread(fd, buf, mgmt->pageSize, offset);
+		} while(n < 0 && errno == EINTR);
+		if(n < 0){
+			return RC_READ_NON_EXISTING_PAGE;
+		}
+		// a short read only happens at the end of file
+		memset(buf + n, 0, mgmt->pageSize - n);
+		if(buf != memPage){
+			memcpy(memPage, buf, mgmt->pageSize);
+		}
+		return RC_OK;
+	}
+
+	while(done < (size_t)mgmt->pageSize){
+		n = pread(fd, memPage + done, mgmt->pageSize - done, offset + done);
+		if(n < 0){
+			if(errno == EINTR) continue;
+			return RC_READ_NON_EXISTING_PAGE;
+		}
+		if(n == 0) break;
+		done += n;
+	}
+	if(done < (size_t)mgmt->pageSize){
+		memset(memPage + done, 0, mgmt->pageSize - done);
+	}
+	return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: writePage
+ * 
+ * Description: write one page at its absolute position with pwrite on the open file descriptor, or copy it into the mapping in SM_MODE_MMAP. In SM_MODE_DIRECT an unaligned memPage is written through the bounce buffer.
+ *
+ * Parameters: SM_FileHandle *fHandle, int pageNum, SM_PageHandle memPage
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+static RC writePage (SM_FileHandle *fHandle, int pageNum, SM_PageHandle memPage){
+	SM_FileMgmt *mgmt = FILE_MGMT(fHandle);
+	off_t offset;
+	size_t done = 0;
+	ssize_t n;
+	int fd;
+
+	if(mgmt == NULL){
+		return RC_FILE_HANDLE_NOT_INIT;
+	}
+	offset = pageOffset(mgmt, pageNum);
+	if(mgmt->mode == SM_MODE_MMAP){
+		if((size_t)offset + mgmt->pageSize > mgmt->mapSize){
+			return RC_WRITE_FAILED;
+		}
+		memcpy(mgmt->map + offset, memPage, mgmt->pageSize);
+		return RC_OK;
+	}
+	fd = segmentFd(fHandle, segmentOf(mgmt, pageNum), false);
+	if(fd == -1){
+		return RC_WRITE_FAILED;
+	}
+	if(mgmt->mode == SM_MODE_DIRECT){
+		SM_PageHandle buf = memPage;
+		if(!IS_IO_ALIGNED(memPage)){
+			memcpy(mgmt->bounce, memPage, mgmt->pageSize);
+			buf = mgmt->bounce;
+		}
+		do {
+			n = pwrite(fd, buf, mgmt->pageSize, offset);
+		} while(n < 0 && errno == EINTR);
+		return n == mgmt->pageSize ? RC_OK : RC_WRITE_FAILED;
+	}
+
+	while(done < (size_t)mgmt->pageSize){
+		n = pwrite(fd, memPage + done, mgmt->pageSize - done, offset + done);
+		if(n < 0){
+			if(errno == EINTR) continue;
+			return RC_WRITE_FAILED;
+		}
+		done += n;
+	}
+	return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: transferPages
+ * 
+ * Description: move count consecutive pages starting at startPage between the file and the buffers memPages. Each part of the range that lies in one segment is moved with transferRun. Reads past the end of file return zeros.
+ *
+ * Parameters: SM_FileHandle *fHandle, int startPage, int count, SM_PageHandle *memPages, bool write
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+static RC transferPages (SM_FileHandle *fHandle, int startPage, int count, SM_PageHandle *memPages, bool write){
+	SM_FileMgmt *mgmt = FILE_MGMT(fHandle);
+	int i, run, fd;
+	RC rv;
+
+	if(mgmt == NULL){
+		return RC_FILE_HANDLE_NOT_INIT;
+	}
+	// pages that cannot go through one vectored call are moved one at a time
+	if(mgmt->mode == SM_MODE_MMAP || (mgmt->mode == SM_MODE_DIRECT && !allAligned(memPages, count))){
+		for(i = 0; i < count; i++){
+			rv = write ? writePage(fHandle, startPage + i, memPages[i])
+			           : readPage(fHandle, startPage + i, memPages[i]);
+			if(rv != RC_OK){
+				return rv;
+			}
+		}
+		return RC_OK;
+	}
+
+	for(i = 0; i < count; i += run){
+		run = count - i;
+		if(mgmt->segmentPages > 0 && run > mgmt->segmentPages - (startPage + i) % mgmt->segmentPages){
+			run = mgmt->segmentPages - (startPage + i) % mgmt->segmentPages;
+		}
+		fd = segmentFd(fHandle, segmentOf(mgmt, startPage + i), false);
+		if(fd == -1){
+			return write ? RC_WRITE_FAILED : RC_READ_NON_EXISTING_PAGE;
+		}
+		rv = transferRun(mgmt, fd, pageOffset(mgmt, startPage + i), run, memPages + i, write);
+		if(rv != RC_OK){
+			return rv;
+		}
+	}
+	return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: transferRun
+ * 
+ * Description: move count pages stored back to back at offset of fd with preadv/pwritev, at most IOV_MAX pages per call, resuming after short transfers. Reads past the end of file return zeros.
+ *
+ * Parameters: SM_FileMgmt *mgmt, int fd, off_t offset, int count, SM_PageHandle *memPages, bool write
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+static RC transferRun (SM_FileMgmt *mgmt, int fd, off_t offset, int count, SM_PageHandle *memPages, bool write){
+	struct iovec iov[IOV_MAX];
+	int first = 0;     // first page not completely transferred yet
+	size_t skip = 0;   // bytes of memPages[first] already transferred
+	int i, n;
+	ssize_t done;
+
+	while(first < count){
+		n = count - first < IOV_MAX ? count - first : IOV_MAX;
+		for(i = 0; i < n; i++){
+			iov[i].iov_base = memPages[first + i];
+			iov[i].iov_len = mgmt->pageSize;
+		}
+		iov[0].iov_base = memPages[first] + skip;
+		iov[0].iov_len = mgmt->pageSize - skip;
+
+		if(write){
+			done = pwritev(fd, iov, n, offset);
+		} else {
+			done = preadv(fd, iov, n, offset);
+		}
+		if(done < 0){
+			if(errno == EINTR) continue;
+			return write ? RC_WRITE_FAILED : RC_READ_NON_EXISTING_PAGE;
+		}
+		if(done == 0){
+			if(write){
+				return RC_WRITE_FAILED;
+			}
+			// end of file: the rest of the range reads as zeros
+			memset(memPages[first] + skip, 0, mgmt->pageSize - skip);
+			for(i = first + 1; i < count; i++){
+				memset(memPages[i], 0, mgmt->pageSize);
+			}
+			return RC_OK;
+		}
+
+		offset += done;
+		done += skip;
+		first += done / mgmt->pageSize;
+		skip = done % mgmt->pageSize;
+
+		// O_DIRECT cannot resume at an unaligned offset
+		if(skip != 0 && mgmt->mode == SM_MODE_DIRECT){
+			if(write){
+				return RC_WRITE_FAILED;
+			}
+			memset(memPages[first] + skip, 0, mgmt->pageSize - skip);
+			for(i = first + 1; i < count; i++){
+				memset(memPages[i], 0, mgmt->pageSize);
+			}
+			return RC_OK;
+		}
+	}
+	return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: allAligned
+ * 
+ * Description: check whether every buffer in memPages meets the O_DIRECT alignment.
+ *
+ * Parameters: SM_PageHandle *memPages, int count
+ *
+ * Return: bool
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+static bool allAligned (SM_PageHandle *memPages, int count){
+	int i;
+
+	for(i = 0; i < count; i++){
+		if(!IS_IO_ALIGNED(memPages[i])){
+			return false;
+		}
+	}
+	return true;
+}
+
+/***************************************************************
+ * Function Name: growFile
+ * 
+ * Description: extend the file with zero-filled pages up to numberOfPages by moving the end of file with ftruncate. Disk space is reserved ahead with preallocate; on file systems without fallocate the new pages are written with zeros instead. SM_MODE_MMAP also grows the mapping. Segmented files are filled one segment at a time, creating segment files as needed.
+ *
+ * Parameters: SM_FileHandle *fHandle, int numberOfPages
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+static RC growFile (SM_FileHandle *fHandle, int numberOfPages){
+	SM_FileMgmt *mgmt = FILE_MGMT(fHandle);
+	long long segmentEnd;
+	int segment, upTo, fd;
+	off_t end;
+	RC rv;
+
+	// page numbers are ints, numberOfPages wrapped around
+	if(numberOfPages < 0){
+		return RC_WRITE_FAILED;
+	}
+
+	if(mgmt->mode == SM_MODE_MMAP){
+		if(!preallocate(fHandle, numberOfPages)){
+			rv = writeZeroPages(fHandle, mgmt->fds[0], fHandle -> totalNumPages, numberOfPages);
+			if(rv != RC_OK){
+				return rv;
+			}
+		}
+		end = mgmt->headerSize + (off_t)numberOfPages * mgmt->pageSize;
+		if(ftruncate(mgmt->fds[0], end) != 0){
+			return RC_WRITE_FAILED;
+		}
+		rv = remapFile(mgmt, (size_t)end);
+		if(rv == RC_OK){
+			fHandle -> totalNumPages = numberOfPages;
+			if(fHandle -> physicalNumPages < numberOfPages){
+				fHandle -> physicalNumPages = numberOfPages;
+			}
+		}
+		return rv;
+	}
+
+	while(fHandle -> totalNumPages < numberOfPages){
+		segment = segmentOf(mgmt, fHandle -> totalNumPages);
+		upTo = numberOfPages;
+		if(mgmt->segmentPages > 0){
+			segmentEnd = (long long)(segment + 1) * mgmt->segmentPages;
+			if(upTo > segmentEnd){
+				upTo = (int)segmentEnd;
+			}
+		}
+		fd = segmentFd(fHandle, segment, true);
+		if(fd == -1){
+			return RC_WRITE_FAILED;
+		}
+
+		// the new pages read as zeros. Outside a reserved extent the file
+		// system allocates their blocks when they are first written.
+		if(!preallocate(fHandle, upTo)){
+			rv = writeZeroPages(fHandle, fd, fHandle -> totalNumPages, upTo);
+			if(rv != RC_OK){
+				return rv;
+			}
+		}
+		if(ftruncate(fd, pageOffset(mgmt, upTo - 1) + mgmt->pageSize) != 0){
+			return RC_WRITE_FAILED;
+		}
+		if(fHandle -> physicalNumPages < upTo){
+			fHandle -> physicalNumPages = upTo;
+		}
+		fHandle -> totalNumPages = upTo;		//When write success, totalNumPages should be changed to numberOfPages.
+	}
+
+	return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: preallocate
+ * 
+ * Description: make sure at least numberOfPages pages are allocated on disk. The file grows by extents that double with its physical size, capped at preallocLimit pages and at the end of the segment, and are reserved with fallocate(FALLOC_FL_KEEP_SIZE) so the end of file does not move. Nothing happens when preallocation is off. Returns false when the file system could not reserve the extent, so the caller writes the pages itself.
+ *
+ * Parameters: SM_FileHandle *fHandle, int numberOfPages
+ *
+ * Return: bool
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+static bool preallocate (SM_FileHandle *fHandle, int numberOfPages){
+	SM_FileMgmt *mgmt = FILE_MGMT(fHandle);
+	long long segmentEnd;
+	int extent, target, fd;
+
+	if(preallocLimit == 0 || fHandle->physicalNumPages >= numberOfPages){
+		return true;
+	}
+	fd = segmentFd(fHandle, segmentOf(mgmt, fHandle->physicalNumPages), false);
+	if(fd == -1){
+		return false;
+	}
+
+	extent = fHandle->physicalNumPages > 0 ? fHandle->physicalNumPages : 1;
+	if(extent > preallocLimit){
+		extent = preallocLimit;
+	}
+	target = fHandle->physicalNumPages > INT_MAX - extent ? INT_MAX : fHandle->physicalNumPages + extent;
+	if(mgmt->segmentPages > 0){
+		segmentEnd = (long long)(segmentOf(mgmt, fHandle->physicalNumPages) + 1) * mgmt->segmentPages;
+		if(target > segmentEnd){
+			target = (int)segmentEnd;
+		}
+	}
+	if(target < numberOfPages){
+		target = numberOfPages;
+	}
+
+	if(fallocate(fd, FALLOC_FL_KEEP_SIZE, pageOffset(mgmt, fHandle->physicalNumPages),
+	             (off_t)(target - fHandle->physicalNumPages) * mgmt->pageSize) != 0){
+		return false;
+	}
+	fHandle->physicalNumPages = target;
+	return true;
+}
+
+/***************************************************************
+ * Function Name: writeZeroPages
+ * 
+ * Description: write zero-filled pages fromPage up to toPage, all in the segment open on fd, so their blocks are allocated on file systems without fallocate. Pages already allocated on disk are skipped.
+ *
+ * Parameters: SM_FileHandle *fHandle, int fd, int fromPage, int toPage
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/17      agent                       Complete.
+ *
+***************************************************************/
+static RC writeZeroPages (SM_FileHandle *fHandle, int fd, int fromPage, int toPage){
+	SM_FileMgmt *mgmt = FILE_MGMT(fHandle);
+	SM_PageHandle zeros;
+	size_t size;
+	ssize_t n;
+	int count;
+
+	if(fromPage < fHandle->physicalNumPages){
+		fromPage = fHandle->physicalNumPages;
+	}
+	if(fromPage >= toPage){
+		return RC_OK;
+	}
+	count = toPage - fromPage < SM_ZERO_WRITE_PAGES ? toPage - fromPage : SM_ZERO_WRITE_PAGES;
+	// aligned, so this also works with O_DIRECT
+	zeros = allocPageBufferSize(count * mgmt->pageSize);
+	if(zeros == NULL){
+		return RC_WRITE_FAILED;
+	}
+	while(fromPage < toPage){
+		if(toPage - fromPage < count){
+			count = toPage - fromPage;
+		}
+		size = (size_t)count * mgmt->pageSize;
+		n = pwrite(fd, zeros, size, pageOffset(mgmt, fromPage));
+		if(n < 0 && errno == EINTR){
+			continue;
+		}
+		if(n < 0 || (size_t)n != size){
+			freePageBuffer(zeros);
+			return RC_WRITE_FAILED;
+		}
+		fromPage += count;
+		fHandle->physicalNumPages = fromPage;
+	}
+	freePageBuffer(zeros);
+	return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: remapFile
+ * 
+ * Description: map the first size bytes of the file, header included, creating the mapping on first use and growing it with mremap afterwards.
+ *
+ * Parameters: SM_FileMgmt *mgmt, size_t size
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+static RC remapFile (SM_FileMgmt *mgmt, size_t size){
+	void *map;
+
+	if(size == mgmt->mapSize){
+		return RC_OK;
+	}
+	if(mgmt->map == NULL){
+		map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, mgmt->fds[0], 0);
+	} else {
+		map = mremap(mgmt->map, mgmt->mapSize, size, MREMAP_MAYMOVE);
+	}
+	if(map == MAP_FAILED){
+		return RC_WRITE_FAILED;
+	}
+
+	mgmt->map = (char *)map;
+	mgmt->mapSize = size;
+	return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: segmentOf
+ * 
+ * Description: return the segment that holds page pageNum, 0 for files that are not segmented.
+ *
+ * Parameters: SM_FileMgmt *mgmt, int pageNum
+ *
+ * Return: int
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+static int segmentOf (SM_FileMgmt *mgmt, int pageNum){
+	return mgmt->segmentPages > 0 ? pageNum / mgmt->segmentPages : 0;
+}
+
+/***************************************************************
+ * Function Name: pageOffset
+ * 
+ * Description: return the byte offset of page pageNum inside its segment. The first segment starts with the header block, unless the file was written before the header. Offsets are 64 bit, so pages past 2 GB are addressed correctly.
+ *
+ * Parameters: SM_FileMgmt *mgmt, int pageNum
+ *
+ * Return: off_t
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+static off_t pageOffset (SM_FileMgmt *mgmt, int pageNum){
+	int index = mgmt->segmentPages > 0 ? pageNum % mgmt->segmentPages : pageNum;
+	off_t header = segmentOf(mgmt, pageNum) == 0 ? mgmt->headerSize : 0;
+
+	return header + (off_t)index * mgmt->pageSize;
+}
+
+/***************************************************************
+ * Function Name: segmentFd
+ * 
+ * Description: return the descriptor of a segment, opening the segment file on first use. With create set a missing segment file is created. Returns -1 if the segment does not exist or cannot be opened.
+ *
+ * Parameters: SM_FileHandle *fHandle, int segment, bool create
+ *
+ * Return: int
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+static int segmentFd (SM_FileHandle *fHandle, int segment, bool create){
+	SM_FileMgmt *mgmt = FILE_MGMT(fHandle);
+	char *name;
+	int i;
+
+	if(segment >= mgmt->numSegments){
+		if(!create){
+			return -1;
+		}
+		mgmt->fds = (int *)realloc(mgmt->fds, (segment + 1) * sizeof(int));
+		for(i = mgmt->numSegments; i <= segment; i++){
+			mgmt->fds[i] = -1;
+		}
+		mgmt->numSegments = segment + 1;
+	}
+	if(mgmt->fds[segment] == -1){
+		name = segmentFileName(mgmt->fileName, segment);
+		mgmt->fds[segment] = open(name, create ? mgmt->openFlags | O_CREAT : mgmt->openFlags, 0666);
+		free(name);
+	}
+	return mgmt->fds[segment];
+}
+
+/***************************************************************
+ * Function Name: segmentFileName
+ * 
+ * Description: return the name of a segment file: fileName for segment 0, fileName.1, fileName.2, ... for the others. The caller frees the name.
+ *
+ * Parameters: char *fileName, int segment
+ *
+ * Return: char *
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+static char *segmentFileName (char *fileName, int segment){
+	char *name = (char *)malloc(strlen(fileName) + 16);
+
+	if(segment == 0){
+		strcpy(name, fileName);
+	} else {
+		sprintf(name, "%s.%d", fileName, segment);
+	}
+	return name;
+}
+
+/***************************************************************
+ * Function Name: validPageSize
+ * 
+ * Description: check that pageSize is a power of two between SM_MIN_PAGE_SIZE and SM_MAX_PAGE_SIZE. Together with the header size this keeps every page aligned for SM_MODE_DIRECT.
+ *
+ * Parameters: int pageSize
+ *
+ * Return: bool
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+static bool validPageSize (int pageSize){
+	return pageSize >= SM_MIN_PAGE_SIZE && pageSize <= SM_MAX_PAGE_SIZE
+	       && (pageSize & (pageSize - 1)) == 0;
+}
+
+/***************************************************************
+ * Function Name: writeHeader
+ * 
+ * Description: write the header block with the current free-page list back to offset 0 of the page file.
+ *
+ * Parameters: SM_FileHandle *fHandle
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+static RC writeHeader (SM_FileHandle *fHandle){
+	SM_FileMgmt *mgmt = FILE_MGMT(fHandle);
+	SM_FileHeader header;
+	char *headerBlock;
+	ssize_t n;
+
+	// page 0 starts at offset 0 of a file written before the header
+	if(mgmt->headerSize == 0){
+		return RC_FILE_HEADER_INVALID;
+	}
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, SM_HEADER_MAGIC, sizeof(header.magic));
+	header.version = SM_HEADER_VERSION;
+	header.pageSize = mgmt->pageSize;
+	header.segmentPages = mgmt->segmentPages;
+	header.freeListHead = mgmt->freeListHead;
+	header.freePageCount = mgmt->freePageCount;
+
+	if(mgmt->mode == SM_MODE_MMAP){
+		memcpy(mgmt->map, &header, sizeof(header));
+		return RC_OK;
+	}
+	// a whole aligned block, so this also works with O_DIRECT
+	headerBlock = allocPageBufferSize(SM_HEADER_SIZE);
+	if(headerBlock == NULL){
+		return RC_WRITE_FAILED;
+	}
+	memcpy(headerBlock, &header, sizeof(header));
+	do {
+		n = pwrite(mgmt->fds[0], headerBlock, SM_HEADER_SIZE, 0);
+	} while(n < 0 && errno == EINTR);
+	freePageBuffer(headerBlock);
+	return n == SM_HEADER_SIZE ? RC_OK : RC_WRITE_FAILED;
+}
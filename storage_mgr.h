@@ -2,26 +2,63 @@
 #define STORAGE_MGR_H
 
 #include "dberror.h"
+#include "dt.h"
 
 /************************************************************
  *                    handle data structures                *
  ************************************************************/
 typedef struct SM_FileHandle {
   char *fileName;
-  int totalNumPages;
+  int pageSize; // bytes per page, chosen when the file was created
+  int totalNumPages; // logical size: pages that can be read and written
+  int physicalNumPages; // pages allocated on disk, preallocation keeps this ahead of totalNumPages
   int curPagePos;
   void *mgmtInfo;
 } SM_FileHandle;
 
 typedef char* SM_PageHandle;
 
+// how an open page file moves pages between disk and memory
+typedef enum SM_FileMode {
+  SM_MODE_PREAD = 0, // pread/pwrite on a file descriptor kept open
+  SM_MODE_MMAP = 1,  // memcpy into/out of a shared mapping of the file
+  SM_MODE_DIRECT = 2 // O_DIRECT pread/pwrite, bypassing the kernel page cache
+} SM_FileMode;
+
+// buffer alignment required by SM_MODE_DIRECT
+#define SM_IO_ALIGNMENT 4096
+
+// layout chosen when a page file is created
+typedef struct SM_FileOptions {
+  int pageSize; // power of two in [SM_MIN_PAGE_SIZE, SM_MAX_PAGE_SIZE], 0: PAGE_SIZE
+  int segmentPages; // > 0: split the file into segment files of this many pages
+} SM_FileOptions;
+
+#define SM_MIN_PAGE_SIZE 4096
+#define SM_MAX_PAGE_SIZE 65536
+
+// default cap of one preallocated extent, in pages
+#define SM_DEFAULT_PREALLOC_PAGES 256
+
 /************************************************************
  *                    interface                             *
  ************************************************************/
 /* manipulating page files */
 extern void initStorageManager (void);
 extern RC createPageFile (char *fileName);
+extern RC createPageFileWithOptions (char *fileName, SM_FileOptions *options);
 extern RC openPageFile (char *fileName, SM_FileHandle *fHandle);
+extern RC openPageFileWithMode (char *fileName, SM_FileHandle *fHandle, SM_FileMode mode);
+extern void setDefaultPageFileMode (SM_FileMode mode);
+extern void setPreallocationLimit (int maxExtentPages);
+extern void setFreePageHolePunching (bool enable);
+extern SM_FileMode getPageFileMode (SM_FileHandle *fHandle);
+extern RC getBlockLocation (int pageNum, SM_FileHandle *fHandle, int *fd, long long *offset);
+
+/* page buffers aligned for every file mode */
+extern SM_PageHandle allocPageBuffer (void);
+extern SM_PageHandle allocPageBufferSize (int pageSize);
+extern void freePageBuffer (SM_PageHandle memPage);
 extern RC closePageFile (SM_FileHandle *fHandle);
 extern RC destroyPageFile (char *fileName);
 
@@ -33,11 +70,18 @@ extern RC readPreviousBlock (SM_FileHandle *fHandle, SM_PageHandle memPage);
 extern RC readCurrentBlock (SM_FileHandle *fHandle, SM_PageHandle memPage);
 extern RC readNextBlock (SM_FileHandle *fHandle, SM_PageHandle memPage);
 extern RC readLastBlock (SM_FileHandle *fHandle, SM_PageHandle memPage);
+extern RC readBlocks (int startPage, int count, SM_FileHandle *fHandle, SM_PageHandle *memPages);
 
 /* writing blocks to a page file */
 extern RC writeBlock (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage);
 extern RC writeCurrentBlock (SM_FileHandle *fHandle, SM_PageHandle memPage);
+extern RC writeBlocks (int startPage, int count, SM_FileHandle *fHandle, SM_PageHandle *memPages);
 extern RC appendEmptyBlock (SM_FileHandle *fHandle);
 extern RC ensureCapacity (int numberOfPages, SM_FileHandle *fHandle);
 
+/* recycling pages */
+extern RC allocatePage (SM_FileHandle *fHandle, int *pageNum);
+extern RC freePage (int pageNum, SM_FileHandle *fHandle);
+extern int getNumFreePages (SM_FileHandle *fHandle);
+
 #endif
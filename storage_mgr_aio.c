@@ -0,0 +1,610 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include "storage_mgr_aio.h"
+
+/************************************************************
+ *                    private data structures               *
+ ************************************************************/
+// number of worker threads when io_uring is not available
+#define AIO_WORKERS 4
+
+struct SM_AsyncIO {
+  bool uring; // true: io_uring, false: worker threads
+  int pending; // submitted and not returned by reapAsyncIO yet
+
+  // completed requests in completion order, protected by lock
+  SM_AsyncRequest *readyHead;
+  SM_AsyncRequest *readyTail;
+  int numReady;
+
+  // io_uring
+  int ringFd;
+  unsigned inflight; // submitted to the ring, completion not consumed yet
+  unsigned sqEntries;
+  unsigned *sqTail, *sqMask, *sqArray;
+  unsigned *cqHead, *cqTail, *cqMask;
+  struct io_uring_sqe *sqes;
+  struct io_uring_cqe *cqes;
+  void *sqRing, *cqRing;
+  size_t sqRingSize, cqRingSize, sqesSize;
+
+  // worker threads, lock also protects the work queue
+  pthread_t workers[AIO_WORKERS];
+  pthread_mutex_t lock;
+  pthread_cond_t workCond;
+  pthread_cond_t doneCond;
+  SM_AsyncRequest *queueHead;
+  SM_AsyncRequest *queueTail;
+  bool stop;
+};
+
+// local functions
+static RC setupUring (SM_AsyncIO *aio, int queueDepth);
+static RC submitUring (SM_AsyncIO *aio, SM_AsyncRequest *req);
+static void drainUring (SM_AsyncIO *aio);
+static void *workerMain (void *arg);
+static void completeRequest (SM_AsyncRequest *req, long res);
+static void pushReady (SM_AsyncIO *aio, SM_AsyncRequest *req);
+
+/***************************************************************
+ * Function Name: initAsyncIO
+ *
+ * Description: create an asynchronous I/O engine that can keep up to queueDepth page requests in flight. io_uring is used when the kernel provides it, a small pool of pread/pwrite worker threads otherwise.
+ *
+ * Parameters: SM_AsyncIO **aio, int queueDepth
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+RC initAsyncIO (SM_AsyncIO **aio, int queueDepth){
+	SM_AsyncIO *engine;
+	int i;
+
+	if(queueDepth <= 0){
+		queueDepth = 32;
+	}
+
+	engine = (SM_AsyncIO *)calloc(1, sizeof(SM_AsyncIO));
+	engine->ringFd = -1;
+	pthread_mutex_init(&engine->lock, NULL);
+	pthread_cond_init(&engine->workCond, NULL);
+	pthread_cond_init(&engine->doneCond, NULL);
+
+	if(setupUring(engine, queueDepth) == RC_OK){
+		engine->uring = true;
+	} else {
+		for(i = 0; i < AIO_WORKERS; i++){
+			pthread_create(&engine->workers[i], NULL, workerMain, engine);
+		}
+	}
+
+	*aio = engine;
+	return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: shutdownAsyncIO
+ *
+ * Description: wait for all requests still in flight, then release the engine. Completions that were not reaped are dropped without calling their callbacks.
+ *
+ * Parameters: SM_AsyncIO *aio
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+RC shutdownAsyncIO (SM_AsyncIO *aio){
+	int i;
+
+	if(aio->uring){
+		while(aio->inflight > 0){
+			syscall(__NR_io_uring_enter, aio->ringFd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+			drainUring(aio);
+		}
+		munmap(aio->sqes, aio->sqesSize);
+		if(aio->cqRing != aio->sqRing){
+			munmap(aio->cqRing, aio->cqRingSize);
+		}
+		munmap(aio->sqRing, aio->sqRingSize);
+		close(aio->ringFd);
+	} else {
+		// workers finish the queue before they see stop
+		pthread_mutex_lock(&aio->lock);
+		aio->stop = true;
+		pthread_cond_broadcast(&aio->workCond);
+		pthread_mutex_unlock(&aio->lock);
+		for(i = 0; i < AIO_WORKERS; i++){
+			pthread_join(aio->workers[i], NULL);
+		}
+	}
+
+	pthread_cond_destroy(&aio->doneCond);
+	pthread_cond_destroy(&aio->workCond);
+	pthread_mutex_destroy(&aio->lock);
+	free(aio);
+	return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: submitAsyncIO
+ *
+ * Description: start a page read or write. Writes past the end of the file grow it first. Requests the engine cannot issue itself (memory-mapped files, unaligned buffers on O_DIRECT files) are executed synchronously and complete immediately.
+ *
+ * Parameters: SM_AsyncIO *aio, SM_AsyncRequest *req
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+RC submitAsyncIO (SM_AsyncIO *aio, SM_AsyncRequest *req){
+	RC rv;
+
+	if(req->fHandle == NULL || req->fHandle->mgmtInfo == NULL){
+		return RC_FILE_HANDLE_NOT_INIT;
+	}
+	if(req->op == SM_AIO_WRITE){
+		rv = ensureCapacity(req->pageNum + 1, req->fHandle);
+		if(rv != RC_OK){
+			return rv;
+		}
+	}
+
+	req->next = NULL;
+	req->rc = RC_OK;
+	req->length = req->fHandle->pageSize;
+
+	rv = getBlockLocation(req->pageNum, req->fHandle, &req->fd, &req->offset);
+	if(rv == RC_OK && getPageFileMode(req->fHandle) == SM_MODE_DIRECT
+	   && ((uintptr_t)req->memPage) % SM_IO_ALIGNMENT != 0){
+		rv = RC_FILE_MODE_NOT_SUPPORTED;
+	}
+	if(rv != RC_OK){
+		if(rv == RC_FILE_MODE_NOT_SUPPORTED){
+			rv = req->op == SM_AIO_READ ? readBlock(req->pageNum, req->fHandle, req->memPage)
+			                            : writeBlock(req->pageNum, req->fHandle, req->memPage);
+		}
+		req->rc = rv;
+		aio->pending++;
+		pthread_mutex_lock(&aio->lock);
+		pushReady(aio, req);
+		pthread_mutex_unlock(&aio->lock);
+		return RC_OK;
+	}
+
+	if(aio->uring){
+		return submitUring(aio, req);
+	}
+
+	aio->pending++;
+	pthread_mutex_lock(&aio->lock);
+	if(aio->queueTail == NULL){
+		aio->queueHead = req;
+	} else {
+		aio->queueTail->next = req;
+	}
+	aio->queueTail = req;
+	pthread_cond_signal(&aio->workCond);
+	pthread_mutex_unlock(&aio->lock);
+	return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: reapAsyncIO
+ *
+ * Description: wait until at least minDone requests have completed (fewer if fewer are pending), store up to maxDone of them in done and run their callbacks.
+ *
+ * Parameters: SM_AsyncIO *aio, SM_AsyncRequest **done, int maxDone, int minDone
+ *
+ * Return: int, the number of requests returned
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+int reapAsyncIO (SM_AsyncIO *aio, SM_AsyncRequest **done, int maxDone, int minDone){
+	SM_AsyncRequest *req;
+	int n = 0;
+
+	if(minDone > aio->pending){
+		minDone = aio->pending;
+	}
+	if(minDone > maxDone){
+		minDone = maxDone;
+	}
+
+	if(aio->uring){
+		drainUring(aio);
+		while(aio->numReady < minDone){
+			syscall(__NR_io_uring_enter, aio->ringFd, 0, minDone - aio->numReady,
+			        IORING_ENTER_GETEVENTS, NULL, 0);
+			drainUring(aio);
+		}
+	}
+
+	pthread_mutex_lock(&aio->lock);
+	while(aio->numReady < minDone){
+		pthread_cond_wait(&aio->doneCond, &aio->lock);
+	}
+	while(n < maxDone && aio->readyHead != NULL){
+		req = aio->readyHead;
+		aio->readyHead = req->next;
+		if(aio->readyHead == NULL){
+			aio->readyTail = NULL;
+		}
+		aio->numReady--;
+		req->next = NULL;
+		done[n++] = req;
+	}
+	pthread_mutex_unlock(&aio->lock);
+
+	aio->pending -= n;
+	for(minDone = 0; minDone < n; minDone++){
+		if(done[minDone]->callback != NULL){
+			done[minDone]->callback(done[minDone]);
+		}
+	}
+	return n;
+}
+
+/***************************************************************
+ * Function Name: getNumPendingAsyncIO
+ *
+ * Description: number of requests submitted and not reaped yet.
+ *
+ * Parameters: SM_AsyncIO *aio
+ *
+ * Return: int
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+int getNumPendingAsyncIO (SM_AsyncIO *aio){
+	return aio->pending;
+}
+
+/***************************************************************
+ * Function Name: asyncIOUsesUring
+ *
+ * Description: whether the engine runs on io_uring rather than worker threads.
+ *
+ * Parameters: SM_AsyncIO *aio
+ *
+ * Return: bool
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+bool asyncIOUsesUring (SM_AsyncIO *aio){
+	return aio->uring;
+}
+
+/***************************************************************
+ * Function Name: setupUring
+ *
+ * Description: create an io_uring instance and map its submission and completion rings. Fails when the kernel has no io_uring, forbids it, or lacks IORING_OP_READ/WRITE.
+ *
+ * Parameters: SM_AsyncIO *aio, int queueDepth
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+static RC setupUring (SM_AsyncIO *aio, int queueDepth){
+	struct io_uring_params params;
+	char *sq, *cq;
+	int fd;
+
+	memset(&params, 0, sizeof(params));
+	fd = (int)syscall(__NR_io_uring_setup, queueDepth, &params);
+	if(fd < 0){
+		return RC_FILE_MODE_NOT_SUPPORTED;
+	}
+	// IORING_OP_READ/WRITE came with 5.6, FAST_POLL with 5.7
+	if(!(params.features & IORING_FEAT_FAST_POLL)){
+		close(fd);
+		return RC_FILE_MODE_NOT_SUPPORTED;
+	}
+
+	aio->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	aio->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	if(params.features & IORING_FEAT_SINGLE_MMAP){
+		if(aio->cqRingSize > aio->sqRingSize){
+			aio->sqRingSize = aio->cqRingSize;
+		}
+		aio->cqRingSize = aio->sqRingSize;
+	}
+
+	aio->sqRing = mmap(NULL, aio->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+	                   fd, IORING_OFF_SQ_RING);
+	if(aio->sqRing == MAP_FAILED){
+		close(fd);
+		return RC_FILE_MODE_NOT_SUPPORTED;
+	}
+	if(params.features & IORING_FEAT_SINGLE_MMAP){
+		aio->cqRing = aio->sqRing;
+	} else {
+		aio->cqRing = mmap(NULL, aio->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+		                   fd, IORING_OFF_CQ_RING);
+		if(aio->cqRing == MAP_FAILED){
+			munmap(aio->sqRing, aio->sqRingSize);
+			close(fd);
+			return RC_FILE_MODE_NOT_SUPPORTED;
+		}
+	}
+	aio->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+	aio->sqes = mmap(NULL, aio->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+	                 fd, IORING_OFF_SQES);
+	if(aio->sqes == MAP_FAILED){
+		if(aio->cqRing != aio->sqRing){
+			munmap(aio->cqRing, aio->cqRingSize);
+		}
+		munmap(aio->sqRing, aio->sqRingSize);
+		close(fd);
+		return RC_FILE_MODE_NOT_SUPPORTED;
+	}
+
+	sq = (char *)aio->sqRing;
+	cq = (char *)aio->cqRing;
+	aio->sqTail = (unsigned *)(sq + params.sq_off.tail);
+	aio->sqMask = (unsigned *)(sq + params.sq_off.ring_mask);
+	aio->sqArray = (unsigned *)(sq + params.sq_off.array);
+	aio->cqHead = (unsigned *)(cq + params.cq_off.head);
+	aio->cqTail = (unsigned *)(cq + params.cq_off.tail);
+	aio->cqMask = (unsigned *)(cq + params.cq_off.ring_mask);
+	aio->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+	aio->sqEntries = params.sq_entries;
+	aio->ringFd = fd;
+	return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: submitUring
+ *
+ * Description: put the request into the submission queue and hand it to the kernel, waiting for a completion first if the ring is full.
+ *
+ * Parameters: SM_AsyncIO *aio, SM_AsyncRequest *req
+ *
+ * Return: RC
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+static RC submitUring (SM_AsyncIO *aio, SM_AsyncRequest *req){
+	struct io_uring_sqe *sqe;
+	unsigned tail, index;
+
+	while(aio->inflight >= aio->sqEntries){
+		syscall(__NR_io_uring_enter, aio->ringFd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+		drainUring(aio);
+	}
+
+	tail = *aio->sqTail;
+	index = tail & *aio->sqMask;
+	sqe = &aio->sqes[index];
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = req->op == SM_AIO_READ ? IORING_OP_READ : IORING_OP_WRITE;
+	sqe->fd = req->fd;
+	sqe->off = req->offset;
+	sqe->addr = (unsigned long)req->memPage;
+	sqe->len = req->length;
+	sqe->user_data = (unsigned long long)(uintptr_t)req;
+	aio->sqArray[index] = index;
+	__atomic_store_n(aio->sqTail, tail + 1, __ATOMIC_RELEASE);
+
+	if(syscall(__NR_io_uring_enter, aio->ringFd, 1, 0, 0, NULL, 0) < 0){
+		// the request never reached the kernel, take it back
+		__atomic_store_n(aio->sqTail, tail, __ATOMIC_RELEASE);
+		return req->op == SM_AIO_READ ? RC_READ_NON_EXISTING_PAGE : RC_WRITE_FAILED;
+	}
+	aio->inflight++;
+	aio->pending++;
+	return RC_OK;
+}
+
+/***************************************************************
+ * Function Name: drainUring
+ *
+ * Description: move every completion currently in the completion queue to the ready list.
+ *
+ * Parameters: SM_AsyncIO *aio
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+static void drainUring (SM_AsyncIO *aio){
+	struct io_uring_cqe *cqe;
+	SM_AsyncRequest *req;
+	unsigned head, tail;
+
+	head = *aio->cqHead;
+	tail = __atomic_load_n(aio->cqTail, __ATOMIC_ACQUIRE);
+	for(; head != tail; head++){
+		cqe = &aio->cqes[head & *aio->cqMask];
+		req = (SM_AsyncRequest *)(uintptr_t)cqe->user_data;
+		completeRequest(req, cqe->res);
+		pushReady(aio, req);
+		aio->inflight--;
+	}
+	__atomic_store_n(aio->cqHead, head, __ATOMIC_RELEASE);
+}
+
+/***************************************************************
+ * Function Name: workerMain
+ *
+ * Description: worker thread of the fallback engine: take requests off the queue, run them with pread/pwrite and move them to the ready list.
+ *
+ * Parameters: void *arg
+ *
+ * Return: void *
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+static void *workerMain (void *arg){
+	SM_AsyncIO *aio = (SM_AsyncIO *)arg;
+	SM_AsyncRequest *req;
+	long res;
+
+	pthread_mutex_lock(&aio->lock);
+	while(true){
+		while(aio->queueHead == NULL && !aio->stop){
+			pthread_cond_wait(&aio->workCond, &aio->lock);
+		}
+		if(aio->queueHead == NULL){
+			break;
+		}
+		req = aio->queueHead;
+		aio->queueHead = req->next;
+		if(aio->queueHead == NULL){
+			aio->queueTail = NULL;
+		}
+		pthread_mutex_unlock(&aio->lock);
+
+		do {
+			if(req->op == SM_AIO_READ){
+				res = pread(req->fd, req->memPage, req->length, req->offset);
+			} else {
+				res = pwrite(req->fd, req->memPage, req->length, req->offset);
+			}
+		} while(res < 0 && errno == EINTR);
+		completeRequest(req, res < 0 ? -errno : res);
+
+		pthread_mutex_lock(&aio->lock);
+		pushReady(aio, req);
+		pthread_cond_signal(&aio->doneCond);
+	}
+	pthread_mutex_unlock(&aio->lock);
+	return NULL;
+}
+
+/***************************************************************
+ * Function Name: completeRequest
+ *
+ * Description: turn the byte count (or negative errno) of a finished transfer into the request's RC. A short transfer is finished with pread/pwrite from where it stopped, as readPage and writePage do; a read that reaches the end of the file zeroes the rest of the page. O_DIRECT transfers cannot resume at an unaligned offset, there a short read is the end of the file and a short write fails, as in the synchronous path.
+ *
+ * Parameters: SM_AsyncRequest *req, long res
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/17      agent                       Complete.
+ *
+***************************************************************/
+static void completeRequest (SM_AsyncRequest *req, long res){
+	ssize_t n;
+
+	if(res > 0 && res < req->length && getPageFileMode(req->fHandle) != SM_MODE_DIRECT){
+		while(res < req->length){
+			if(req->op == SM_AIO_READ){
+				n = pread(req->fd, req->memPage + res, req->length - res, req->offset + res);
+			} else {
+				n = pwrite(req->fd, req->memPage + res, req->length - res, req->offset + res);
+			}
+			if(n < 0){
+				if(errno == EINTR) continue;
+				res = -errno;
+				break;
+			}
+			// end of file
+			if(n == 0) break;
+			res += n;
+		}
+	}
+
+	if(req->op == SM_AIO_READ){
+		if(res < 0){
+			req->rc = RC_READ_NON_EXISTING_PAGE;
+		} else {
+			if(res < req->length){
+				memset(req->memPage + res, 0, req->length - res);
+			}
+			req->rc = RC_OK;
+		}
+	} else {
+		req->rc = res == req->length ? RC_OK : RC_WRITE_FAILED;
+	}
+}
+
+/***************************************************************
+ * Function Name: pushReady
+ *
+ * Description: append a completed request to the ready list. The caller holds the lock when worker threads are running.
+ *
+ * Parameters: SM_AsyncIO *aio, SM_AsyncRequest *req
+ *
+ * Return: void
+ *
+ * Author: agent
+ *
+ * History:
+ *      Date            Name                        Content
+ *      2026/10/16      agent                       Complete.
+ *
+***************************************************************/
+static void pushReady (SM_AsyncIO *aio, SM_AsyncRequest *req){
+	req->next = NULL;
+	if(aio->readyTail == NULL){
+		aio->readyHead = req;
+	} else {
+		aio->readyTail->next = req;
+	}
+	aio->readyTail = req;
+	aio->numReady++;
+}
@@ -0,0 +1,51 @@
+#ifndef STORAGE_MGR_AIO_H
+#define STORAGE_MGR_AIO_H
+
+#include "dberror.h"
+#include "dt.h"
+#include "storage_mgr.h"
+
+/************************************************************
+ *                    handle data structures                *
+ ************************************************************/
+typedef enum SM_AsyncOp {
+  SM_AIO_READ = 0,
+  SM_AIO_WRITE = 1
+} SM_AsyncOp;
+
+// one page read or write. The caller owns the request and its page buffer
+// until the request comes back from reapAsyncIO.
+typedef struct SM_AsyncRequest {
+  SM_AsyncOp op;
+  SM_FileHandle *fHandle;
+  int pageNum;
+  SM_PageHandle memPage;
+  void (*callback) (struct SM_AsyncRequest *req); // optional, called by reapAsyncIO
+  void *userData; // completion token for the caller
+  RC rc; // result, valid after completion
+
+  // used by the engine
+  int fd;
+  long long offset;
+  int length;
+  struct SM_AsyncRequest *next;
+} SM_AsyncRequest;
+
+typedef struct SM_AsyncIO SM_AsyncIO;
+
+/************************************************************
+ *                    interface                             *
+ ************************************************************/
+extern RC initAsyncIO (SM_AsyncIO **aio, int queueDepth);
+extern RC shutdownAsyncIO (SM_AsyncIO *aio);
+
+// queue a request; it is started before submitAsyncIO returns
+extern RC submitAsyncIO (SM_AsyncIO *aio, SM_AsyncRequest *req);
+
+// wait until at least minDone requests completed, return up to maxDone of them
+extern int reapAsyncIO (SM_AsyncIO *aio, SM_AsyncRequest **done, int maxDone, int minDone);
+
+extern int getNumPendingAsyncIO (SM_AsyncIO *aio);
+extern bool asyncIOUsesUring (SM_AsyncIO *aio);
+
+#endif
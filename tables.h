@@ -52,6 +52,8 @@ typedef struct RM_TableData
   Schema *schema;
   BM_BufferPool *bm;
   SM_FileHandle *fh;
+  int pageSize; // page size of the table's page file
+  int slotSize; // records start on slot boundaries, from the table's page 0
 } RM_TableData;
 
 #define MAKE_STRING_VALUE(result, value)				\
@@ -0,0 +1,614 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "storage_mgr.h"
+#include "storage_mgr_aio.h"
+#include "dberror.h"
+#include "test_helper.h"
+
+// test name
+char *testName;
+
+/* test output files */
+#define TESTPF "test_pagefile.bin"
+
+/* prototypes for test functions */
+static void testCreateOpenClose(void);
+static void testSinglePageContent(void);
+static void testMultiPageContent(void);
+static void testAsyncIO(void);
+static void testPreallocation(void);
+static void testSegmentedFile(void);
+static void testLargeOffsets(void);
+static void testPageSizes(void);
+static void testFreePages(void);
+static void testHeaderlessFile(void);
+
+/* main function running all tests */
+int
+main (void)
+{
+  testName = "";
+
+  initStorageManager();
+
+  testCreateOpenClose();
+  testSinglePageContent();
+  testMultiPageContent();
+  testAsyncIO();
+  testPreallocation();
+  testSegmentedFile();
+  testLargeOffsets();
+  testPageSizes();
+  testFreePages();
+  testHeaderlessFile();
+
+  // same tests on memory-mapped page files
+  setDefaultPageFileMode(SM_MODE_MMAP);
+
+  testCreateOpenClose();
+  testSinglePageContent();
+  testMultiPageContent();
+  testAsyncIO();
+  testPreallocation();
+  testSegmentedFile();
+  testLargeOffsets();
+  testPageSizes();
+  testFreePages();
+  testHeaderlessFile();
+
+  // same tests with O_DIRECT page files
+  setDefaultPageFileMode(SM_MODE_DIRECT);
+
+  testCreateOpenClose();
+  testSinglePageContent();
+  testMultiPageContent();
+  testAsyncIO();
+  testPreallocation();
+  testSegmentedFile();
+  testLargeOffsets();
+  testPageSizes();
+  testFreePages();
+  testHeaderlessFile();
+
+  return 0;
+}
+
+
+/* check a return code. If it is not RC_OK then output a message, error description, and exit */
+/* Try to create, open, and close a page file */
+void
+testCreateOpenClose(void)
+{
+  SM_FileHandle fh;
+
+  testName = "test create open and close methods";
+
+  TEST_CHECK(createPageFile (TESTPF));
+
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  ASSERT_TRUE(strcmp(fh.fileName, TESTPF) == 0, "filename correct");
+  ASSERT_TRUE((fh.totalNumPages == 1), "expect 1 page in new file");
+  ASSERT_TRUE((fh.curPagePos == 0), "freshly opened file's page position should be 0");
+
+  TEST_CHECK(closePageFile (&fh));
+  TEST_CHECK(destroyPageFile (TESTPF));
+
+  // after destruction trying to open the file should cause an error
+  ASSERT_TRUE((openPageFile(TESTPF, &fh) != RC_OK), "opening non-existing file should return an error.");
+
+  TEST_DONE();
+}
+
+/* Try to create, open, and close a page file */
+void
+testSinglePageContent(void)
+{
+  SM_FileHandle fh;
+  SM_PageHandle ph;
+  int i;
+
+  testName = "test single page content";
+
+  ph = (SM_PageHandle) malloc(PAGE_SIZE);
+
+  // create a new page file
+  TEST_CHECK(createPageFile (TESTPF));
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  printf("created and opened file\n");
+
+  // read first page into handle
+  TEST_CHECK(readFirstBlock (&fh, ph));
+  // the page should be empty (zero bytes)
+  for (i=0; i < PAGE_SIZE; i++)
+    ASSERT_TRUE((ph[i] == 0), "expected zero byte in first page of freshly initialized page");
+  printf("first block was empty\n");
+
+  // change ph to be a string and write that one to disk
+  for (i=0; i < PAGE_SIZE; i++)
+    ph[i] = (i % 10) + '0';
+  TEST_CHECK(writeBlock (0, &fh, ph));
+  printf("writing first block\n");
+
+  // read back the page containing the string and check that it is correct
+  TEST_CHECK(readFirstBlock (&fh, ph));
+  for (i=0; i < PAGE_SIZE; i++)
+    ASSERT_TRUE((ph[i] == (i % 10) + '0'), "character in page read from disk is the one we expected.");
+  printf("reading first block\n");
+
+  // destroy new page file
+  TEST_CHECK(closePageFile (&fh));
+  TEST_CHECK(destroyPageFile (TESTPF));
+
+  free(ph);
+  TEST_DONE();
+}
+
+/* Write a range of pages with writeBlocks and read it back with readBlocks and readBlock */
+void
+testMultiPageContent(void)
+{
+  SM_FileHandle fh;
+  SM_PageHandle pages[5];
+  SM_PageHandle ph;
+  int i, j;
+
+  testName = "test multi page content";
+
+  // aligned range buffers take the vectored path in every mode, ph is not aligned
+  ph = (SM_PageHandle) malloc(PAGE_SIZE);
+  for (i = 0; i < 5; i++)
+    pages[i] = allocPageBuffer();
+
+  TEST_CHECK(createPageFile (TESTPF));
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+
+  // pages 2..6 do not exist yet, writeBlocks grows the file
+  for (i = 0; i < 5; i++)
+    memset(pages[i], 'a' + i, PAGE_SIZE);
+  TEST_CHECK(writeBlocks (2, 5, &fh, pages));
+  ASSERT_EQUALS_INT(7, fh.totalNumPages, "file grew to hold the written range");
+  ASSERT_EQUALS_INT(6, fh.curPagePos, "position is the last page written");
+
+  // page 1 was created as a zero page
+  TEST_CHECK(readBlock (1, &fh, ph));
+  for (j = 0; j < PAGE_SIZE; j++)
+    ASSERT_TRUE((ph[j] == 0), "page before the range is empty");
+
+  // single page reads see the vectored write
+  for (i = 0; i < 5; i++)
+    {
+      TEST_CHECK(readBlock (2 + i, &fh, ph));
+      ASSERT_TRUE(memcmp(ph, pages[i], PAGE_SIZE) == 0, "page written by writeBlocks read back by readBlock");
+    }
+
+  // vectored read of a range that overlaps the written one
+  for (i = 0; i < 5; i++)
+    memset(pages[i], 0, PAGE_SIZE);
+  TEST_CHECK(readBlocks (3, 4, &fh, pages));
+  for (i = 0; i < 4; i++)
+    for (j = 0; j < PAGE_SIZE; j++)
+      ASSERT_TRUE((pages[i][j] == 'a' + i + 1), "page read by readBlocks has the expected content");
+  ASSERT_EQUALS_INT(6, fh.curPagePos, "position is the last page read");
+
+  // ranges past the end of the file are rejected
+  ASSERT_ERROR(readBlocks (5, 3, &fh, pages), "reading past the last page");
+
+  TEST_CHECK(closePageFile (&fh));
+  TEST_CHECK(destroyPageFile (TESTPF));
+
+  for (i = 0; i < 5; i++)
+    freePageBuffer(pages[i]);
+  free(ph);
+  TEST_DONE();
+}
+
+/* Write and read pages through the asynchronous engine with several requests in flight */
+void
+testAsyncIO(void)
+{
+  SM_FileHandle fh;
+  SM_AsyncIO *aio;
+  SM_AsyncRequest reqs[8];
+  SM_AsyncRequest *done[8];
+  int i, j, n;
+
+  testName = "test asynchronous page I/O";
+
+  TEST_CHECK(createPageFile (TESTPF));
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  TEST_CHECK(initAsyncIO (&aio, 4));
+
+  // eight writes with a queue depth of four, the file grows on submit
+  memset(reqs, 0, sizeof(reqs));
+  for (i = 0; i < 8; i++)
+    {
+      reqs[i].op = SM_AIO_WRITE;
+      reqs[i].fHandle = &fh;
+      reqs[i].pageNum = 7 - i;
+      reqs[i].memPage = allocPageBuffer();
+      memset(reqs[i].memPage, 'A' + i, PAGE_SIZE);
+      TEST_CHECK(submitAsyncIO (aio, reqs + i));
+    }
+  ASSERT_EQUALS_INT(8, fh.totalNumPages, "file grew to hold the submitted writes");
+
+  n = 0;
+  while (n < 8)
+    n += reapAsyncIO(aio, done + n, 8 - n, 1);
+  ASSERT_EQUALS_INT(0, getNumPendingAsyncIO(aio), "all writes reaped");
+  for (i = 0; i < 8; i++)
+    TEST_CHECK(done[i]->rc);
+
+  // read them back, plus one page that does not exist
+  for (i = 0; i < 8; i++)
+    {
+      reqs[i].op = SM_AIO_READ;
+      reqs[i].pageNum = i;
+      memset(reqs[i].memPage, 0, PAGE_SIZE);
+      TEST_CHECK(submitAsyncIO (aio, reqs + i));
+    }
+  n = reapAsyncIO(aio, done, 8, 8);
+  ASSERT_EQUALS_INT(8, n, "reap waits for the minimum number of requests");
+  for (i = 0; i < 8; i++)
+    {
+      TEST_CHECK(reqs[i].rc);
+      for (j = 0; j < PAGE_SIZE; j++)
+        ASSERT_TRUE((reqs[i].memPage[j] == 'A' + 7 - i), "page read asynchronously has the expected content");
+    }
+
+  reqs[0].pageNum = 8;
+  TEST_CHECK(submitAsyncIO (aio, reqs));
+  n = reapAsyncIO(aio, done, 8, 1);
+  ASSERT_EQUALS_INT(1, n, "failed read is reaped");
+  ASSERT_ERROR(reqs[0].rc, "reading past the last page");
+
+  TEST_CHECK(shutdownAsyncIO (aio));
+  TEST_CHECK(closePageFile (&fh));
+  TEST_CHECK(destroyPageFile (TESTPF));
+
+  for (i = 0; i < 8; i++)
+    freePageBuffer(reqs[i].memPage);
+  TEST_DONE();
+}
+
+/* Grow a file page by page with preallocation on and off */
+void
+testPreallocation(void)
+{
+  SM_FileHandle fh;
+  SM_PageHandle ph;
+  int i, j;
+
+  testName = "test file preallocation";
+
+  ph = (SM_PageHandle) malloc(PAGE_SIZE);
+
+  // extents of 1, 2, 4, 4, ... pages
+  setPreallocationLimit(4);
+  TEST_CHECK(createPageFile (TESTPF));
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  for (i = 1; i <= 10; i++)
+    {
+      TEST_CHECK(appendEmptyBlock (&fh));
+      ASSERT_EQUALS_INT(i + 1, fh.totalNumPages, "logical size grows one page at a time");
+      ASSERT_TRUE((fh.physicalNumPages >= fh.totalNumPages), "allocated pages cover the logical size");
+      ASSERT_TRUE((fh.physicalNumPages <= fh.totalNumPages + 4), "extent stays below the limit");
+    }
+
+  // preallocated pages read as zeros and can be written
+  for (i = 0; i < 11; i++)
+    {
+      TEST_CHECK(readBlock (i, &fh, ph));
+      for (j = 0; j < PAGE_SIZE; j++)
+        ASSERT_TRUE((ph[j] == 0), "appended page is empty");
+    }
+  memset(ph, 'p', PAGE_SIZE);
+  TEST_CHECK(writeBlock (10, &fh, ph));
+  TEST_CHECK(closePageFile (&fh));
+
+  // reopening sees the logical size, not the reserved space
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  ASSERT_EQUALS_INT(11, fh.totalNumPages, "reopened file has the logical size");
+  TEST_CHECK(readLastBlock (&fh, ph));
+  for (j = 0; j < PAGE_SIZE; j++)
+    ASSERT_TRUE((ph[j] == 'p'), "last page kept its content");
+
+  // without preallocation nothing is reserved ahead
+  setPreallocationLimit(0);
+  TEST_CHECK(ensureCapacity (fh.physicalNumPages + 3, &fh));
+  ASSERT_EQUALS_INT(fh.totalNumPages, fh.physicalNumPages, "no pages reserved ahead");
+
+  TEST_CHECK(closePageFile (&fh));
+  TEST_CHECK(destroyPageFile (TESTPF));
+  setPreallocationLimit(SM_DEFAULT_PREALLOC_PAGES);
+
+  free(ph);
+  TEST_DONE();
+}
+
+/* Spread a page file over segment files of four pages */
+void
+testSegmentedFile(void)
+{
+  SM_FileHandle fh;
+  SM_FileOptions options;
+  SM_PageHandle pages[12];
+  SM_PageHandle ph;
+  long long offset;
+  int i, j, fd;
+  RC rc;
+
+  testName = "test segmented page file";
+
+  ph = (SM_PageHandle) malloc(PAGE_SIZE);
+  for (i = 0; i < 12; i++)
+    {
+      pages[i] = allocPageBuffer();
+      memset(pages[i], 'a' + i, PAGE_SIZE);
+    }
+
+  options.pageSize = 0;
+  options.segmentPages = 4;
+  TEST_CHECK(createPageFileWithOptions (TESTPF, &options));
+  rc = openPageFile (TESTPF, &fh);
+  // segments are not memory mapped
+  if (rc == RC_FILE_MODE_NOT_SUPPORTED)
+    rc = openPageFileWithMode (TESTPF, &fh, SM_MODE_PREAD);
+  TEST_CHECK(rc);
+
+  // pages 2..13 cover all four segments
+  TEST_CHECK(writeBlocks (2, 12, &fh, pages));
+  ASSERT_EQUALS_INT(14, fh.totalNumPages, "file grew over four segments");
+  ASSERT_TRUE((access(TESTPF ".1", F_OK) == 0 && access(TESTPF ".3", F_OK) == 0), "segment files exist");
+  ASSERT_TRUE((access(TESTPF ".4", F_OK) != 0), "no segment past the last page");
+
+  TEST_CHECK(getBlockLocation (5, &fh, &fd, &offset));
+  ASSERT_TRUE((offset == PAGE_SIZE), "page 5 is the second page of segment 1");
+  TEST_CHECK(closePageFile (&fh));
+
+  // the layout is found again from the header and the segment files
+  TEST_CHECK(openPageFileWithMode (TESTPF, &fh, SM_MODE_PREAD));
+  ASSERT_EQUALS_INT(14, fh.totalNumPages, "reopened file has all pages");
+  for (i = 0; i < 12; i++)
+    {
+      TEST_CHECK(readBlock (2 + i, &fh, ph));
+      ASSERT_TRUE(memcmp(ph, pages[i], PAGE_SIZE) == 0, "page read back from its segment");
+    }
+  for (i = 0; i < 12; i++)
+    memset(pages[i], 0, PAGE_SIZE);
+  TEST_CHECK(readBlocks (0, 12, &fh, pages));
+  for (j = 0; j < PAGE_SIZE; j++)
+    ASSERT_TRUE((pages[1][j] == 0 && pages[11][j] == 'a' + 9), "range read across segments");
+
+  TEST_CHECK(closePageFile (&fh));
+  TEST_CHECK(destroyPageFile (TESTPF));
+  ASSERT_TRUE((access(TESTPF ".1", F_OK) != 0), "segment files are deleted with the page file");
+
+  for (i = 0; i < 12; i++)
+    freePageBuffer(pages[i]);
+  free(ph);
+  TEST_DONE();
+}
+
+/* Pages behind the 2 GB mark keep their own content */
+void
+testLargeOffsets(void)
+{
+  SM_FileHandle fh;
+  SM_PageHandle ph;
+  long long offset;
+  int fd, j;
+  int farPage = 600000; // 600000 * 4096 bytes is past 2^31
+
+  testName = "test 64-bit page offsets";
+
+  ph = allocPageBuffer();
+  // the file is sparse, nothing is reserved for the pages in between
+  setPreallocationLimit(0);
+
+  TEST_CHECK(createPageFile (TESTPF));
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  memset(ph, 'z', PAGE_SIZE);
+  TEST_CHECK(writeBlock (farPage, &fh, ph));
+  memset(ph, 'y', PAGE_SIZE);
+  TEST_CHECK(writeBlock (farPage - 524288, &fh, ph)); // the page that shares the low 31 bits
+  ASSERT_EQUALS_INT(farPage + 1, fh.totalNumPages, "file grew past 2 GB");
+  TEST_CHECK(closePageFile (&fh));
+
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  ASSERT_EQUALS_INT(farPage + 1, fh.totalNumPages, "page count read back from a file over 2 GB");
+  if (getPageFileMode(&fh) != SM_MODE_MMAP)
+    {
+      TEST_CHECK(getBlockLocation (farPage, &fh, &fd, &offset));
+      ASSERT_TRUE((offset > 2147483647LL && offset % PAGE_SIZE == 0), "offset does not wrap around");
+    }
+  TEST_CHECK(readBlock (farPage, &fh, ph));
+  for (j = 0; j < PAGE_SIZE; j++)
+    ASSERT_TRUE((ph[j] == 'z'), "far page kept its content");
+  TEST_CHECK(readBlock (farPage - 524288, &fh, ph));
+  for (j = 0; j < PAGE_SIZE; j++)
+    ASSERT_TRUE((ph[j] == 'y'), "page 2 GB below kept its own content");
+  TEST_CHECK(readBlock (farPage - 1, &fh, ph));
+  for (j = 0; j < PAGE_SIZE; j++)
+    ASSERT_TRUE((ph[j] == 0), "page in the hole is empty");
+
+  TEST_CHECK(closePageFile (&fh));
+  TEST_CHECK(destroyPageFile (TESTPF));
+  setPreallocationLimit(SM_DEFAULT_PREALLOC_PAGES);
+
+  freePageBuffer(ph);
+  TEST_DONE();
+}
+
+/* Page files with 16 KB and 64 KB pages */
+void
+testPageSizes(void)
+{
+  SM_FileHandle fh;
+  SM_FileOptions options;
+  SM_PageHandle ph;
+  int sizes[] = { 16384, 65536 };
+  int i, j;
+
+  testName = "test page sizes recorded in the header";
+
+  options.segmentPages = 0;
+  options.pageSize = 5000;
+  ASSERT_TRUE((createPageFileWithOptions (TESTPF, &options) == RC_CREATE_FILE_FAIL), "page size must be a power of two");
+  options.pageSize = 2 * SM_MAX_PAGE_SIZE;
+  ASSERT_TRUE((createPageFileWithOptions (TESTPF, &options) == RC_CREATE_FILE_FAIL), "page size above the maximum");
+
+  for (i = 0; i < 2; i++)
+    {
+      options.pageSize = sizes[i];
+      TEST_CHECK(createPageFileWithOptions (TESTPF, &options));
+      TEST_CHECK(openPageFile (TESTPF, &fh));
+      ASSERT_EQUALS_INT(sizes[i], fh.pageSize, "page size of the new file");
+      ASSERT_EQUALS_INT(1, fh.totalNumPages, "new file has one page");
+
+      ph = allocPageBufferSize(sizes[i]);
+      for (j = 0; j < sizes[i]; j++)
+        ph[j] = (j % 10) + '0';
+      TEST_CHECK(writeBlock (2, &fh, ph));
+      ASSERT_EQUALS_INT(3, fh.totalNumPages, "file grew by whole pages");
+      TEST_CHECK(closePageFile (&fh));
+
+      TEST_CHECK(openPageFile (TESTPF, &fh));
+      ASSERT_EQUALS_INT(sizes[i], fh.pageSize, "page size read back from the header");
+      ASSERT_EQUALS_INT(3, fh.totalNumPages, "page count in pages of the file's size");
+      memset(ph, 0, sizes[i]);
+      TEST_CHECK(readBlock (2, &fh, ph));
+      for (j = 0; j < sizes[i]; j++)
+        ASSERT_TRUE((ph[j] == (j % 10) + '0'), "whole page read back");
+      TEST_CHECK(readBlock (1, &fh, ph));
+      for (j = 0; j < sizes[i]; j++)
+        ASSERT_TRUE((ph[j] == 0), "page in between is empty");
+
+      TEST_CHECK(closePageFile (&fh));
+      TEST_CHECK(destroyPageFile (TESTPF));
+      freePageBuffer(ph);
+    }
+
+  TEST_DONE();
+}
+
+/* Freed pages are handed out again before the file grows */
+void
+testFreePages(void)
+{
+  SM_FileHandle fh;
+  SM_PageHandle ph;
+  struct stat before, after;
+  char seen[1200];
+  int numPages = 1200, numFreed = 1100; // more than one trunk page of leaves
+  int i, j, pageNum;
+
+  testName = "test free-page list";
+
+  ph = allocPageBuffer();
+  TEST_CHECK(createPageFile (TESTPF));
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  ASSERT_EQUALS_INT(0, getNumFreePages(&fh), "new file has no free pages");
+  ASSERT_TRUE((freePage (1, &fh) == RC_READ_NON_EXISTING_PAGE), "page past the end cannot be freed");
+
+  // without free pages the file grows
+  TEST_CHECK(allocatePage (&fh, &pageNum));
+  ASSERT_EQUALS_INT(1, pageNum, "page appended to the file");
+  TEST_CHECK(ensureCapacity (numPages, &fh));
+  memset(ph, 'x', PAGE_SIZE);
+  for (i = 0; i < numPages; i++)
+    TEST_CHECK(writeBlock (i, &fh, ph));
+  stat(TESTPF, &before);
+
+  setFreePageHolePunching(true);
+  for (i = 1; i <= numFreed; i++)
+    TEST_CHECK(freePage (i, &fh));
+  setFreePageHolePunching(false);
+  ASSERT_EQUALS_INT(numFreed, getNumFreePages(&fh), "freed pages are counted");
+  stat(TESTPF, &after);
+  ASSERT_TRUE((after.st_size == before.st_size), "the file keeps its size");
+  ASSERT_TRUE((after.st_blocks < before.st_blocks), "freed pages give their blocks back");
+  TEST_CHECK(closePageFile (&fh));
+
+  // the list survives closing the file
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  ASSERT_EQUALS_INT(numFreed, getNumFreePages(&fh), "free-page list read back from the header");
+  memset(seen, 0, sizeof(seen));
+  for (i = 0; i < numFreed; i++)
+    {
+      TEST_CHECK(allocatePage (&fh, &pageNum));
+      ASSERT_TRUE((pageNum >= 1 && pageNum <= numFreed && !seen[pageNum]), "each freed page is reused once");
+      seen[pageNum] = 1;
+      TEST_CHECK(readBlock (pageNum, &fh, ph));
+      for (j = 0; j < PAGE_SIZE && ph[j] == 0; j++)
+        ;
+      ASSERT_EQUALS_INT(PAGE_SIZE, j, "reused page is empty");
+    }
+  ASSERT_EQUALS_INT(0, getNumFreePages(&fh), "free-page list is empty");
+  ASSERT_EQUALS_INT(numPages, fh.totalNumPages, "file did not grow while pages were reused");
+  TEST_CHECK(readBlock (0, &fh, ph));
+  ASSERT_TRUE((ph[0] == 'x'), "page that was not freed kept its content");
+
+  TEST_CHECK(allocatePage (&fh, &pageNum));
+  ASSERT_EQUALS_INT(numPages, pageNum, "file grows once the list is empty");
+
+  TEST_CHECK(closePageFile (&fh));
+  TEST_CHECK(destroyPageFile (TESTPF));
+  freePageBuffer(ph);
+  TEST_DONE();
+}
+
+/* Files written before page files had a header open with the old layout */
+void
+testHeaderlessFile(void)
+{
+  SM_FileHandle fh;
+  SM_PageHandle ph;
+  FILE *fp;
+  int i, pageNum;
+  RC rc;
+
+  testName = "test page file without header";
+
+  ph = allocPageBuffer();
+  fp = fopen(TESTPF, "wb");
+  for (i = 0; i < 3; i++)
+    {
+      memset(ph, 'a' + i, PAGE_SIZE);
+      ASSERT_TRUE((fwrite(ph, 1, PAGE_SIZE, fp) == PAGE_SIZE), "old layout page written");
+    }
+  fclose(fp);
+
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  ASSERT_EQUALS_INT(3, fh.totalNumPages, "pages counted from offset 0");
+  ASSERT_EQUALS_INT(PAGE_SIZE, fh.pageSize, "old files have PAGE_SIZE pages");
+  for (i = 0; i < 3; i++)
+    {
+      TEST_CHECK(readBlock (i, &fh, ph));
+      ASSERT_TRUE((ph[0] == 'a' + i && ph[PAGE_SIZE - 1] == 'a' + i), "page read from the old layout");
+    }
+
+  // there is no header to keep a free-page list in
+  rc = freePage (1, &fh);
+  ASSERT_EQUALS_INT(RC_FILE_HEADER_INVALID, rc, "no free-page list without a header");
+  TEST_CHECK(allocatePage (&fh, &pageNum));
+  ASSERT_EQUALS_INT(3, pageNum, "allocatePage appends to an old file");
+  memset(ph, 'z', PAGE_SIZE);
+  TEST_CHECK(writeBlock (3, &fh, ph));
+  TEST_CHECK(closePageFile (&fh));
+
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  ASSERT_EQUALS_INT(4, fh.totalNumPages, "reopened old file has the appended page");
+  TEST_CHECK(readBlock (0, &fh, ph));
+  ASSERT_TRUE((ph[0] == 'a'), "page 0 was not overwritten by a header");
+  TEST_CHECK(readBlock (3, &fh, ph));
+  ASSERT_TRUE((ph[0] == 'z'), "appended page read back");
+  TEST_CHECK(closePageFile (&fh));
+  TEST_CHECK(destroyPageFile (TESTPF));
+
+  freePageBuffer(ph);
+  TEST_DONE();
+}
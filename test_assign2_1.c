@@ -0,0 +1,1467 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "storage_mgr.h"
+#include "buffer_mgr_stat.h"
+#include "buffer_mgr.h"
+#include "dberror.h"
+#include "test_helper.h"
+
+// var to store the current test's name
+char *testName;
+
+// check whether two the content of a buffer pool is the same as an expected content 
+// (given in the format produced by sprintPoolContent)
+#define ASSERT_EQUALS_POOL(expected,bm,message)			        \
+  do {									\
+    char *real;								\
+    char *_exp = (char *) (expected);                                   \
+    real = sprintPoolContent(bm);					\
+    if (strcmp((_exp),real) != 0)					\
+      {									\
+	printf("[%s-%s-L%i-%s] FAILED: expected <%s> but was <%s>: %s\n",TEST_INFO, _exp, real, message); \
+	free(real);							\
+	exit(1);							\
+      }									\
+    printf("[%s-%s-L%i-%s] OK: expected <%s> and was <%s>: %s\n",TEST_INFO, _exp, real, message); \
+    free(real);								\
+  } while(0)
+
+/* test output files */
+#define TESTPF "testbuffer.bin"
+
+/* prototypes for test functions */
+static void createDummyPages(char *fileName, int num);
+static void testFIFO(void);
+static void testLRU(void);
+static void testForcePage(void);
+static void readBackPage(char *fileName, int pageNum, SM_PageHandle ph);
+static void testCLOCK(void);
+static void testLFU(void);
+static void testLRU_K(void);
+static void testARC(void);
+static void testBufferRing(void);
+static void testFlushRuns(void);
+static void testBackgroundWriter(void);
+static void testFrameSlab(void);
+static void testPrefetchPages(void);
+static void testSharedPool(void);
+static void testResizePool(void);
+static void testPoolStats(void);
+static void testPoolTrace(void);
+static int waitForWriterPages(BM_BufferPool *bm, int numPages);
+static void testManyPages(void);
+static void testConcurrentPins(void);
+static void *concurrentPinWorker(void *arg);
+
+/* main function running all tests */
+int
+main (void)
+{
+  initStorageManager();
+  testName = "";
+
+  testFIFO();
+  testLRU();
+  testForcePage();
+  testCLOCK();
+  testLFU();
+  testLRU_K();
+  testARC();
+  testBufferRing();
+  testFlushRuns();
+  testBackgroundWriter();
+  testFrameSlab();
+  testPrefetchPages();
+  testSharedPool();
+  testResizePool();
+  testPoolStats();
+  testPoolTrace();
+  testManyPages();
+  testConcurrentPins();
+
+  return 0;
+}
+
+/* create a page file of num pages, page i starts with "Page-i" */
+void
+createDummyPages(char *fileName, int num)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  int i;
+
+  TEST_CHECK(createPageFile(fileName));
+  TEST_CHECK(initBufferPool(bm, fileName, 3, RS_FIFO, NULL));
+
+  for (i = 0; i < num; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, i));
+      sprintf(h->data, "%s-%i", "Page", h->pageNum);
+      TEST_CHECK(markDirty(bm, h));
+      TEST_CHECK(unpinPage(bm,h));
+    }
+
+  TEST_CHECK(shutdownBufferPool(bm));
+
+  free(h);
+  free(bm);
+}
+
+/* test the FIFO page replacement strategy */
+void
+testFIFO (void)
+{
+  // expected results
+  const char *poolContents[] = { 
+    "[0 0],[-1 0],[-1 0]" , 
+    "[0 0],[1 0],[-1 0]", 
+    "[0 0],[1 0],[2 0]", 
+    "[3 0],[1 0],[2 0]", 
+    "[3 0],[4 0],[2 0]",
+    "[3 0],[4 1],[2 0]",
+    "[3 0],[4 1],[5x0]",
+    "[6x0],[4 1],[5x0]",
+    "[6x0],[4 1],[0x0]",
+    "[6x0],[4 0],[0x0]",
+    "[6 0],[4 0],[0 0]"
+  };
+  const int requests[] = {0,1,2,3,4,4,5,6,0};
+  const int numLinRequests = 5;
+  const int numChangeRequests = 3;
+
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  testName = "Testing FIFO page replacement";
+
+  createDummyPages(TESTPF, 100);
+
+  TEST_CHECK(initBufferPool(bm, TESTPF, 3, RS_FIFO, NULL));
+
+  // reading some pages linearly with direct unpin and no modifications
+  for(i = 0; i < numLinRequests; i++)
+    {
+      pinPage(bm, h, requests[i]);
+      unpinPage(bm, h);
+      ASSERT_EQUALS_POOL(poolContents[i], bm, "check pool content");
+    }
+
+  // pin one page and test remainder
+  i = numLinRequests;
+  pinPage(bm, h, requests[i]);
+  ASSERT_EQUALS_POOL(poolContents[i],bm,"pool content after pin page");
+
+  // read pages and mark them as dirty
+  for(i = numLinRequests + 1; i < numLinRequests + numChangeRequests + 1; i++)
+    {
+      pinPage(bm, h, requests[i]);
+      markDirty(bm, h);
+      unpinPage(bm, h);
+      ASSERT_EQUALS_POOL(poolContents[i], bm, "check pool content");
+    }
+
+  // flush buffer pool to disk
+  i = numLinRequests + numChangeRequests + 1;
+  h->pageNum = 4;
+  unpinPage(bm, h);
+  ASSERT_EQUALS_POOL(poolContents[i],bm,"unpin last page");
+  
+  i++;
+  forceFlushPool(bm);
+  ASSERT_EQUALS_POOL(poolContents[i],bm,"pool content after flush");
+
+  // check number of write IOs
+  ASSERT_EQUALS_INT(3, getNumWriteIO(bm), "check number of write I/Os");
+  ASSERT_EQUALS_INT(8, getNumReadIO(bm), "check number of read I/Os");
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile(TESTPF));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+/* test the LRU page replacement strategy */
+void
+testLRU (void)
+{
+  // expected results
+  const char *poolContents[] = { 
+    // read first five pages and directly unpin them
+    "[0 0],[-1 0],[-1 0],[-1 0],[-1 0]" , 
+    "[0 0],[1 0],[-1 0],[-1 0],[-1 0]", 
+    "[0 0],[1 0],[2 0],[-1 0],[-1 0]",
+    "[0 0],[1 0],[2 0],[3 0],[-1 0]",
+    "[0 0],[1 0],[2 0],[3 0],[4 0]",
+    // use some of the page to create a fixed LRU order without changing pool content
+    "[0 0],[1 0],[2 0],[3 0],[4 0]",
+    "[0 0],[1 0],[2 0],[3 0],[4 0]",
+    "[0 0],[1 0],[2 0],[3 0],[4 0]",
+    "[0 0],[1 0],[2 0],[3 0],[4 0]",
+    "[0 0],[1 0],[2 0],[3 0],[4 0]",
+    // check that pages get evicted in LRU order
+    "[0 0],[1 0],[2 0],[5 0],[4 0]",
+    "[0 0],[1 0],[2 0],[5 0],[6 0]",
+    "[7 0],[1 0],[2 0],[5 0],[6 0]",
+    "[7 0],[1 0],[8 0],[5 0],[6 0]",
+    "[7 0],[9 0],[8 0],[5 0],[6 0]"
+  };
+  const int orderRequests[] = {3,4,0,2,1};
+  const int numLRUOrderChange = 5;
+
+  int i;
+  int snapshot = 0;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  testName = "Testing LRU page replacement";
+
+  createDummyPages(TESTPF, 100);
+  TEST_CHECK(initBufferPool(bm, TESTPF, 5, RS_LRU, NULL));
+
+  // reading first five pages linearly with direct unpin and no modifications
+  for(i = 0; i < 5; i++)
+    {
+      pinPage(bm, h, i);
+      unpinPage(bm, h);
+      ASSERT_EQUALS_POOL(poolContents[snapshot], bm, "check pool content reading in pages");
+      snapshot++;
+    }
+
+  // read pages to change LRU order
+  for(i = 0; i < numLRUOrderChange; i++)
+    {
+      pinPage(bm, h, orderRequests[i]);
+      unpinPage(bm, h);
+      ASSERT_EQUALS_POOL(poolContents[snapshot], bm, "check pool content using pages");
+      snapshot++;
+    }
+
+  // replace pages and check that it happens in LRU order
+  for(i = 0; i < 5; i++)
+    {
+      pinPage(bm, h, 5 + i);
+      unpinPage(bm, h);
+      ASSERT_EQUALS_POOL(poolContents[snapshot], bm, "check pool content using pages");
+      snapshot++;
+    }
+
+  // check number of write IOs
+  ASSERT_EQUALS_INT(0, getNumWriteIO(bm), "check number of write I/Os");
+  ASSERT_EQUALS_INT(10, getNumReadIO(bm), "check number of read I/Os");
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile(TESTPF));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+/* read page pageNum of the page file, not through a buffer pool */
+void
+readBackPage (char *fileName, int pageNum, SM_PageHandle ph)
+{
+  SM_FileHandle fh;
+
+  TEST_CHECK(openPageFile(fileName, &fh));
+  TEST_CHECK(readBlock(pageNum, &fh, ph));
+  TEST_CHECK(closePageFile(&fh));
+}
+
+/* test forcePage, also through the handle of a page that left its frame */
+void
+testForcePage (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle stale;
+  SM_PageHandle ph = allocPageBuffer();
+
+  testName = "Forcing pages";
+
+  createDummyPages(TESTPF, 10);
+  TEST_CHECK(initBufferPool(bm, TESTPF, 3, RS_FIFO, NULL));
+
+  TEST_CHECK(pinPage(bm, h, 1));
+  sprintf(h->data, "%s-%i-%i", "Page", 1, 1);
+  TEST_CHECK(markDirty(bm, h));
+  TEST_CHECK(forcePage(bm, h));
+  stale = *h;
+  TEST_CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[1 0],[-1 0],[-1 0]", bm, "forced page is clean");
+  readBackPage(TESTPF, 1, ph);
+  ASSERT_EQUALS_STRING("Page-1-1", ph, "forced page is in the file");
+
+  // page 1 leaves the pool, its frame now holds page 4
+  TEST_CHECK(pinPage(bm, h, 2));
+  TEST_CHECK(unpinPage(bm, h));
+  TEST_CHECK(pinPage(bm, h, 3));
+  TEST_CHECK(unpinPage(bm, h));
+  TEST_CHECK(pinPage(bm, h, 4));
+  TEST_CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[4 0],[2 0],[3 0]", bm, "page 1 was evicted");
+  TEST_CHECK(forcePage(bm, &stale));
+  readBackPage(TESTPF, 1, ph);
+  ASSERT_EQUALS_STRING("Page-1-1", ph, "page 4 was not written over page 1");
+
+  // page 1 comes back in another frame and is changed there
+  TEST_CHECK(pinPage(bm, h, 1));
+  sprintf(h->data, "%s-%i-%i", "Page", 1, 2);
+  TEST_CHECK(markDirty(bm, h));
+  TEST_CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[4 0],[1x0],[3 0]", bm, "page 1 is in another frame");
+  TEST_CHECK(forcePage(bm, &stale));
+  ASSERT_EQUALS_POOL("[4 0],[1 0],[3 0]", bm, "forcing the stale handle cleans page 1");
+  readBackPage(TESTPF, 1, ph);
+  ASSERT_EQUALS_STRING("Page-1-2", ph, "page 1 written from the frame it is in");
+  readBackPage(TESTPF, 4, ph);
+  ASSERT_EQUALS_STRING("Page-4", ph, "page 4 is unchanged");
+
+  TEST_CHECK(shutdownBufferPool(bm));
+  TEST_CHECK(destroyPageFile(TESTPF));
+
+  freePageBuffer(ph);
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+/* test the CLOCK page replacement strategy */
+void
+testCLOCK (void)
+{
+  // expected results
+  const char *poolContents[] = { 
+    "[0 0],[-1 0],[-1 0]",
+    "[0 0],[1 0],[-1 0]",
+    "[0 0],[1 0],[2 0]",
+    // every frame had its second chance, the hand is back at frame 0
+    "[3 0],[1 0],[2 0]",
+    // a hit only sets the reference bit of page 1
+    "[3 0],[1 0],[2 0]",
+    "[3 0],[1 0],[4 0]",
+    // page 5 stays pinned
+    "[3 0],[5 1],[4 0]",
+    "[6 0],[5 1],[4 0]",
+    "[6 0],[5 1],[7 0]",
+    "[6 0],[5 0],[7 0]",
+    "[8 0],[5 0],[7 0]"
+  };
+  const int requests[] = {0,1,2,3,1,4};
+  const int numLinRequests = 6;
+
+  int i;
+  int snapshot = 0;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle *pinned = MAKE_PAGE_HANDLE();
+  testName = "Testing CLOCK page replacement";
+
+  createDummyPages(TESTPF, 100);
+  TEST_CHECK(initBufferPool(bm, TESTPF, 3, RS_CLOCK, NULL));
+
+  for(i = 0; i < numLinRequests; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, requests[i]));
+      TEST_CHECK(unpinPage(bm, h));
+      ASSERT_EQUALS_POOL(poolContents[snapshot], bm, "check pool content");
+      snapshot++;
+    }
+
+  // the hand passes over a pinned frame
+  TEST_CHECK(pinPage(bm, pinned, 5));
+  ASSERT_EQUALS_POOL(poolContents[snapshot], bm, "pool content after pin page");
+  snapshot++;
+  for(i = 6; i < 8; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, i));
+      TEST_CHECK(unpinPage(bm, h));
+      ASSERT_EQUALS_POOL(poolContents[snapshot], bm, "check pool content");
+      snapshot++;
+    }
+  TEST_CHECK(unpinPage(bm, pinned));
+  ASSERT_EQUALS_POOL(poolContents[snapshot], bm, "unpin page");
+  snapshot++;
+  TEST_CHECK(pinPage(bm, h, 8));
+  TEST_CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL(poolContents[snapshot], bm, "check pool content");
+
+  ASSERT_EQUALS_INT(0, getNumWriteIO(bm), "check number of write I/Os");
+  ASSERT_EQUALS_INT(9, getNumReadIO(bm), "check number of read I/Os");
+
+  // no victim while every frame is pinned
+  TEST_CHECK(pinPage(bm, h, 8));
+  TEST_CHECK(pinPage(bm, h, 5));
+  TEST_CHECK(pinPage(bm, pinned, 7));
+  ASSERT_ERROR(pinPage(bm, h, 9), "all frames are pinned");
+  h->pageNum = 8;
+  TEST_CHECK(unpinPage(bm, h));
+  h->pageNum = 5;
+  TEST_CHECK(unpinPage(bm, h));
+  TEST_CHECK(unpinPage(bm, pinned));
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile(TESTPF));
+
+  free(bm);
+  free(h);
+  free(pinned);
+  TEST_DONE();
+}
+
+/* test the LFU page replacement strategy, with and without aging */
+void
+testLFU (void)
+{
+  // expected results
+  const char *poolContents[] = { 
+    "[0 0],[1 0],[2 0]",
+    // page 0 was used three times, page 1 twice, page 2 once
+    "[0 0],[1 0],[3 0]",
+    "[0 0],[1 0],[4 0]",
+    // page 4 was used three times, page 1 has the lowest count
+    "[0 0],[5 0],[4 0]",
+    "[0 0],[6 0],[4 0]"
+  };
+  const int requests[] = {0,1,2,0,0,1};
+  int agingInterval = 4;
+
+  int i;
+  int snapshot = 0;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  testName = "Testing LFU page replacement";
+
+  createDummyPages(TESTPF, 100);
+  TEST_CHECK(initBufferPool(bm, TESTPF, 3, RS_LFU, NULL));
+
+  for(i = 0; i < 6; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, requests[i]));
+      TEST_CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_POOL(poolContents[snapshot++], bm, "check pool content");
+  TEST_CHECK(pinPage(bm, h, 3));
+  TEST_CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL(poolContents[snapshot++], bm, "least frequently used page replaced");
+  TEST_CHECK(pinPage(bm, h, 4));
+  TEST_CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL(poolContents[snapshot++], bm, "new page has the lowest count");
+  for(i = 0; i < 2; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, 4));
+      TEST_CHECK(unpinPage(bm, h));
+    }
+  TEST_CHECK(pinPage(bm, h, 5));
+  TEST_CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL(poolContents[snapshot++], bm, "least frequently used page replaced");
+  TEST_CHECK(pinPage(bm, h, 6));
+  TEST_CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL(poolContents[snapshot++], bm, "least frequently used page replaced");
+  ASSERT_EQUALS_INT(7, getNumReadIO(bm), "check number of read I/Os");
+  CHECK(shutdownBufferPool(bm));
+
+  // page 0 is used eight times, then page 1 four times
+  TEST_CHECK(initBufferPool(bm, TESTPF, 2, RS_LFU, NULL));
+  for(i = 0; i < 12; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, i < 8 ? 0 : 1));
+      TEST_CHECK(unpinPage(bm, h));
+    }
+  TEST_CHECK(pinPage(bm, h, 2));
+  TEST_CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[0 0],[2 0]", bm, "without aging the old hot page stays");
+  CHECK(shutdownBufferPool(bm));
+
+  // halving every four references lets page 0 fall behind page 1
+  TEST_CHECK(initBufferPool(bm, TESTPF, 2, RS_LFU, &agingInterval));
+  for(i = 0; i < 12; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, i < 8 ? 0 : 1));
+      TEST_CHECK(unpinPage(bm, h));
+    }
+  TEST_CHECK(pinPage(bm, h, 2));
+  TEST_CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[2 0],[1 0]", bm, "with aging the old hot page leaves");
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(destroyPageFile(TESTPF));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+/* test the LRU-K page replacement strategy: scan resistance, history of evicted pages, pinned pages */
+void
+testLRU_K (void)
+{
+  BM_LRUKParams noHistory = { 2, 0 };
+  BM_LRUKParams smallHistory = { 2, 2 };
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle *pinned = MAKE_PAGE_HANDLE();
+  testName = "Testing LRU-K page replacement";
+
+  createDummyPages(TESTPF, 100);
+
+  // pages 0 and 1 are used twice, then pages 10 to 19 are scanned once
+  TEST_CHECK(initBufferPool(bm, TESTPF, 3, RS_LRU_K, NULL));
+  for(i = 0; i < 4; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, i / 2));
+      TEST_CHECK(unpinPage(bm, h));
+    }
+  for(i = 10; i < 20; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, i));
+      TEST_CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_POOL("[0 0],[1 0],[19 0]", bm, "scan does not evict the working set");
+  ASSERT_EQUALS_INT(12, getNumReadIO(bm), "check number of read I/Os");
+  CHECK(shutdownBufferPool(bm));
+
+  // page 6 comes back after its eviction; only with history it has two references
+  TEST_CHECK(initBufferPool(bm, TESTPF, 2, RS_LRU_K, &smallHistory));
+  TEST_CHECK(pinPage(bm, h, 5));
+  TEST_CHECK(unpinPage(bm, h));
+  TEST_CHECK(pinPage(bm, h, 6));
+  TEST_CHECK(unpinPage(bm, h));
+  TEST_CHECK(pinPage(bm, h, 5));
+  TEST_CHECK(unpinPage(bm, h));
+  TEST_CHECK(pinPage(bm, h, 7));
+  TEST_CHECK(unpinPage(bm, h));
+  TEST_CHECK(pinPage(bm, h, 6));
+  TEST_CHECK(unpinPage(bm, h));
+  TEST_CHECK(pinPage(bm, h, 8));
+  TEST_CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[8 0],[6 0]", bm, "largest backward 2-distance replaced");
+  CHECK(shutdownBufferPool(bm));
+
+  TEST_CHECK(initBufferPool(bm, TESTPF, 2, RS_LRU_K, &noHistory));
+  TEST_CHECK(pinPage(bm, h, 5));
+  TEST_CHECK(unpinPage(bm, h));
+  TEST_CHECK(pinPage(bm, h, 6));
+  TEST_CHECK(unpinPage(bm, h));
+  TEST_CHECK(pinPage(bm, h, 5));
+  TEST_CHECK(unpinPage(bm, h));
+  TEST_CHECK(pinPage(bm, h, 7));
+  TEST_CHECK(unpinPage(bm, h));
+  TEST_CHECK(pinPage(bm, h, 6));
+  TEST_CHECK(unpinPage(bm, h));
+  TEST_CHECK(pinPage(bm, h, 8));
+  TEST_CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[5 0],[8 0]", bm, "without history the reloaded page goes first");
+  CHECK(shutdownBufferPool(bm));
+
+  // page 0 has the oldest second reference but is pinned
+  TEST_CHECK(initBufferPool(bm, TESTPF, 2, RS_LRU_K, NULL));
+  TEST_CHECK(pinPage(bm, h, 0));
+  TEST_CHECK(unpinPage(bm, h));
+  TEST_CHECK(pinPage(bm, pinned, 0));
+  for(i = 0; i < 2; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, 1));
+      TEST_CHECK(unpinPage(bm, h));
+    }
+  TEST_CHECK(pinPage(bm, h, 2));
+  TEST_CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[0 1],[2 0]", bm, "pinned page is not replaced");
+  TEST_CHECK(unpinPage(bm, pinned));
+  CHECK(shutdownBufferPool(bm));
+
+  noHistory.k = 0;
+  ASSERT_ERROR(initBufferPool(bm, TESTPF, 2, RS_LRU_K, &noHistory), "k must be positive");
+
+  CHECK(destroyPageFile(TESTPF));
+  free(bm);
+  free(h);
+  free(pinned);
+  TEST_DONE();
+}
+
+/* test the ARC page replacement strategy: scan resistance and adapting the recency target */
+void
+testARC (void)
+{
+  const int requests[] = {0,0,1,2,3,1};
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  testName = "Testing ARC page replacement";
+
+  createDummyPages(TESTPF, 100);
+
+  // pages 0 and 1 are used twice, then pages 10 to 19 are scanned once
+  TEST_CHECK(initBufferPool(bm, TESTPF, 3, RS_ARC, NULL));
+  for(i = 0; i < 4; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, i / 2));
+      TEST_CHECK(unpinPage(bm, h));
+    }
+  for(i = 10; i < 20; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, i));
+      TEST_CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_POOL("[0 0],[1 0],[19 0]", bm, "scan does not evict the frequent pages");
+  ASSERT_EQUALS_INT(12, getNumReadIO(bm), "check number of read I/Os");
+  CHECK(shutdownBufferPool(bm));
+
+  // page 1 is evicted from the recent list and comes back, so the recent
+  // list may grow and the victim comes from the frequent list
+  TEST_CHECK(initBufferPool(bm, TESTPF, 3, RS_ARC, NULL));
+  for(i = 0; i < 6; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, requests[i]));
+      TEST_CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_POOL("[0 0],[3 0],[1 0]", bm, "check pool content");
+  TEST_CHECK(pinPage(bm, h, 4));
+  TEST_CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[4 0],[3 0],[1 0]", bm, "ghost hit moved the target to the recent list");
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(destroyPageFile(TESTPF));
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+/* a scan through a ring of frames leaves the other pages of the pool alone */
+void
+testBufferRing (void)
+{
+  BM_BufferRing ring;
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  testName = "Testing scan ring buffers";
+
+  createDummyPages(TESTPF, 100);
+  TEST_CHECK(initBufferPool(bm, TESTPF, 6, RS_LRU, NULL));
+  for(i = 0; i < 3; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, i));
+      TEST_CHECK(unpinPage(bm, h));
+    }
+
+  // pages 10 to 29 recycle the two frames of the ring
+  TEST_CHECK(initBufferRing(bm, &ring, 2));
+  for(i = 10; i < 30; i++)
+    {
+      TEST_CHECK(pinPageRing(bm, &ring, h, i));
+      ASSERT_EQUALS_INT(i, h->pageNum, "reading pages");
+      TEST_CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_POOL("[0 0],[1 0],[2 0],[28 0],[29 0],[-1 0]", bm, "scan stays in its ring");
+  ASSERT_EQUALS_INT(23, getNumReadIO(bm), "check number of read I/Os");
+
+  // a page of the ring pinned from outside stays in the pool
+  TEST_CHECK(pinPage(bm, h, 28));
+  TEST_CHECK(unpinPage(bm, h));
+  TEST_CHECK(pinPageRing(bm, &ring, h, 30));
+  TEST_CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[0 0],[1 0],[2 0],[28 0],[29 0],[30 0]", bm, "ring takes a new frame");
+
+  // ordinary pins still replace pages of the pool only
+  TEST_CHECK(pinPage(bm, h, 3));
+  TEST_CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[3 0],[1 0],[2 0],[28 0],[29 0],[30 0]", bm, "LRU page of the pool replaced");
+
+  // closing the ring empties its clean frames
+  TEST_CHECK(freeBufferRing(bm, &ring));
+  ASSERT_EQUALS_POOL("[3 0],[1 0],[2 0],[28 0],[-1 0],[-1 0]", bm, "ring frames given back");
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(destroyPageFile(TESTPF));
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+/* forceFlushPool writes dirty frames in page order, one write per run */
+void
+testFlushRuns (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  char expected[64];
+  // frame order is not page order: pages 2-4 and 7-9 form two runs
+  int pinOrder[] = { 7, 3, 9, 4, 8, 2 };
+  int i;
+
+  testName = "Flushing dirty pages in runs";
+
+  createDummyPages(TESTPF, 12);
+  TEST_CHECK(initBufferPool(bm, TESTPF, 8, RS_FIFO, NULL));
+
+  for (i = 0; i < 6; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, pinOrder[i]));
+      sprintf(h->data, "%s-%iX", "Page", h->pageNum);
+      TEST_CHECK(markDirty(bm, h));
+      TEST_CHECK(unpinPage(bm, h));
+    }
+  // a pinned dirty page stays in memory
+  TEST_CHECK(pinPage(bm, h, 5));
+  TEST_CHECK(markDirty(bm, h));
+
+  TEST_CHECK(forceFlushPool(bm));
+  ASSERT_EQUALS_INT(2, getNumFlushRuns(bm), "two runs of adjacent pages");
+  ASSERT_EQUALS_INT(6, getNumFlushPages(bm), "all unpinned dirty pages written");
+  ASSERT_EQUALS_INT(6, getNumWriteIO(bm), "one write I/O per page");
+  ASSERT_EQUALS_POOL("[7 0],[3 0],[9 0],[4 0],[8 0],[2 0],[5x1],[-1 0]", bm, "only the pinned page is dirty");
+
+  // with page 5 unpinned, page 4 and 5 join the first run
+  for (i = 0; i < 6; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, pinOrder[i]));
+      TEST_CHECK(markDirty(bm, h));
+      TEST_CHECK(unpinPage(bm, h));
+    }
+  TEST_CHECK(pinPage(bm, h, 5));
+  TEST_CHECK(unpinPage(bm, h));
+  TEST_CHECK(unpinPage(bm, h));
+  TEST_CHECK(forceFlushPool(bm));
+  ASSERT_EQUALS_INT(4, getNumFlushRuns(bm), "pages 2 to 5 and 7 to 9 are two runs");
+  ASSERT_EQUALS_INT(13, getNumFlushPages(bm), "seven more pages written");
+
+  TEST_CHECK(shutdownBufferPool(bm));
+
+  // the changed pages reached the file, the others are untouched
+  TEST_CHECK(initBufferPool(bm, TESTPF, 3, RS_FIFO, NULL));
+  for (i = 0; i < 12; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, i));
+      sprintf(expected, "%s-%i%s", "Page", i, (i >= 2 && i <= 9 && i != 5 && i != 6) ? "X" : "");
+      ASSERT_EQUALS_STRING(expected, h->data, "reading back page content");
+      TEST_CHECK(unpinPage(bm, h));
+    }
+  TEST_CHECK(shutdownBufferPool(bm));
+  TEST_CHECK(destroyPageFile(TESTPF));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+/* The background writer cleans frames before the pins need them */
+void
+testBackgroundWriter (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_WriterParams params = { 10, 0, 100, 0 };
+  bool *dirtyFlags;
+  int i, k;
+
+  testName = "Background writer";
+
+  createDummyPages(TESTPF, 100);
+
+  // on its interval: every frame is next in line for eviction
+  TEST_CHECK(initBufferPool(bm, TESTPF, 4, RS_LRU, NULL));
+  TEST_CHECK(startBackgroundWriter(bm, &params));
+  for (i = 0; i < 4; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, i));
+      sprintf(h->data, "%s-%i-%i", "Page", i, 1);
+      TEST_CHECK(markDirty(bm, h));
+      TEST_CHECK(unpinPage(bm, h));
+    }
+  ASSERT_TRUE(waitForWriterPages(bm, 4), "the writer wrote the dirty pages");
+  ASSERT_EQUALS_POOL("[0 0],[1 0],[2 0],[3 0]", bm, "all frames clean");
+  for (i = 4; i < 8; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, i));
+      TEST_CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_INT(0, getNumDirtyEvictions(bm), "pins found clean victims");
+  ASSERT_EQUALS_INT(4, getNumWriteIO(bm), "only the writer wrote");
+  ASSERT_TRUE(getNumWriterRounds(bm) > 0, "the writer counts its rounds");
+  TEST_CHECK(shutdownBufferPool(bm));
+
+  // kicked: the second dirty frame leaves fewer clean frames than the low
+  // watermark. That page is still pinned, the first one can be written.
+  params.intervalMs = 60000;
+  params.lowWatermark = 60;
+  TEST_CHECK(initBufferPool(bm, TESTPF, 4, RS_CLOCK, NULL));
+  TEST_CHECK(startBackgroundWriter(bm, &params));
+  for (i = 0; i < 4; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, i));
+      if (i < 2)
+        {
+          sprintf(h->data, "%s-%i-%i", "Page", i, 2);
+          TEST_CHECK(markDirty(bm, h));
+        }
+      TEST_CHECK(unpinPage(bm, h));
+    }
+  ASSERT_TRUE(waitForWriterPages(bm, 1), "the low watermark woke the writer");
+  TEST_CHECK(stopBackgroundWriter(bm));
+  dirtyFlags = getDirtyFlags(bm);
+  ASSERT_TRUE(!dirtyFlags[0], "the writer cleaned the first page");
+  free(dirtyFlags);
+  TEST_CHECK(pinPage(bm, h, 0));
+  ASSERT_EQUALS_STRING("Page-0-2", h->data, "the written page is cached");
+  TEST_CHECK(unpinPage(bm, h));
+  TEST_CHECK(shutdownBufferPool(bm));
+
+  // shutdown while the writer is in a round: its pins are not the caller's
+  params.intervalMs = 1;
+  params.lowWatermark = 100;
+  for (k = 0; k < 100; k++)
+    {
+      TEST_CHECK(initBufferPool(bm, TESTPF, 64, RS_LRU, NULL));
+      TEST_CHECK(startBackgroundWriter(bm, &params));
+      for (i = 10; i < 74; i++)
+        {
+          TEST_CHECK(pinPage(bm, h, i));
+          TEST_CHECK(markDirty(bm, h));
+          TEST_CHECK(unpinPage(bm, h));
+        }
+      TEST_CHECK(shutdownBufferPool(bm));
+    }
+  ASSERT_TRUE(TRUE, "shutdown with a busy writer");
+
+  TEST_CHECK(initBufferPool(bm, TESTPF, 3, RS_FIFO, NULL));
+  TEST_CHECK(pinPage(bm, h, 1));
+  ASSERT_EQUALS_STRING("Page-1-2", h->data, "reading back the page written at shutdown");
+  TEST_CHECK(unpinPage(bm, h));
+  TEST_CHECK(pinPage(bm, h, 3));
+  ASSERT_EQUALS_STRING("Page-3-1", h->data, "reading back the page the writer wrote");
+  TEST_CHECK(unpinPage(bm, h));
+  TEST_CHECK(shutdownBufferPool(bm));
+  TEST_CHECK(destroyPageFile(TESTPF));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+/* wait up to two seconds until the background writer wrote numPages pages */
+int
+waitForWriterPages (BM_BufferPool *bm, int numPages)
+{
+  int i;
+
+  for (i = 0; i < 200 && getNumWriterPages(bm) < numPages; i++)
+    usleep(10000);
+  return getNumWriterPages(bm) >= numPages;
+}
+
+/* All frames of a pool are consecutive, aligned pages of one slab, whatever backs it */
+void
+testFrameSlab (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle h[4];
+  BM_HugePages modes[] = { BM_HUGE_PAGES_OFF, BM_HUGE_PAGES_ADVISE, BM_HUGE_PAGES_ON };
+  char expected[64];
+  PageNumber *frames;
+  char *base;
+  int i, m;
+
+  testName = "Frames in one slab";
+
+  createDummyPages(TESTPF, 4);
+
+  for (m = 0; m < 3; m++)
+    {
+      setBufferPoolHugePages(modes[m]);
+      TEST_CHECK(initBufferPool(bm, TESTPF, 4, RS_LRU, NULL));
+      for (i = 0; i < 4; i++)
+        TEST_CHECK(pinPage(bm, h + i, i));
+
+      // frame k is at base + k * PAGE_SIZE
+      frames = getFrameContents(bm);
+      base = NULL;
+      for (i = 0; i < 4; i++)
+        if (frames[i] == 0)
+          base = h[0].data - (long) i * PAGE_SIZE;
+      ASSERT_TRUE((unsigned long) base % SM_IO_ALIGNMENT == 0, "slab is aligned");
+      for (i = 0; i < 4; i++)
+        {
+          ASSERT_TRUE(frames[i] != NO_PAGE && h[frames[i]].data == base + (long) i * PAGE_SIZE, "frame is a page of the slab");
+          sprintf(expected, "%s-%i", "Page", frames[i]);
+          ASSERT_EQUALS_STRING(expected, h[frames[i]].data, "frame holds its page");
+        }
+      free(frames);
+
+      for (i = 0; i < 4; i++)
+        TEST_CHECK(unpinPage(bm, h + i));
+      TEST_CHECK(shutdownBufferPool(bm));
+    }
+  setBufferPoolHugePages(BM_HUGE_PAGES_ADVISE);
+  TEST_CHECK(destroyPageFile(TESTPF));
+
+  free(bm);
+  TEST_DONE();
+}
+
+/* Prefetched pages are read in the background and found by later pins */
+void
+testPrefetchPages (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  PageNumber scattered[] = { 3, 7, 11, 15, 99 };
+  PageNumber next[] = { 3, 16 };
+
+  testName = "Prefetching scattered pages";
+
+  createDummyPages(TESTPF, 20);
+  TEST_CHECK(initBufferPool(bm, TESTPF, 8, RS_LRU, NULL));
+
+  // page 99 is beyond the end of the file
+  TEST_CHECK(prefetchPages(bm, scattered, 5));
+  TEST_CHECK(finishPrefetches(bm));
+  ASSERT_EQUALS_POOL("[3 0],[7 0],[11 0],[15 0],[-1 0],[-1 0],[-1 0],[-1 0]", bm, "prefetched pages are cached, not pinned");
+  ASSERT_EQUALS_INT(4, getNumReadIO(bm), "one read per page in the file");
+
+  // a pin right after the prefetch waits for the read in flight
+  TEST_CHECK(prefetchPages(bm, next, 2));
+  TEST_CHECK(pinPage(bm, h, 16));
+  ASSERT_EQUALS_STRING("Page-16", h->data, "pinned page was prefetched");
+  TEST_CHECK(unpinPage(bm, h));
+  TEST_CHECK(pinPage(bm, h, 7));
+  ASSERT_EQUALS_STRING("Page-7", h->data, "prefetched page is a hit");
+  TEST_CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_INT(5, getNumReadIO(bm), "cached pages are not read again");
+
+  TEST_CHECK(prefetchPageRange(bm, 0, 3));
+  TEST_CHECK(finishPrefetches(bm));
+  ASSERT_EQUALS_POOL("[3 0],[7 0],[11 0],[15 0],[16 0],[0 0],[1 0],[2 0]", bm, "range prefetched into the free frames");
+
+  TEST_CHECK(shutdownBufferPool(bm));
+  TEST_CHECK(destroyPageFile(TESTPF));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+/* Two page files cached in the frames of one pool */
+void
+testSharedPool (void)
+{
+  BM_BufferPool *pool = MAKE_POOL();
+  BM_BufferPool *a = MAKE_POOL();
+  BM_BufferPool *b = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  RC rc;
+
+  testName = "Sharing a pool between page files";
+
+  createDummyPages("testbuffer_a.bin", 4);
+  createDummyPages("testbuffer_b.bin", 4);
+  TEST_CHECK(initSharedBufferPool(pool, 3, PAGE_SIZE, RS_LRU, NULL, 1));
+  TEST_CHECK(attachPageFile(pool, a, "testbuffer_a.bin"));
+  TEST_CHECK(attachPageFile(pool, b, "testbuffer_b.bin"));
+
+  // page 0 of each file takes a frame of its own
+  TEST_CHECK(pinPage(a, h, 0));
+  sprintf(h->data, "%s", "File-a-0");
+  TEST_CHECK(markDirty(a, h));
+  TEST_CHECK(unpinPage(a, h));
+  TEST_CHECK(pinPage(b, h, 0));
+  ASSERT_EQUALS_STRING("Page-0", h->data, "page 0 of the other file");
+  TEST_CHECK(unpinPage(b, h));
+  ASSERT_EQUALS_POOL("[0x0],[0 0],[-1 0]", a, "both files' page 0 are cached");
+
+  // the dirty page of one file is evicted for pages of the other
+  TEST_CHECK(pinPage(b, h, 1));
+  TEST_CHECK(unpinPage(b, h));
+  TEST_CHECK(pinPage(b, h, 2));
+  TEST_CHECK(unpinPage(b, h));
+  ASSERT_EQUALS_INT(1, getNumWriteIO(pool), "evicted page was written back");
+  TEST_CHECK(pinPage(a, h, 0));
+  ASSERT_EQUALS_STRING("File-a-0", h->data, "evicted page was written to its own file");
+  TEST_CHECK(unpinPage(a, h));
+  ASSERT_EQUALS_POOL("[2 0],[0 0],[1 0]", b, "one replacement order for all files");
+
+  // detaching a file empties its frames only
+  TEST_CHECK(detachPageFile(a));
+  ASSERT_EQUALS_POOL("[2 0],[-1 0],[1 0]", b, "pages of the detached file left the pool");
+  TEST_CHECK(pinPage(b, h, 1));
+  rc = detachPageFile(b);
+  ASSERT_EQUALS_INT(RC_SHUTDOWN_POOL_FAILED, rc, "cannot detach a file with pinned pages");
+  TEST_CHECK(unpinPage(b, h));
+  TEST_CHECK(detachPageFile(b));
+  TEST_CHECK(shutdownBufferPool(pool));
+
+  TEST_CHECK(initBufferPool(a, "testbuffer_b.bin", 3, RS_FIFO, NULL));
+  TEST_CHECK(pinPage(a, h, 0));
+  ASSERT_EQUALS_STRING("Page-0", h->data, "the other file kept its page 0");
+  TEST_CHECK(unpinPage(a, h));
+  TEST_CHECK(shutdownBufferPool(a));
+
+  TEST_CHECK(destroyPageFile("testbuffer_a.bin"));
+  TEST_CHECK(destroyPageFile("testbuffer_b.bin"));
+  free(pool);
+  free(a);
+  free(b);
+  free(h);
+  TEST_DONE();
+}
+
+/* Growing and shrinking a pool keeps its pages and their replacement order */
+void
+testResizePool (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_BufferPool *pool = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle pinned;
+  ReplacementStrategy strategies[] = { RS_FIFO, RS_LRU, RS_CLOCK, RS_LFU, RS_LRU_K, RS_ARC };
+  int sizes[] = { 16, 4, 11, 7, 24 };
+  char expected[64];
+  int *fixCounts;
+  long long *stamps;
+  int i, j, k, pageNum;
+  RC rc;
+
+  testName = "Resizing a buffer pool";
+
+  createDummyPages(TESTPF, 40);
+  TEST_CHECK(initBufferPool(bm, TESTPF, 3, RS_LRU, NULL));
+  for (i = 0; i < 3; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, i));
+      if (i == 1)
+        {
+          sprintf(h->data, "%s", "Resized-1");
+          TEST_CHECK(markDirty(bm, h));
+        }
+      TEST_CHECK(unpinPage(bm, h));
+    }
+
+  // growing adds empty frames
+  TEST_CHECK(resizeBufferPool(bm, 5));
+  ASSERT_EQUALS_INT(5, bm->numPages, "pool has the new size");
+  ASSERT_EQUALS_POOL("[0 0],[1x0],[2 0],[-1 0],[-1 0]", bm, "cached pages kept their frames");
+  TEST_CHECK(pinPage(bm, h, 3));
+  TEST_CHECK(unpinPage(bm, h));
+  TEST_CHECK(pinPage(bm, h, 4));
+  TEST_CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_INT(5, getNumReadIO(bm), "no page was read again");
+
+  // shrinking evicts the least recently used pages and writes the dirty one
+  TEST_CHECK(resizeBufferPool(bm, 2));
+  ASSERT_EQUALS_POOL("[3 0],[4 0]", bm, "most recent pages moved into the kept frames");
+  ASSERT_EQUALS_INT(1, getNumWriteIO(bm), "dirty page was written back");
+  TEST_CHECK(pinPage(bm, h, 5));
+  TEST_CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[5 0],[4 0]", bm, "replacement order was kept");
+  TEST_CHECK(pinPage(bm, h, 1));
+  ASSERT_EQUALS_STRING("Resized-1", h->data, "evicted page was written to the file");
+  TEST_CHECK(unpinPage(bm, h));
+
+  // a pinned page cannot leave its frame
+  TEST_CHECK(pinPage(bm, &pinned, 1));
+  rc = resizeBufferPool(bm, 1);
+  ASSERT_EQUALS_INT(RC_RESIZE_POOL_FAILED, rc, "pinned page is beyond the new size");
+  rc = resizeBufferPool(bm, 0);
+  ASSERT_EQUALS_INT(RC_RESIZE_POOL_FAILED, rc, "a pool keeps a frame");
+  ASSERT_EQUALS_POOL("[5 0],[1 1]", bm, "failed resize changed nothing");
+  rc = resizeBufferPool(bm, 13);
+  ASSERT_EQUALS_INT(RC_RESIZE_POOL_FAILED, rc, "the stamps of pinned handles cannot move");
+  TEST_CHECK(resizeBufferPool(bm, 4));
+  stamps = getAttributionArray(bm);
+  ASSERT_TRUE((*(long long *) pinned.strategyAttribute == stamps[1]), "pinned handle still points at its frame's stamp");
+  free(stamps);
+  sprintf(pinned.data, "%s", "Pinned-1");
+  TEST_CHECK(markDirty(bm, &pinned));
+  TEST_CHECK(unpinPage(bm, &pinned));
+  ASSERT_EQUALS_POOL("[5 0],[1x0],[-1 0],[-1 0]", bm, "handle pinned before the resize still works");
+  TEST_CHECK(resizeBufferPool(bm, 1));
+  ASSERT_EQUALS_POOL("[1x0]", bm, "page moved into the only frame");
+  TEST_CHECK(shutdownBufferPool(bm));
+
+  // a partitioned pool shared by a file, resized through the file's handle
+  srand(11);
+  for (k = 0; k < 6; k++)
+    {
+      TEST_CHECK(initSharedBufferPool(pool, 8, PAGE_SIZE, strategies[k], NULL, 4));
+      TEST_CHECK(attachPageFile(pool, bm, TESTPF));
+      for (j = 0; j < 5; j++)
+        {
+          for (i = 0; i < 200; i++)
+            {
+              pageNum = rand() % 40;
+              TEST_CHECK(pinPage(bm, h, pageNum));
+              sprintf(expected, "%s-%i", "Page", pageNum);
+              if (pageNum == 1)
+                sprintf(expected, "%s", "Pinned-1");
+              if (strcmp(expected, h->data) != 0)
+                ASSERT_EQUALS_STRING(expected, h->data, "pinned page has its content");
+              if (rand() % 4 == 0)
+                TEST_CHECK(markDirty(bm, h));
+              TEST_CHECK(unpinPage(bm, h));
+            }
+          TEST_CHECK(resizeBufferPool(bm, sizes[j]));
+          ASSERT_EQUALS_INT(sizes[j], pool->numPages, "shared pool has the new size");
+        }
+      ASSERT_EQUALS_INT(24, bm->numPages, "file handle sees the new size");
+      fixCounts = getFixCounts(bm);
+      for (i = 0; i < 24; i++)
+        ASSERT_EQUALS_INT(0, fixCounts[i], "no page stays pinned");
+      free(fixCounts);
+      TEST_CHECK(detachPageFile(bm));
+      TEST_CHECK(shutdownBufferPool(pool));
+    }
+  TEST_CHECK(destroyPageFile(TESTPF));
+
+  free(bm);
+  free(pool);
+  free(h);
+  TEST_DONE();
+}
+
+/* Counters of pins, hits, misses, evictions and flushes, per file and frame */
+void
+testPoolStats (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_BufferPool *pool = MAKE_POOL();
+  BM_BufferPool *a = MAKE_POOL();
+  BM_BufferPool *b = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  const int requests[] = { 0, 1, 2, 0, 3, 4 };
+  BM_PoolStats stats;
+  long long counts[3];
+  char json[512];
+  int i;
+
+  testName = "Buffer pool statistics";
+
+  createDummyPages(TESTPF, 6);
+  TEST_CHECK(initBufferPool(bm, TESTPF, 3, RS_LRU, NULL));
+  for (i = 0; i < 6; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, requests[i]));
+      if (requests[i] == 1 || requests[i] == 3)
+        TEST_CHECK(markDirty(bm, h));
+      TEST_CHECK(unpinPage(bm, h));
+    }
+  TEST_CHECK(pinPage(bm, h, 0));
+  TEST_CHECK(markDirty(bm, h));
+  TEST_CHECK(forcePage(bm, h));
+  TEST_CHECK(unpinPage(bm, h));
+  TEST_CHECK(forceFlushPool(bm));
+  ASSERT_EQUALS_POOL("[0 0],[3 0],[4 0]", bm, "pages 1 and 2 were evicted");
+
+  TEST_CHECK(getPoolStats(bm, &stats));
+  ASSERT_EQUALS_INT(7, (int) stats.numPins, "every pin counts");
+  ASSERT_EQUALS_INT(2, (int) stats.numHits, "page 0 was found twice");
+  ASSERT_EQUALS_INT(5, (int) stats.numMisses, "pages read once each");
+  ASSERT_EQUALS_INT(1, (int) stats.numCleanEvictions, "page 2 left clean");
+  ASSERT_EQUALS_INT(1, (int) stats.numDirtyEvictions, "page 1 was written back");
+  ASSERT_EQUALS_INT(2, (int) stats.numForcedFlushes, "forcePage and forceFlushPool wrote a page each");
+  ASSERT_TRUE(stats.pinWaitNs > 0, "misses waited for their reads");
+
+  TEST_CHECK(getFrameAccessCounts(bm, counts));
+  ASSERT_EQUALS_INT(3, (int) counts[0], "page 0 was pinned three times");
+  ASSERT_EQUALS_INT(1, (int) counts[1], "page 3 was pinned once");
+  ASSERT_EQUALS_INT(1, (int) counts[2], "page 4 was pinned once");
+
+  sprintPoolStats(bm, json, sizeof(json));
+  json[strstr(json, "\"pinWaitNs\"") - json] = '\0';
+  ASSERT_EQUALS_STRING("{\"strategy\":\"LRU\",\"numPages\":3,\"pins\":7,\"hits\":2,\"misses\":5,\"hitRatio\":0.2857,"
+                       "\"cleanEvictions\":1,\"dirtyEvictions\":1,\"forcedFlushes\":2,", json, "counters as JSON");
+  TEST_CHECK(shutdownBufferPool(bm));
+  TEST_CHECK(destroyPageFile(TESTPF));
+
+  // a shared pool counts the pins of every file apart
+  createDummyPages("testbuffer_a.bin", 4);
+  createDummyPages("testbuffer_b.bin", 4);
+  TEST_CHECK(initSharedBufferPool(pool, 4, PAGE_SIZE, RS_LRU, NULL, 1));
+  TEST_CHECK(attachPageFile(pool, a, "testbuffer_a.bin"));
+  TEST_CHECK(attachPageFile(pool, b, "testbuffer_b.bin"));
+  for (i = 0; i < 3; i++)
+    {
+      TEST_CHECK(pinPage(a, h, 0));
+      TEST_CHECK(unpinPage(a, h));
+    }
+  for (i = 0; i < 2; i++)
+    {
+      TEST_CHECK(pinPage(b, h, i));
+      TEST_CHECK(unpinPage(b, h));
+    }
+  TEST_CHECK(getPoolStats(a, &stats));
+  ASSERT_TRUE(stats.numPins == 3 && stats.numHits == 2, "hits of the first file");
+  TEST_CHECK(getPoolStats(b, &stats));
+  ASSERT_TRUE(stats.numPins == 2 && stats.numHits == 0, "hits of the second file");
+  TEST_CHECK(getPoolStats(pool, &stats));
+  ASSERT_TRUE(stats.numPins == 5 && stats.numMisses == 3, "the pool adds up its files");
+
+  // a file attached under a detached file's id starts from zero
+  TEST_CHECK(detachPageFile(a));
+  TEST_CHECK(attachPageFile(pool, a, "testbuffer_b.bin"));
+  TEST_CHECK(getPoolStats(a, &stats));
+  ASSERT_EQUALS_INT(0, (int) stats.numPins, "new file has no pins yet");
+  TEST_CHECK(detachPageFile(a));
+  TEST_CHECK(detachPageFile(b));
+  TEST_CHECK(shutdownBufferPool(pool));
+
+  TEST_CHECK(destroyPageFile("testbuffer_a.bin"));
+  TEST_CHECK(destroyPageFile("testbuffer_b.bin"));
+  free(bm);
+  free(pool);
+  free(a);
+  free(b);
+  free(h);
+  TEST_DONE();
+}
+
+/* A trace of the pins of a pool, read back record by record */
+void
+testPoolTrace (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  const int requests[] = { 0, 1, 0, 2, 1 };
+  const char hits[] = { 0, 0, 1, 0, 0 };
+  BM_TraceHeader header;
+  BM_TraceRecord records[6];
+  FILE *file;
+  int i, n;
+
+  testName = "Tracing the pins of a pool";
+
+  createDummyPages(TESTPF, 3);
+  TEST_CHECK(initBufferPool(bm, TESTPF, 2, RS_LRU, NULL));
+  TEST_CHECK(startPoolTrace(bm, "testtrace.bin"));
+  for (i = 0; i < 5; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, requests[i]));
+      TEST_CHECK(unpinPage(bm, h));
+    }
+  TEST_CHECK(stopPoolTrace(bm));
+  // pins after the trace stopped are not logged
+  TEST_CHECK(pinPage(bm, h, 0));
+  TEST_CHECK(unpinPage(bm, h));
+  TEST_CHECK(shutdownBufferPool(bm));
+
+  file = fopen("testtrace.bin", "rb");
+  ASSERT_TRUE(file != NULL, "trace file was written");
+  ASSERT_TRUE(fread(&header, sizeof(BM_TraceHeader), 1, file) == 1, "trace has a header");
+  ASSERT_TRUE(header.magic == BM_TRACE_MAGIC && header.version == BM_TRACE_VERSION, "header identifies the trace");
+  ASSERT_TRUE(header.numPages == 2 && header.strategy == RS_LRU, "header describes the pool");
+  n = (int) fread(records, sizeof(BM_TraceRecord), 6, file);
+  fclose(file);
+  ASSERT_EQUALS_INT(5, n, "one record per pin");
+  for (i = 0; i < n; i++)
+    {
+      ASSERT_EQUALS_INT(requests[i], records[i].pageNum, "record has the pinned page");
+      ASSERT_EQUALS_INT(hits[i], records[i].hit, "record tells a hit from a miss");
+      ASSERT_TRUE(records[i].fileId == 0 && (i == 0 || records[i].timeNs >= records[i - 1].timeNs),
+		  "records are in the order of the pins");
+    }
+
+  remove("testtrace.bin");
+  TEST_CHECK(destroyPageFile(TESTPF));
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+/* Random pins over a file much larger than the pool, for every strategy */
+void
+testManyPages (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  int numPages = 500, numFrames = 37, numPins = 20000;
+  int *version = calloc(numPages, sizeof(int));
+  char expected[64];
+  ReplacementStrategy strategies[] = { RS_FIFO, RS_LRU, RS_CLOCK, RS_LFU, RS_LRU_K, RS_ARC };
+  int agingInterval = 1000;
+  PageNumber *frames;
+  int i, j, k, pageNum, cached;
+
+  testName = "Finding pages in a large pool";
+
+  createDummyPages(TESTPF, numPages);
+
+  // each strategy starts from the pages the previous one wrote
+  srand(7);
+  for (k = 0; k < 6; k++)
+    {
+      TEST_CHECK(initBufferPool(bm, TESTPF, numFrames, strategies[k], strategies[k] == RS_LFU ? &agingInterval : NULL));
+      for (i = 0; i < numPins; i++)
+        {
+          // a skewed mix: half of the pins go to the first 20 pages
+          pageNum = rand() % 2 ? rand() % 20 : rand() % numPages;
+          TEST_CHECK(pinPage(bm, h, pageNum));
+          if (version[pageNum])
+            sprintf(expected, "%s-%i-%i", "Page", pageNum, version[pageNum]);
+          else
+            sprintf(expected, "%s-%i", "Page", pageNum);
+          if (strcmp(expected, h->data) != 0)
+            ASSERT_EQUALS_STRING(expected, h->data, "pinned page has its latest content");
+          if (rand() % 2)
+            {
+              sprintf(h->data, "%s-%i-%i", "Page", pageNum, ++version[pageNum]);
+              TEST_CHECK(markDirty(bm, h));
+            }
+          TEST_CHECK(unpinPage(bm, h));
+        }
+
+      // every page is in at most one frame
+      frames = getFrameContents(bm);
+      cached = 0;
+      for (i = 0; i < numFrames; i++)
+        for (j = i + 1; j < numFrames; j++)
+          cached += (frames[i] != NO_PAGE && frames[i] == frames[j]);
+      ASSERT_EQUALS_INT(0, cached, "no page is cached twice");
+      free(frames);
+      TEST_CHECK(shutdownBufferPool(bm));
+    }
+
+  TEST_CHECK(initBufferPool(bm, TESTPF, numFrames, RS_FIFO, NULL));
+  for (i = 0; i < numPages; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, i));
+      if (version[i])
+        sprintf(expected, "%s-%i-%i", "Page", i, version[i]);
+      else
+        sprintf(expected, "%s-%i", "Page", i);
+      ASSERT_EQUALS_STRING(expected, h->data, "reading back page content");
+      TEST_CHECK(unpinPage(bm, h));
+    }
+  TEST_CHECK(shutdownBufferPool(bm));
+  TEST_CHECK(destroyPageFile(TESTPF));
+
+  free(version);
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+/* state shared by the threads of testConcurrentPins */
+#define CONCURRENT_THREADS 4
+#define CONCURRENT_PAGES 400
+#define CONCURRENT_PINS 20000
+
+typedef struct ConcurrentPinArgs {
+  BM_BufferPool *bm;
+  int thread;
+  int *version; // only thread (pageNum % CONCURRENT_THREADS) writes page pageNum
+  int failures;
+} ConcurrentPinArgs;
+
+void *
+concurrentPinWorker (void *arg)
+{
+  ConcurrentPinArgs *args = (ConcurrentPinArgs *) arg;
+  BM_PageHandle h;
+  char expected[64];
+  unsigned int seed = 11 + args->thread;
+  int i, pageNum;
+
+  for (i = 0; i < CONCURRENT_PINS; i++)
+    {
+      if (args->thread == 0 && i % 1000 == 0)
+        prefetchPageRange(args->bm, rand_r(&seed) % CONCURRENT_PAGES, 16);
+      // a skewed mix, so that threads often pin the same pages
+      pageNum = rand_r(&seed) % 2 ? rand_r(&seed) % 16 : rand_r(&seed) % CONCURRENT_PAGES;
+      if (pinPage(args->bm, &h, pageNum) != RC_OK)
+        {
+          args->failures++;
+          continue;
+        }
+      // other threads' pages may be written right now, only look at our own
+      if (pageNum % CONCURRENT_THREADS == args->thread)
+        {
+          if (args->version[pageNum])
+            sprintf(expected, "%s-%i-%i", "Page", pageNum, args->version[pageNum]);
+          else
+            sprintf(expected, "%s-%i", "Page", pageNum);
+          if (strcmp(expected, h.data) != 0)
+            args->failures++;
+          if (rand_r(&seed) % 2)
+            {
+              sprintf(h.data, "%s-%i-%i", "Page", pageNum, ++args->version[pageNum]);
+              markDirty(args->bm, &h);
+            }
+        }
+      unpinPage(args->bm, &h);
+    }
+  return NULL;
+}
+
+/* Threads pinning, writing and unpinning pages of a partitioned pool at the same time */
+void
+testConcurrentPins (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  pthread_t threads[CONCURRENT_THREADS];
+  ConcurrentPinArgs args[CONCURRENT_THREADS];
+  int *version = calloc(CONCURRENT_PAGES, sizeof(int));
+  ReplacementStrategy strategies[] = { RS_LRU, RS_CLOCK };
+  char expected[64];
+  int *fixCounts;
+  int i, k, fixed;
+
+  testName = "Concurrent pins of a partitioned pool";
+
+  createDummyPages(TESTPF, CONCURRENT_PAGES);
+
+  for (k = 0; k < 2; k++)
+    {
+      TEST_CHECK(initBufferPoolPartitioned(bm, TESTPF, 41, strategies[k], NULL, 4));
+      for (i = 0; i < CONCURRENT_THREADS; i++)
+        {
+          args[i].bm = bm;
+          args[i].thread = i;
+          args[i].version = version;
+          args[i].failures = 0;
+          pthread_create(threads + i, NULL, concurrentPinWorker, args + i);
+        }
+      for (i = 0; i < CONCURRENT_THREADS; i++)
+        {
+          pthread_join(threads[i], NULL);
+          ASSERT_EQUALS_INT(0, args[i].failures, "every pin found the latest content");
+        }
+
+      // a prefetch read keeps its frame fixed until it is published
+      TEST_CHECK(finishPrefetches(bm));
+      fixCounts = getFixCounts(bm);
+      fixed = 0;
+      for (i = 0; i < 41; i++)
+        fixed += fixCounts[i];
+      ASSERT_EQUALS_INT(0, fixed, "all pins released");
+      free(fixCounts);
+      TEST_CHECK(shutdownBufferPool(bm));
+    }
+
+  TEST_CHECK(initBufferPool(bm, TESTPF, 3, RS_FIFO, NULL));
+  for (i = 0; i < CONCURRENT_PAGES; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, i));
+      if (version[i])
+        sprintf(expected, "%s-%i-%i", "Page", i, version[i]);
+      else
+        sprintf(expected, "%s-%i", "Page", i);
+      if (strcmp(expected, h->data) != 0)
+        ASSERT_EQUALS_STRING(expected, h->data, "reading back page content");
+      TEST_CHECK(unpinPage(bm, h));
+    }
+  ASSERT_TRUE(TRUE, "all pages have their latest content");
+  TEST_CHECK(shutdownBufferPool(bm));
+  TEST_CHECK(destroyPageFile(TESTPF));
+
+  free(version);
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
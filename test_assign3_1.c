@@ -55,6 +55,8 @@ static void testScans (void);
 static void testScansTwo (void);
 static void testInsertManyRecords(void);
 static void testMultipleScans(void);
+static void testWidePages(void);
+static void testTwoTables(void);
 
 // struct for test records
 typedef struct TestRecord {
@@ -84,6 +86,34 @@ main (void)
   testScans();
   testScansTwo();
   testMultipleScans();
+  testWidePages();
+  testTwoTables();
+
+  // same tests on memory-mapped page files
+  setDefaultPageFileMode(SM_MODE_MMAP);
+
+  testInsertManyRecords();
+  testRecords();
+  testCreateTableAndInsert();
+  testUpdateTable();
+  testScans();
+  testScansTwo();
+  testMultipleScans();
+  testWidePages();
+  testTwoTables();
+
+  // same tests with O_DIRECT page files
+  setDefaultPageFileMode(SM_MODE_DIRECT);
+
+  testInsertManyRecords();
+  testRecords();
+  testCreateTableAndInsert();
+  testUpdateTable();
+  testScans();
+  testScansTwo();
+  testMultipleScans();
+  testWidePages();
+  testTwoTables();
 
   return 0;
 }
@@ -616,6 +646,86 @@ void testScansTwo (void)
 }
 
 
+void
+testWidePages (void)
+{
+  RM_TableData *table = (RM_TableData *) malloc(sizeof(RM_TableData));
+  TestRecord inserts[] = { 
+    {1, "aaaa", 3}, 
+    {2, "bbbb", 2},
+    {3, "cccc", 1},
+    {4, "dddd", 3},
+    {5, "eeee", 5},
+    {6, "ffff", 1},
+    {7, "gggg", 3},
+    {8, "hhhh", 3},
+    {9, "iiii", 2},
+    {10, "jjjj", 5},
+  };
+  TestRecord realInserts[3000];
+  SM_FileOptions options;
+  int numInserts = 3000, numFound = 0, i;
+  Record *r;
+  RID *rids;
+  Schema *schema;
+  RM_ScanHandle *sc = (RM_ScanHandle *) malloc(sizeof(RM_ScanHandle));
+  Expr *sel, *left, *right;
+  int rc;
+
+  testName = "test a table with 32 KB pages";
+  schema = testSchema();
+  rids = (RID *) malloc(sizeof(RID) * numInserts);
+  options.pageSize = 32768;
+  options.segmentPages = 0;
+
+  TEST_CHECK(initRecordManager(NULL));
+  TEST_CHECK(createTableWithOptions("test_table_w", schema, &options));
+  TEST_CHECK(openTable(table, "test_table_w"));
+  ASSERT_EQUALS_INT(32768, table->pageSize, "page size read from the page file");
+
+  for(i = 0; i < numInserts; i++)
+    {
+      realInserts[i] = inserts[i%10];
+      realInserts[i].a = i;
+      r = fromTestRecord(schema, realInserts[i]);
+      TEST_CHECK(insertRecord(table,r)); 
+      rids[i] = r->id;
+    }
+  // 128 records of one 256 byte slot fit on a 32 KB page
+  ASSERT_EQUALS_INT(rids[0].page, rids[127].page, "first 128 records share a page");
+  ASSERT_TRUE((rids[128].page != rids[0].page), "record 129 starts a new page");
+  TEST_CHECK(closeTable(table));
+  TEST_CHECK(openTable(table, "test_table_w"));
+
+  for(i = 0; i < numInserts; i++)
+    {
+      TEST_CHECK(getRecord(table, rids[i], r));
+      ASSERT_EQUALS_RECORDS(fromTestRecord(schema, realInserts[i]), r, schema, "compare records");
+    }
+
+  // c = 1 holds for two of every ten records
+  MAKE_CONS(left, stringToValue("i1"));
+  MAKE_ATTRREF(right, 2);
+  MAKE_BINOP_EXPR(sel, left, right, OP_COMP_EQUAL);
+  TEST_CHECK(startScan(table, sc, sel));
+  while((rc = next(sc, r)) == RC_OK)
+    numFound++;
+  if (rc != RC_RM_NO_MORE_TUPLES)
+    TEST_CHECK(rc);
+  TEST_CHECK(closeScan(sc));
+  ASSERT_EQUALS_INT(numInserts / 5, numFound, "scan finds all matching records");
+
+  TEST_CHECK(closeTable(table));
+  TEST_CHECK(deleteTable("test_table_w"));
+  TEST_CHECK(shutdownRecordManager());
+
+  free(rids);
+  free(table);
+  free(sc);
+  freeExpr(sel);
+  TEST_DONE();
+}
+
 Schema *
 testSchema (void)
 {
@@ -672,3 +782,93 @@ testRecord(Schema *schema, int a, char *b, int c)
 
   return result;
 }
+
+
+void
+testTwoTables (void)
+{
+  RM_TableData *tableA = (RM_TableData *) malloc(sizeof(RM_TableData));
+  RM_TableData *tableB = (RM_TableData *) malloc(sizeof(RM_TableData));
+  TestRecord inserts[] = { 
+    {1, "aaaa", 3}, 
+    {2, "bbbb", 2},
+    {3, "cccc", 1},
+    {4, "dddd", 3},
+    {5, "eeee", 5},
+  };
+  int numInserts = 500, i;
+  RM_Config config;
+  TestRecord rec;
+  Record *r, *expected;
+  RID *ridsA, *ridsB;
+  Schema *schema;
+
+  testName = "test two tables open at once in one small shared pool";
+  schema = testSchema();
+  ridsA = (RID *) malloc(sizeof(RID) * numInserts);
+  ridsB = (RID *) malloc(sizeof(RID) * numInserts);
+  config.numPages = 4;
+  config.pageSize = 0;
+  config.strategy = RS_LRU;
+  config.numShards = 0;
+
+  TEST_CHECK(initRecordManager(&config));
+  TEST_CHECK(createTable("test_table_a",schema));
+  TEST_CHECK(createTable("test_table_b",schema));
+  TEST_CHECK(openTable(tableA, "test_table_a"));
+  TEST_CHECK(openTable(tableB, "test_table_b"));
+  ASSERT_TRUE(tableA->bm->poolMgmt == tableB->bm->poolMgmt, "tables share one pool");
+
+  // interleave the inserts so both tables compete for the same 4 frames
+  for(i = 0; i < numInserts; i++)
+    {
+      rec = inserts[i%5];
+      rec.a = i;
+      r = fromTestRecord(schema, rec);
+      TEST_CHECK(insertRecord(tableA,r));
+      ridsA[i] = r->id;
+      freeRecord(r);
+      rec.a = -i;
+      r = fromTestRecord(schema, rec);
+      TEST_CHECK(insertRecord(tableB,r));
+      ridsB[i] = r->id;
+      freeRecord(r);
+    }
+  TEST_CHECK(closeTable(tableA));
+
+  // table b is still open and reads its records through the pool
+  TEST_CHECK(createRecord(&r, schema));
+  for(i = 0; i < numInserts; i++)
+    {
+      rec = inserts[i%5];
+      rec.a = -i;
+      expected = fromTestRecord(schema, rec);
+      TEST_CHECK(getRecord(tableB, ridsB[i], r));
+      ASSERT_EQUALS_RECORDS(expected, r, schema, "compare records of table b");
+      freeRecord(expected);
+    }
+  TEST_CHECK(closeTable(tableB));
+
+  TEST_CHECK(openTable(tableA, "test_table_a"));
+  for(i = 0; i < numInserts; i++)
+    {
+      rec = inserts[i%5];
+      rec.a = i;
+      expected = fromTestRecord(schema, rec);
+      TEST_CHECK(getRecord(tableA, ridsA[i], r));
+      ASSERT_EQUALS_RECORDS(expected, r, schema, "compare records of table a");
+      freeRecord(expected);
+    }
+  TEST_CHECK(closeTable(tableA));
+
+  TEST_CHECK(deleteTable("test_table_a"));
+  TEST_CHECK(deleteTable("test_table_b"));
+  TEST_CHECK(shutdownRecordManager());
+
+  freeRecord(r);
+  free(ridsA);
+  free(ridsB);
+  free(tableA);
+  free(tableB);
+  TEST_DONE();
+}